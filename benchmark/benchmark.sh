@@ -28,6 +28,309 @@ cut_output()
 	echo "$1" | sed 's/^[^.]*.\///' | sed 's/ /_/g' | sed 's/\//#/g'
 }
 
+# Runs a single command line $iterations times and appends its CSV output
+run_line()
+{
+	local line="$1"
+	local out_name=`cut_output "${line}.csv"`
+
+	if [ "$csv_header" != "none" ]
+	then
+		echo "$csv_header" > "$output_dir/$out_name"
+	fi
+	if [ "$warmup_time_in_between" != "none" ]
+	then
+		echo "[*] Starting warmup for $warmup_time_in_between"
+		stress-ng -q -c "$warmup_threads" -t "$warmup_time_in_between"
+	fi
+	for iteration in `seq 1 $iterations`
+	do
+		echo -n -e "\r[+] [$iteration/$iterations] Running $line"
+		$line >> "$output_dir/$out_name"
+		if [ $? -ne 0 ]
+		then
+			echo "[!] An error occurred. Exiting."
+			exit 1
+		fi
+	done
+	echo ""
+}
+
+# Creates the input file of a size and distribution with input_generator,
+# if it is missing
+create_input()
+{
+	local size="$1"
+	local distribution="$2"
+	local input="$3"
+
+	if [ -f "$input" ]
+	then
+		return
+	fi
+	if [ "$input_generator" = "none" ]
+	then
+		echo "[!] '{input}' requires input_generator"
+		exit 1
+	fi
+
+	local command=${input_generator//\{size\}/$size}
+	command=${command//\{distribution\}/$distribution}
+	command=${command//\{input\}/$input}
+
+	echo "[*] Creating input $input"
+	$command > /dev/null
+	if [ $? -ne 0 ]
+	then
+		echo "[!] Could not create input. Exiting."
+		exit 1
+	fi
+}
+
+# Expands {threads}, {size}, {distribution} and {input} of a run line and
+# runs every resulting command. Strong scaling runs every thread count for
+# every size, weak scaling pairs the n-th thread count with the n-th size.
+# Every distribution is run with all pairs, if the line or the
+# input_generator of its {input} contains {distribution}
+run_template()
+{
+	local template="$1"
+	local thread_list="-"
+	local size_list="-"
+	local distribution_list="-"
+
+	case $template in
+	*"{threads}"*)
+		thread_list=(${threads//,/ })
+		;;
+	esac
+	case $template in
+	*"{size}"*|*"{input}"*)
+		size_list=(${sizes//,/ })
+		;;
+	esac
+	case $template in
+	*"{distribution}"*)
+		distribution_list=(${distributions//,/ })
+		;;
+	*"{input}"*)
+		case $input_generator in
+		*"{distribution}"*)
+			distribution_list=(${distributions//,/ })
+			;;
+		esac
+		;;
+	esac
+
+	if [ "${distribution_list[0]}" = "none" ]
+	then
+		echo "[!] '$template' requires distributions"
+		exit 1
+	fi
+
+	if [ "${thread_list[0]}" = "none" -o "${size_list[0]}" = "none" ]
+	then
+		echo "[!] '$template' requires threads and sizes"
+		exit 1
+	fi
+
+	if [ "$thread_list" != "-" -a "$scaling_column" = "none" ]
+	then
+		echo "[!] '$template' requires scaling_column"
+		exit 1
+	fi
+
+	# The weak scaling efficiency is relative to one thread
+	if [ "$scaling" = "weak" -a "$thread_list" != "-" ]
+	then
+		local thread_count
+		local min_threads=${thread_list[0]}
+
+		for thread_count in ${thread_list[@]}
+		do
+			if [ "$thread_count" -lt "$min_threads" ]
+			then
+				min_threads=$thread_count
+			fi
+		done
+		if [ "$min_threads" -ne 1 ]
+		then
+			echo "[!] Weak scaling requires 1 as smallest thread count"
+			exit 1
+		fi
+	fi
+
+	local pairs=()
+
+	if [ "$scaling" = "weak" -a "$thread_list" != "-" ]
+	then
+		if [ ${#thread_list[@]} -ne ${#size_list[@]} ]
+		then
+			echo "[!] Weak scaling requires as many sizes as threads"
+			exit 1
+		fi
+		for i in ${!thread_list[@]}
+		do
+			pairs+=("${size_list[$i]} ${thread_list[$i]}")
+		done
+	else
+		for size in ${size_list[@]}
+		do
+			for thread_count in ${thread_list[@]}
+			do
+				pairs+=("$size $thread_count")
+			done
+		done
+	fi
+
+	for distribution in ${distribution_list[@]}
+	do
+		local group="$template"
+		local prefix="$input_dir/`basename ${input_generator%% *}`"
+
+		if [ "$distribution" != "-" ]
+		then
+			group="$template [$distribution]"
+			prefix="${prefix}_$distribution"
+		fi
+
+		for pair in "${pairs[@]}"
+		do
+			local size=${pair% *}
+			local thread_count=${pair#* }
+			local input="${prefix}_$size"
+			local line=${template//\{threads\}/$thread_count}
+			line=${line//\{size\}/$size}
+			line=${line//\{distribution\}/$distribution}
+
+			case $template in
+			*"{input}"*)
+				create_input "$size" "$distribution" "$input"
+				line=${line//\{input\}/$input}
+				;;
+			esac
+
+			run_line "$line"
+
+			if [ "$thread_count" != "-" ]
+			then
+				scaling_runs+=("$group|$size|$thread_count|`cut_output "${line}.csv"`")
+			fi
+		done
+	done
+}
+
+# Replaces a scaling_column, which is a name of csv_header, by its index
+resolve_scaling_column()
+{
+	local names index
+
+	if [ "$scaling_column" = "none" ]
+	then
+		return
+	fi
+	case $scaling_column in
+	*[!0-9]*)
+		;;
+	*)
+		return
+		;;
+	esac
+
+	IFS=',' read -r -a names <<< "$csv_header"
+	for index in ${!names[@]}
+	do
+		if [ "${names[$index]}" = "$scaling_column" ]
+		then
+			scaling_column=$((index + 1))
+			return
+		fi
+	done
+
+	echo "[!] Can not find scaling_column '$scaling_column' in csv_header"
+	exit 1
+}
+
+# Prints speedup, efficiency and Karp-Flatt serial fraction of every
+# template with {threads}, based on the mean of $scaling_column. The
+# smallest thread count is the baseline and is assumed to scale ideally
+print_scaling_tables()
+{
+	local templates=()
+	local run template known
+
+	for run in "${scaling_runs[@]}"
+	do
+		known=false
+		for template in "${templates[@]}"
+		do
+			if [ "$template" = "${run%%|*}" ]
+			then
+				known=true
+			fi
+		done
+		if [ $known = false ]
+		then
+			templates+=("${run%%|*}")
+		fi
+	done
+
+	for template in "${templates[@]}"
+	do
+		local name=${template//\{threads\}/T}
+		name=${name//\{size\}/N}
+		name=${name//\{distribution\}/D}
+		name="scaling_`cut_output "${name//\{input\}/input}.csv"`"
+
+		for run in "${scaling_runs[@]}"
+		do
+			local run_name size thread_count file time
+			IFS='|' read run_name size thread_count file <<< "$run"
+			if [ "$run_name" != "$template" ]
+			then
+				continue
+			fi
+			time=`awk -F, -v c="$scaling_column" \
+				'$c ~ /^[0-9.]+$/ {s += $c; n++} END {if (n) print s / n}' \
+				"$output_dir/$file"`
+			echo "$size,$thread_count,$time"
+		done | awk -F, -v mode="$scaling" '
+			{
+				size[NR] = $1; p[NR] = $2; t[NR] = $3
+				key = mode == "weak" ? "" : $1
+				if (!(key in bp) || $2 < bp[key]) { bp[key] = $2; bt[key] = $3 }
+			}
+			END {
+				print "size,threads,time,speedup,efficiency,karp_flatt"
+				for (i = 1; i <= NR; ++i)
+				{
+					key = mode == "weak" ? "" : size[i]
+					if (t[i] <= 0)
+					{
+						continue
+					}
+					if (mode == "weak")
+					{
+						e = bt[key] / t[i]; s = e * p[i]
+					}
+					else
+					{
+						s = bp[key] * bt[key] / t[i]; e = s / p[i]
+					}
+					kf = "-"
+					if (p[i] > 1)
+					{
+						kf = sprintf("%.4f", (1 / s - 1 / p[i]) / (1 - 1 / p[i]))
+					}
+					printf "%s,%d,%.9f,%.4f,%.4f,%s\n", size[i], p[i], t[i], s, e, kf
+				}
+			}' > "$output_dir/$name"
+
+		echo "[+] $template ($scaling scaling, column $scaling_column)"
+		cat "$output_dir/$name"
+	done
+}
+
 if [ $# -ne 1 ]
 then
 	echo "Usage: $0 config_file"
@@ -49,6 +352,14 @@ warmup_time_initial=30s
 warmup_time_in_between="none"
 output_dir=out
 csv_header="none"
+threads="none"
+sizes="none"
+distributions="none"
+scaling=strong
+scaling_column="none"
+input_generator="none"
+input_dir="none"
+scaling_runs=()
 
 parsing_done=false
 
@@ -56,27 +367,7 @@ while read line
 do
 	if [ $parsing_done = true -a "$line" != "" ]
 	then
-		out_name=`cut_output "${line}.csv"`
-		if [ "$csv_header" != "none" ]
-		then
-			echo "$csv_header" > "$output_dir/$out_name"
-		fi
-		if [ "$warmup_time_in_between" != "none" ]
-		then
-			echo "[*] Starting warmup for $warmup_time_in_between"
-			stress-ng -q -c "$warmup_threads" -t "$warmup_time_in_between"
-		fi
-		for iteration in `seq 1 $iterations`
-		do
-			echo -n -e "\r[+] [$iteration/$iterations] Running $line"
-			$line >> "$output_dir/$out_name"
-			if [ $? -ne 0 ]
-			then
-				echo "[!] An error occurred. Exiting."
-				exit 1
-			fi
-		done
-		echo ""
+		run_template "$line"
 	else
 		case $line in
 		iterations=*)
@@ -97,6 +388,27 @@ do
 		csv_header=*)
 			csv_header=`get_config_data "$line"`
 			;;
+		threads=*)
+			threads=`get_config_data "$line"`
+			;;
+		sizes=*)
+			sizes=`get_config_data "$line"`
+			;;
+		distributions=*)
+			distributions=`get_config_data "$line"`
+			;;
+		scaling=*)
+			scaling=`get_config_data "$line"`
+			;;
+		scaling_column=*)
+			scaling_column=`get_config_data "$line"`
+			;;
+		input_generator=*)
+			input_generator=`get_config_data "$line"`
+			;;
+		input_dir=*)
+			input_dir=`get_config_data "$line"`
+			;;
 		run:)
 			parsing_done=true
 			echo "[+] Iterations = $iterations"
@@ -106,8 +418,20 @@ do
 			echo "[+] Base directory = $base_dir"
 			echo "[+] Output directory = $output_dir"
 			echo "[+] CSV header = $csv_header"
+			echo "[+] Threads = $threads"
+			echo "[+] Sizes = $sizes"
+			echo "[+] Distributions = $distributions"
+			resolve_scaling_column
+			echo "[+] Scaling = $scaling (column $scaling_column)"
+			echo "[+] Input generator = $input_generator"
+			if [ "$input_dir" = "none" ]
+			then
+				input_dir="$output_dir"
+			fi
+			echo "[+] Input directory = $input_dir"
 			echo "[*] Checking directories"
 			ensure_dir_existing "$output_dir"
+			ensure_dir_existing "$input_dir"
 			echo "[*] Starting warmup for $warmup_time_initial"
 			stress-ng -q -c "$warmup_threads" -t "$warmup_time_initial"
 			echo "[*] Starting benchmark"
@@ -122,4 +446,10 @@ do
 	fi
 done < "$config_file_abs"
 
+if [ ${#scaling_runs[@]} -ne 0 ]
+then
+	echo "[*] Scaling"
+	print_scaling_tables
+fi
+
 echo "[*] Done benchmarking"
@@ -0,0 +1,296 @@
+#!/bin/bash
+
+ensure_dir_existing()
+{
+	if [ ! -d $1 ]
+	then
+		echo "[!] Can not find directory '$1'"
+		exit 2
+	fi
+}
+
+usage()
+{
+	echo "Usage: $0 [-a alpha] [-t threshold] [-r resamples] [-s seed]" \
+		"base_dir new_dir"
+	exit 2
+}
+
+alpha=0.05
+threshold=0.05
+resamples=2000
+seed=1
+
+while getopts "a:t:r:s:" option
+do
+	case $option in
+	a)
+		alpha=$OPTARG
+		;;
+	t)
+		threshold=$OPTARG
+		;;
+	r)
+		resamples=$OPTARG
+		;;
+	s)
+		seed=$OPTARG
+		;;
+	*)
+		usage
+		;;
+	esac
+done
+
+shift $((OPTIND - 1))
+
+if [ $# -ne 2 ]
+then
+	usage
+fi
+
+base_dir=$1
+new_dir=$2
+ensure_dir_existing "$base_dir"
+ensure_dir_existing "$new_dir"
+
+echo "[*] Comparing '$new_dir' against '$base_dir'"
+echo "[+] Significance level = $alpha"
+echo "[+] Regression threshold = $threshold"
+echo "[+] Bootstrap resamples = $resamples"
+
+results=$(for base_file in "$base_dir"/*.csv
+do
+	name=`basename "$base_file"`
+	new_file="$new_dir/$name"
+
+	# Scaling tables are derived from the runs, not samples themselves
+	case $name in
+	scaling_*)
+		continue
+		;;
+	esac
+
+	if [ ! -f "$new_file" ]
+	then
+		echo "[!] '$name' is missing in '$new_dir'" >&2
+		continue
+	fi
+
+	# Every numeric column is compared. Lower values are better for all
+	# columns the programs print (times, counters, faults)
+	awk -F, -v name="$name" -v base="$base_file" -v alpha="$alpha" \
+		-v threshold="$threshold" -v resamples="$resamples" -v seed="$seed" '
+		function sort(a, n,    gap, i, j, v)
+		{
+			for (gap = int(n / 2); gap > 0; gap = int(gap / 2))
+			{
+				for (i = gap + 1; i <= n; ++i)
+				{
+					v = a[i]
+					for (j = i; j > gap && a[j - gap] > v; j -= gap)
+					{
+						a[j] = a[j - gap]
+					}
+					a[j] = v
+				}
+			}
+		}
+
+		function median(a, n)
+		{
+			sort(a, n)
+			return n % 2 == 1 ? a[(n + 1) / 2] : (a[n / 2] + a[n / 2 + 1]) / 2
+		}
+
+		# Median of a resample with replacement of column c of set s
+		function resample_median(s, c, n,    i, r)
+		{
+			for (i = 1; i <= n; ++i)
+			{
+				r[i] = value[s, c, int(rand() * n) + 1]
+			}
+			return median(r, n)
+		}
+
+		# Standard normal CDF (Abramowitz and Stegun 7.1.26)
+		function phi(z,    t, e)
+		{
+			t = 1 / (1 + 0.3275911 * (z < 0 ? -z : z) / sqrt(2))
+			e = 1.421413741 + t * (-1.453152027 + t * 1.061405429)
+			e = t * (0.254829592 + t * (-0.284496736 + t * e))
+			e *= exp(-z * z / 2)
+			return z < 0 ? e / 2 : 1 - e / 2
+		}
+
+		# Two-sided Mann-Whitney U test with normal approximation, tie
+		# correction and continuity correction
+		function mann_whitney(c, n1, n2,    n, i, j, k, v, l, r1, ties, u, var, z)
+		{
+			n = 0
+			for (i = 1; i <= n1; ++i) { v[++n] = value[0, c, i]; l[n] = 0 }
+			for (i = 1; i <= n2; ++i) { v[++n] = value[1, c, i]; l[n] = 1 }
+
+			# Sort values and labels together
+			for (i = 2; i <= n; ++i)
+			{
+				k = v[i]
+				u = l[i]
+				for (j = i; j > 1 && v[j - 1] > k; --j)
+				{
+					v[j] = v[j - 1]
+					l[j] = l[j - 1]
+				}
+				v[j] = k
+				l[j] = u
+			}
+
+			r1 = 0
+			ties = 0
+			for (i = 1; i <= n; i = j + 1)
+			{
+				for (j = i; j < n && v[j + 1] == v[i]; ++j) {}
+				k = j - i + 1
+				ties += k * k * k - k
+				for (u = i; u <= j; ++u)
+				{
+					if (l[u] == 0)
+					{
+						r1 += (i + j) / 2
+					}
+				}
+			}
+
+			u = r1 - n1 * (n1 + 1) / 2
+			var = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+			if (var <= 0)
+			{
+				return 1
+			}
+			z = (u - n1 * n2 / 2)
+			z = (z < 0 ? -z : z) - 0.5
+			z = z < 0 ? 0 : z / sqrt(var)
+			return 2 * (1 - phi(z))
+		}
+
+		BEGIN {
+			srand(seed)
+		}
+
+		FNR == 1 {
+			set = FILENAME == base ? 0 : 1
+		}
+
+		NF == 0 {
+			next
+		}
+
+		# Header line of csv_header
+		$1 !~ /^-?[0-9.]+$/ {
+			for (c = 1; c <= NF; ++c)
+			{
+				header[c] = $c
+			}
+			next
+		}
+
+		{
+			++count[set]
+			for (c = 1; c <= NF; ++c)
+			{
+				value[set, c, count[set]] = $c
+				if ($c !~ /^-?[0-9.]+$/)
+				{
+					missing[c] = 1
+				}
+			}
+			if (NF > columns)
+			{
+				columns = NF
+			}
+		}
+
+		END {
+			n1 = count[0]
+			n2 = count[1]
+			if (n1 < 2 || n2 < 2)
+			{
+				exit 0
+			}
+
+			for (c = 1; c <= columns; ++c)
+			{
+				# Empty cells of data, which was not recorded
+				if (c in missing)
+				{
+					continue
+				}
+
+				for (i = 1; i <= n1; ++i) a[i] = value[0, c, i]
+				for (i = 1; i <= n2; ++i) b[i] = value[1, c, i]
+				m1 = median(a, n1)
+				m2 = median(b, n2)
+				if (m1 <= 0)
+				{
+					continue
+				}
+
+				# Percentile bootstrap of the relative change of medians.
+				# Resamples of the base with median 0 (e.g. mostly zero
+				# counters) have no relative change and are skipped
+				valid = 0
+				for (r = 1; r <= resamples; ++r)
+				{
+					new_median = resample_median(1, c, n2)
+					base_median = resample_median(0, c, n1)
+					if (base_median > 0)
+					{
+						rel[++valid] = new_median / base_median - 1
+					}
+				}
+				if (valid < resamples / 2)
+				{
+					continue
+				}
+				sort(rel, valid)
+				low = rel[int(valid * alpha / 2) + 1]
+				high = rel[int(valid * (1 - alpha / 2))]
+
+				p = mann_whitney(c, n1, n2)
+				change = m2 / m1 - 1
+
+				verdict = "same"
+				if (p < alpha && low > 0)
+				{
+					verdict = change >= threshold ? "REGRESSION" : "slower"
+				}
+				else if (p < alpha && high < 0)
+				{
+					verdict = "faster"
+				}
+
+				printf "%s,%s,%d,%d,%.9g,%.9g,%+.2f%%,%+.2f%%,%+.2f%%,%.4f,%s\n",
+					name, c in header ? header[c] : c, n1, n2, m1, m2,
+					change * 100, low * 100, high * 100, p, verdict
+			}
+		}' "$base_file" "$new_file" || exit 2
+done)
+
+if [ $? -ne 0 ]
+then
+	echo "[!] Could not compare the results"
+	exit 2
+fi
+
+echo "file,column,n_base,n_new,median_base,median_new,change,ci_low,ci_high,p,verdict"
+echo "$results"
+
+regressions=`echo "$results" | grep -c ",REGRESSION$"`
+
+if [ $regressions -ne 0 ]
+then
+	echo "[!] $regressions regression(s) found"
+	exit 1
+fi
+
+echo "[*] No regressions found"
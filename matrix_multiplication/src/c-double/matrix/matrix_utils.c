@@ -1,14 +1,23 @@
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <sys/mman.h>
 
 #include "matrix.h"
 #include "matrix_utils.h"
+#include "../file/file_utils.h"
 
 void* matrix_mult_worker_thread(void* pthread_args)
 {
     matrix_args_t* args = (matrix_args_t*) pthread_args;
+    ttracker_pin_thread(args->thread_index);
+    ttracker_thread_start(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+    ttracker_span_begin(args->ttracker, "worker", args->thread_index);
 
     /* Thanks to calloc we can directly perform the multiplication */
     for (int index = args->start; index < args->end; ++index)
@@ -24,198 +33,707 @@ void* matrix_mult_worker_thread(void* pthread_args)
         }
     }
 
+    ttracker_span_end(args->ttracker);
+    ttracker_thread_stop(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+
+    return NULL;
+}
+
+/**
+ * Runs the worker function for every chunk or block. The main thread works
+ * on the first one
+ *
+ * @param worker Worker function
+ * @param args Parser or writer arguments for every thread
+ * @param args_size Size of the arguments of one thread
+ * @param thread_count Number of threads
+ */
+static void matrix_run_threads(void* (*worker)(void*), void* args,
+    size_t args_size, unsigned int thread_count)
+{
+    unsigned int spawned_count = thread_count - 1; // Excludes main thread
+    pthread_t threads[thread_count];
+
+    for (unsigned int i = 0; i < spawned_count; ++i)
+    {
+        pthread_create(&threads[i], NULL, worker,
+            (char*) args + (i + 1) * args_size);
+    }
+
+    worker(args);
+
+    for (unsigned int i = 0; i < spawned_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void matrix_split_string(const char* matrix_as_string, matrix_t* matrix,
+    matrix_parse_args_t* args, unsigned int thread_count)
+{
+    size_t length = strlen(matrix_as_string);
+    const char* end = matrix_as_string + length;
+
+    /* Every '[' after the first one opens a row */
+    const char* rows_start = memchr(matrix_as_string, '[', length);
+    rows_start = rows_start != NULL ? rows_start + 1 : end;
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        const char* start = matrix_as_string + length * i / thread_count;
+
+        if (i > 0)
+        {
+            start = start > rows_start ? start : rows_start;
+            start = memchr(start, '[', end - start);
+            start = start != NULL ? start : end;
+            args[i - 1].chunk.end = start;
+        }
+
+        /* All chunks except the first start in the outer brackets */
+        args[i].chunk.start = start;
+        args[i].chunk.dtype = MATRIX_DTYPE;
+        args[i].chunk.bracket_count = i > 0 ? 1 : 0;
+        args[i].chunk.expected_token = TOKEN_BRACKET_OPEN;
+        args[i].chunk.numbers = NULL;
+        args[i].matrix = matrix;
+        args[i].thread_index = i;
+    }
+
+    args[thread_count - 1].chunk.end = end;
+}
+
+void* matrix_parse_worker_thread(void* thread_args)
+{
+    matrix_parse_args_t* args = (matrix_parse_args_t*) thread_args;
+    ttracker_pin_thread(args->thread_index);
+
+    matrix_parse_chunk(&args->chunk);
+
     return NULL;
 }
 
-int matrix_check_and_parse_dimensions(const char* matrix_as_string,
-    matrix_t* matrix)
+int matrix_merge_chunks(matrix_parse_args_t* args,
+    unsigned int thread_count, matrix_t* matrix)
 {
+    const matrix_chunk_t* previous = &args[0].chunk;
     unsigned int rows = 0;
     unsigned int cols = 0;
-    int inner_commas = 0;
-    int outer_commas = 0;
-    int bracket_count = 0;
-    bool seen_colon = false;
-    unsigned char expected_token = TOKEN_BRACKET_OPEN;
-    char token;
 
-    /* Parse string and set dimensions */
-    while ((token = *(matrix_as_string++)))
+    for (unsigned int i = 0; i < thread_count; ++i)
     {
-        switch (token)
+        const matrix_chunk_t* chunk = &args[i].chunk;
+        args[i].start_row = rows;
+
+        /* Empty chunks don't change the state */
+        if (i > 0 && chunk->start == chunk->end)
         {
-        case '[':
-            if (!(expected_token & TOKEN_BRACKET_OPEN))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+            continue;
+        }
 
-            if (bracket_count < 1)
-            {
-                expected_token = TOKEN_BRACKET_OPEN;
-            }
-            else
-            {
-                expected_token = TOKEN_SIGN | TOKEN_NUMBER;
-            }
+        /* The parser codes equal the matrix codes */
+        if (chunk->error)
+        {
+            return chunk->error;
+        }
 
-            ++bracket_count;
-            break;
+        /* The previous chunk must end, where the next row can start */
+        if (i > 0 && (previous->bracket_count != 1
+            || previous->expected_token != TOKEN_BRACKET_OPEN))
+        {
+            return MATRIX_PAR_ERROR;
+        }
 
-        case ']':
-            if (!(expected_token & TOKEN_BRACKET_CLOSE))
+        if (chunk->cols != 0)
+        {
+            if (cols != 0 && cols != chunk->cols)
             {
                 return MATRIX_PAR_ERROR;
             }
-            if (bracket_count == 2)
-            {
-                if (cols == 0)
-                {
-                    cols = inner_commas + 1;
-                }
-                else
-                {
-                    if (cols != (inner_commas + 1))
-                    {
-                        return MATRIX_PAR_ERROR;
-                    }
-                }
-
-                inner_commas = 0;
-                expected_token = TOKEN_BRACKET_CLOSE | TOKEN_COMMA;
-            }
-            else if (bracket_count == 1)
-            {
-                rows = outer_commas + 1;
-                expected_token = TOKEN_NONE;
-            }
 
-            --bracket_count;
-            break;
+            cols = chunk->cols;
+        }
 
-        case ',':
-            if (!(expected_token & TOKEN_COMMA))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+        rows += chunk->rows;
+        previous = chunk;
+    }
 
-            switch (bracket_count)
-            {
-            case 1:
-                ++outer_commas;
-                expected_token = TOKEN_BRACKET_OPEN;
-                break;
-
-            case 2:
-                ++inner_commas;
-                expected_token = TOKEN_SIGN | TOKEN_NUMBER;
-                break;
-            }
+    /* The outer brackets must be closed */
+    if (previous->bracket_count != 0)
+    {
+        return MATRIX_PAR_ERROR;
+    }
 
-            seen_colon = false;
-            break;
+    matrix->rows = rows;
+    matrix->cols = cols;
 
-        case '+': case '-':
-            if (!(expected_token & TOKEN_SIGN))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+    return MATRIX_SUCCESS;
+}
 
-            expected_token = TOKEN_NUMBER;
-            break;
+void* matrix_copy_worker_thread(void* thread_args)
+{
+    matrix_parse_args_t* args = (matrix_parse_args_t*) thread_args;
+    matrix_t* matrix = args->matrix;
+    const double* numbers = (const double*) args->chunk.numbers;
+    ttracker_pin_thread(args->thread_index);
 
-        case '.':
-            if (!(expected_token & TOKEN_COLON))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+    if (args->chunk.count == 0)
+    {
+        return NULL;
+    }
 
-            expected_token = TOKEN_NUMBER;
-            seen_colon = true;
-            break;
+    memcpy(matrix->array + matrix_1d_index(args->start_row, 0, matrix),
+        numbers, sizeof(*numbers) * args->chunk.count);
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            if (!(expected_token & TOKEN_NUMBER))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+    return NULL;
+}
 
-            expected_token = TOKEN_NUMBER | TOKEN_COMMA | TOKEN_BRACKET_CLOSE;
+int matrix_parse_numbers(matrix_parse_args_t* args,
+    unsigned int thread_count, matrix_t* matrix)
+{
+    matrix_run_threads(matrix_parse_worker_thread, args, sizeof(*args),
+        thread_count);
+
+    int error = matrix_merge_chunks(args, thread_count, matrix);
+
+    if (!error)
+    {
+        size_t size = (size_t) matrix->rows * matrix->cols;
+        void* array = NULL;
 
-            if (!seen_colon)
+        /* A chunk with all numbers becomes the array of the matrix */
+        for (unsigned int i = 0; i < thread_count; ++i)
+        {
+            if (size > 0 && args[i].chunk.count == size)
             {
-                expected_token |= TOKEN_COLON;
+                array = args[i].chunk.numbers;
+                args[i].chunk.numbers = NULL;
             }
+        }
 
-            break;
+        if (array != NULL)
+        {
+            matrix->array = array;
+        }
+        else if (posix_memalign(&array, MATRIX_PARSER_ALIGNMENT,
+            sizeof(*matrix->array) * size))
+        {
+            error = MATRIX_MEM_ERROR;
+        }
+        else
+        {
+            matrix->array = array;
+            matrix_run_threads(matrix_copy_worker_thread, args, sizeof(*args),
+                thread_count);
+        }
+    }
 
-        case ' ': case '\n':
-            break;
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        matrix_free_chunk(&args[i].chunk);
+    }
 
-        default:
-            return MATRIX_PAR_ERROR;
+    return error;
+}
+
+/**
+ * A floating point number f * 2^e with a 64 bit significand, as used by
+ * Grisu2
+ */
+typedef struct _matrix_diy_fp_t
+{
+    uint64_t f; ///< Significand
+    int e;      ///< Binary exponent
+} matrix_diy_fp_t;
+
+/**
+ * Significands of the cached powers 10^k for k = -348, -340, ..., 340
+ */
+static const uint64_t matrix_cached_powers_f[] =
+{
+    0xfa8fd5a0081c0288UL, 0xbaaee17fa23ebf76UL, 0x8b16fb203055ac76UL,
+    0xcf42894a5dce35eaUL, 0x9a6bb0aa55653b2dUL, 0xe61acf033d1a45dfUL,
+    0xab70fe17c79ac6caUL, 0xff77b1fcbebcdc4fUL, 0xbe5691ef416bd60cUL,
+    0x8dd01fad907ffc3cUL, 0xd3515c2831559a83UL, 0x9d71ac8fada6c9b5UL,
+    0xea9c227723ee8bcbUL, 0xaecc49914078536dUL, 0x823c12795db6ce57UL,
+    0xc21094364dfb5637UL, 0x9096ea6f3848984fUL, 0xd77485cb25823ac7UL,
+    0xa086cfcd97bf97f4UL, 0xef340a98172aace5UL, 0xb23867fb2a35b28eUL,
+    0x84c8d4dfd2c63f3bUL, 0xc5dd44271ad3cdbaUL, 0x936b9fcebb25c996UL,
+    0xdbac6c247d62a584UL, 0xa3ab66580d5fdaf6UL, 0xf3e2f893dec3f126UL,
+    0xb5b5ada8aaff80b8UL, 0x87625f056c7c4a8bUL, 0xc9bcff6034c13053UL,
+    0x964e858c91ba2655UL, 0xdff9772470297ebdUL, 0xa6dfbd9fb8e5b88fUL,
+    0xf8a95fcf88747d94UL, 0xb94470938fa89bcfUL, 0x8a08f0f8bf0f156bUL,
+    0xcdb02555653131b6UL, 0x993fe2c6d07b7facUL, 0xe45c10c42a2b3b06UL,
+    0xaa242499697392d3UL, 0xfd87b5f28300ca0eUL, 0xbce5086492111aebUL,
+    0x8cbccc096f5088ccUL, 0xd1b71758e219652cUL, 0x9c40000000000000UL,
+    0xe8d4a51000000000UL, 0xad78ebc5ac620000UL, 0x813f3978f8940984UL,
+    0xc097ce7bc90715b3UL, 0x8f7e32ce7bea5c70UL, 0xd5d238a4abe98068UL,
+    0x9f4f2726179a2245UL, 0xed63a231d4c4fb27UL, 0xb0de65388cc8ada8UL,
+    0x83c7088e1aab65dbUL, 0xc45d1df942711d9aUL, 0x924d692ca61be758UL,
+    0xda01ee641a708deaUL, 0xa26da3999aef774aUL, 0xf209787bb47d6b85UL,
+    0xb454e4a179dd1877UL, 0x865b86925b9bc5c2UL, 0xc83553c5c8965d3dUL,
+    0x952ab45cfa97a0b3UL, 0xde469fbd99a05fe3UL, 0xa59bc234db398c25UL,
+    0xf6c69a72a3989f5cUL, 0xb7dcbf5354e9beceUL, 0x88fcf317f22241e2UL,
+    0xcc20ce9bd35c78a5UL, 0x98165af37b2153dfUL, 0xe2a0b5dc971f303aUL,
+    0xa8d9d1535ce3b396UL, 0xfb9b7cd9a4a7443cUL, 0xbb764c4ca7a44410UL,
+    0x8bab8eefb6409c1aUL, 0xd01fef10a657842cUL, 0x9b10a4e5e9913129UL,
+    0xe7109bfba19c0c9dUL, 0xac2820d9623bf429UL, 0x80444b5e7aa7cf85UL,
+    0xbf21e44003acdd2dUL, 0x8e679c2f5e44ff8fUL, 0xd433179d9c8cb841UL,
+    0x9e19db92b4e31ba9UL, 0xeb96bf6ebadf77d9UL, 0xaf87023b9bf0ee6bUL
+};
+
+/**
+ * Binary exponents of the cached powers 10^k for k = -348, -340, ..., 340
+ */
+static const int16_t matrix_cached_powers_e[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+/**
+ * Powers of ten, which fit into 64 bits
+ */
+static const uint64_t matrix_powers_of_ten[] =
+{
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL,
+    100000000UL, 1000000000UL, 10000000000UL, 100000000000UL,
+    1000000000000UL, 10000000000000UL, 100000000000000UL,
+    1000000000000000UL, 10000000000000000UL, 100000000000000000UL,
+    1000000000000000000UL, 10000000000000000000UL
+};
+
+/**
+ * Multiplies two numbers and rounds the upper 64 bits of the product
+ *
+ * @param x First number
+ * @param y Second number
+ * @return x * y
+ */
+static inline matrix_diy_fp_t matrix_diy_fp_multiply(matrix_diy_fp_t x,
+    matrix_diy_fp_t y)
+{
+    unsigned __int128 product = (unsigned __int128) x.f * y.f;
+    matrix_diy_fp_t result;
+    result.f = (uint64_t) (product >> 64) + ((uint64_t) product >> 63);
+    result.e = x.e + y.e + 64;
+
+    return result;
+}
+
+/**
+ * Returns the cached power c = 10^-k, so that c * 2^e is in [2^-60; 2^-32]
+ *
+ * @param e Binary exponent of the number to scale
+ * @param k The decimal exponent k
+ * @return The cached power
+ */
+static inline matrix_diy_fp_t matrix_cached_power(int e, int* k)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int index = (int) dk;
+
+    if (dk - index > 0.0)
+    {
+        ++index;
+    }
+
+    index = (index >> 3) + 1;
+    *k = -(-348 + (index << 3));
+
+    matrix_diy_fp_t power;
+    power.f = matrix_cached_powers_f[index];
+    power.e = matrix_cached_powers_e[index];
+
+    return power;
+}
+
+/**
+ * Moves the last digit towards the exact number, as long as the digits stay
+ * inside the rounding interval
+ *
+ * @param buffer Digits
+ * @param length Number of digits
+ * @param delta Size of the rounding interval
+ * @param rest Rest below the last digit
+ * @param ten_kappa Value of the last digit
+ * @param distance Distance of the upper bound to the exact number
+ */
+static inline void matrix_grisu_round(char* buffer, int length,
+    uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t distance)
+{
+    while (rest < distance && delta - rest >= ten_kappa
+        && (rest + ten_kappa < distance
+            || distance - rest > rest + ten_kappa - distance))
+    {
+        --buffer[length - 1];
+        rest += ten_kappa;
+    }
+}
+
+/**
+ * Generates the shortest digits inside the rounding interval
+ * [upper - delta; upper]
+ *
+ * @param number The scaled number
+ * @param upper The scaled upper bound
+ * @param delta Size of the rounding interval
+ * @param buffer Digits
+ * @param k The decimal exponent, which is adjusted to the digits
+ * @return Number of digits
+ */
+static int matrix_grisu_digits(matrix_diy_fp_t number, matrix_diy_fp_t upper,
+    uint64_t delta, char* buffer, int* k)
+{
+    uint64_t one = 1UL << -upper.e;
+    uint64_t distance = upper.f - number.f;
+    uint32_t integral = (uint32_t) (upper.f >> -upper.e);
+    uint64_t fraction = upper.f & (one - 1);
+    int kappa = 10;
+    int length = 0;
+
+    while (kappa > 0 && matrix_powers_of_ten[kappa - 1] > integral)
+    {
+        --kappa;
+    }
+
+    /* Digits of the integral part */
+    while (kappa > 0)
+    {
+        uint32_t power = (uint32_t) matrix_powers_of_ten[kappa - 1];
+        uint32_t digit = integral / power;
+        integral %= power;
+
+        if (digit != 0 || length != 0)
+        {
+            buffer[length++] = '0' + digit;
+        }
+
+        --kappa;
+        uint64_t rest = ((uint64_t) integral << -upper.e) + fraction;
+
+        if (rest <= delta)
+        {
+            *k += kappa;
+            matrix_grisu_round(buffer, length, delta, rest,
+                matrix_powers_of_ten[kappa] << -upper.e, distance);
+
+            return length;
         }
     }
 
-    matrix->rows = rows;
-    matrix->cols = cols;
+    /* Digits of the fractional part */
+    for (;;)
+    {
+        fraction *= 10;
+        delta *= 10;
+        char digit = (char) (fraction >> -upper.e);
 
-    return MATRIX_SUCCESS;
+        if (digit != 0 || length != 0)
+        {
+            buffer[length++] = '0' + digit;
+        }
+
+        fraction &= one - 1;
+        --kappa;
+
+        if (fraction < delta)
+        {
+            *k += kappa;
+            matrix_grisu_round(buffer, length, delta, fraction, one,
+                -kappa < 20 ? distance * matrix_powers_of_ten[-kappa] : 0);
+
+            return length;
+        }
+    }
 }
 
-int matrix_parse_numbers(const char* matrix_as_string,
-    matrix_t* matrix)
+/**
+ * Finds the shortest digits of a positive, finite number, which are parsed
+ * back to the same number (Grisu2)
+ *
+ * @param number The number
+ * @param buffer Digits
+ * @param k The decimal exponent of the digits
+ * @return Number of digits
+ */
+static int matrix_grisu2(double number, char* buffer, int* k)
 {
-    /* Allocate and check memory */
-    matrix->array = (double*) malloc(sizeof(double) *
-        matrix->rows * matrix->cols);
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+
+    /* Split the number into significand and exponent */
+    matrix_diy_fp_t value;
+    int biased_exponent = (int) (bits >> 52);
+    value.f = bits & ((1UL << 52) - 1);
+
+    if (biased_exponent != 0)
+    {
+        value.f += 1UL << 52;
+        value.e = biased_exponent - 1075;
+    }
+    else
+    {
+        value.e = -1074;
+    }
+
+    /* Boundaries of the numbers, which are rounded to the same double */
+    matrix_diy_fp_t upper = { (value.f << 1) + 1, value.e - 1 };
+
+    while (!(upper.f & (1UL << 53)))
+    {
+        upper.f <<= 1;
+        --upper.e;
+    }
+
+    upper.f <<= 10;
+    upper.e -= 10;
+
+    matrix_diy_fp_t lower = value.f == 1UL << 52
+        ? (matrix_diy_fp_t) { (value.f << 2) - 1, value.e - 2 }
+        : (matrix_diy_fp_t) { (value.f << 1) - 1, value.e - 1 };
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    /* Normalize the number, so its highest bit is set */
+    while (!(value.f & (1UL << 52)))
+    {
+        value.f <<= 1;
+        --value.e;
+    }
+
+    value.f <<= 11;
+    value.e -= 11;
+
+    /* Scale everything into the range of the digit generation */
+    matrix_diy_fp_t power = matrix_cached_power(upper.e, k);
+    value = matrix_diy_fp_multiply(value, power);
+    upper = matrix_diy_fp_multiply(upper, power);
+    lower = matrix_diy_fp_multiply(lower, power);
+    ++lower.f;
+    --upper.f;
+
+    return matrix_grisu_digits(value, upper, upper.f - lower.f, buffer, k);
+}
+
+int matrix_format_number(double number, char* buffer)
+{
+    char* position = buffer;
+
+    if (signbit(number))
+    {
+        *(position++) = '-';
+        number = -number;
+    }
+
+    if (isnan(number) || isinf(number))
+    {
+        memcpy(position, isnan(number) ? "nan" : "inf", 3);
+        return position + 3 - buffer;
+    }
+
+    if (number == 0.0)
+    {
+        *position = '0';
+        return position + 1 - buffer;
+    }
+
+    char digits[MATRIX_BUFF_SIZE];
+    int k;
+    int length = matrix_grisu2(number, digits, &k);
+    int point = length + k; // Position of the decimal point
+
+    if (point > 21 || point <= -6)
+    {
+        /* Scientific notation: d.ddde+x */
+        *(position++) = digits[0];
+
+        if (length > 1)
+        {
+            *(position++) = '.';
+            memcpy(position, digits + 1, length - 1);
+            position += length - 1;
+        }
+
+        position += sprintf(position, "e%+d", point - 1);
+    }
+    else if (point >= length)
+    {
+        /* Integer: ddd000 */
+        memcpy(position, digits, length);
+        memset(position + length, '0', point - length);
+        position += point;
+    }
+    else if (point > 0)
+    {
+        /* Decimal point inside the digits: dd.ddd */
+        memcpy(position, digits, point);
+        position[point] = '.';
+        memcpy(position + point + 1, digits + point, length - point);
+        position += length + 1;
+    }
+    else
+    {
+        /* Decimal point before the digits: 0.000ddd */
+        *(position++) = '0';
+        *(position++) = '.';
+        memset(position, '0', -point);
+        memcpy(position - point, digits, length);
+        position += length - point;
+    }
+
+    return position - buffer;
+}
 
-    if (matrix->array == NULL)
+void matrix_split_rows(const matrix_t* matrix, int fd,
+    matrix_write_args_t* args, unsigned int thread_count)
+{
+    for (unsigned int i = 0; i < thread_count; ++i)
     {
-        return MATRIX_MEM_ERROR;
+        args[i].matrix = matrix;
+        args[i].start_row = (unsigned long long) matrix->rows * i
+            / thread_count;
+        args[i].end_row = (unsigned long long) matrix->rows * (i + 1)
+            / thread_count;
+        args[i].buffer = NULL;
+        args[i].length = 0;
+        args[i].offset = 0;
+        args[i].fd = fd;
+        args[i].thread_index = i;
+        args[i].error = MATRIX_SUCCESS;
     }
+}
+
+void* matrix_format_worker_thread(void* thread_args)
+{
+    matrix_write_args_t* args = (matrix_write_args_t*) thread_args;
+    const matrix_t* matrix = args->matrix;
+    ttracker_pin_thread(args->thread_index);
 
-    bool num_available = false;
-    int matrix_index = 0;
-    int buffer_index = 0;
-    char num_buffer[MATRIX_BUFF_SIZE] = {0};
-    char token;
+    /* A row needs at most a full buffer per number, a comma and brackets */
+    size_t row_size = (size_t) matrix->cols * (MATRIX_BUFF_SIZE + 1) + 3;
+    size_t capacity = 0;
+    size_t length = 0;
 
-    /* Parse numbers */
-    while ((token = *(matrix_as_string++)))
+    for (unsigned int row = args->start_row; row < args->end_row; ++row)
     {
-        switch (token)
+        if (length + row_size > capacity)
         {
-        case '+': case '-': case '.':
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            num_available = true;
+            capacity = capacity > row_size ? capacity * 2 : 8 * row_size;
+            char* buffer = (char*) realloc(args->buffer, capacity);
+
+            if (buffer == NULL)
+            {
+                args->error = MATRIX_MEM_ERROR;
+                return NULL;
+            }
+
+            args->buffer = buffer;
+        }
 
-            // Fill buffer with tokens
-            num_buffer[buffer_index] = token;
-            ++buffer_index;
-            break;
+        const double* values = matrix->array + matrix_1d_index(row, 0, matrix);
+        char* position = args->buffer + length;
+        *(position++) = '[';
 
-        case ',': case ']':
-            if (!num_available)
+        for (int col = 0; col < matrix->cols; ++col)
+        {
+            if (col > 0)
             {
-                break;
+                *(position++) = ',';
             }
-            num_available = false;
-            matrix->array[matrix_index] = atof(num_buffer);
 
-            // Reset buffer
-            memset(num_buffer, 0, buffer_index + 1);
-            buffer_index = 0;
+            position += matrix_format_number(values[col], position);
+        }
 
-            ++matrix_index;
-            break;
+        *(position++) = ']';
 
-        default:
-            break;
+        if (row != matrix->rows - 1)
+        {
+            *(position++) = ',';
         }
+
+        length = position - args->buffer;
     }
 
-    return MATRIX_SUCCESS;
+    args->length = length;
+
+    return NULL;
+}
+
+void* matrix_write_worker_thread(void* thread_args)
+{
+    matrix_write_args_t* args = (matrix_write_args_t*) thread_args;
+    ttracker_pin_thread(args->thread_index);
+
+    if (write_file_at(args->fd, args->buffer, args->length, args->offset))
+    {
+        args->error = MATRIX_FILE_ERROR;
+    }
+
+    return NULL;
+}
+
+int matrix_write_rows(matrix_write_args_t* args, unsigned int thread_count)
+{
+    matrix_run_threads(matrix_format_worker_thread, args, sizeof(*args),
+        thread_count);
+
+    /* Every block starts behind the previous ones and the opening '[' */
+    int error = MATRIX_SUCCESS;
+    off_t offset = 1;
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        args[i].offset = offset;
+        offset += args[i].length;
+        error = error ? error : args[i].error;
+    }
+
+    if (!error)
+    {
+        matrix_run_threads(matrix_write_worker_thread, args, sizeof(*args),
+            thread_count);
+
+        for (unsigned int i = 0; i < thread_count; ++i)
+        {
+            error = error ? error : args[i].error;
+        }
+
+        if (write_file_at(args[0].fd, "[", 1, 0)
+            || write_file_at(args[0].fd, "]\n", 2, offset))
+        {
+            error = MATRIX_FILE_ERROR;
+        }
+    }
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        free(args[i].buffer);
+        args[i].buffer = NULL;
+    }
+
+    return error;
+}
+
+void matrix_cleanup(matrix_t* matrix)
+{
+    if (matrix->mapping != NULL)
+    {
+        munmap(matrix->mapping, matrix->mapping_size);
+    }
+    else
+    {
+        free(matrix->array);
+    }
+
+    matrix->array = NULL;
+    matrix->mapping = NULL;
 }
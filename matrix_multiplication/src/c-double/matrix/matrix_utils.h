@@ -1,32 +1,58 @@
 #ifndef MATRIX_UTILS_H
 #define MATRIX_UTILS_H
 
-#include "matrix.h"
+#include <sys/types.h>
 
-/* Defines for parsing */
-#define TOKEN_NONE          0x01 ///< Nothing is expected
-#define TOKEN_SIGN          0x02 ///< '+' or '-' sign is expected
-#define TOKEN_COLON         0x04 ///< '.' is expected
-#define TOKEN_COMMA         0x08 ///< ',' is expected
-#define TOKEN_NUMBER        0x10 ///< A number is expected
-#define TOKEN_BRACKET_OPEN  0x20 ///< '[' is expected
-#define TOKEN_BRACKET_CLOSE 0x40 ///< ']' is expected
+#include "matrix.h"
+#include "../../parser/matrix_parser.h"
 
 /* Defines for sizes */
-#define MATRIX_BUFF_SIZE    0x20 ///< Buffer size for converting chars to nums
+#define MATRIX_BUFF_SIZE    0x20 ///< Buffer size for converting nums & chars
 
 /**
  * Is used for multithreaded matrix multiplication
  */
 typedef struct _matrix_args_t
 {
-    const matrix_t* matrix1; ///< First matrix
-    const matrix_t* matrix2; ///< Second matrix
-    matrix_t* result;        ///< Result of matrix1 * matrix2
-    unsigned int start;      ///< Start index of calculation
-    unsigned int end;        ///< End index of calculation
+    const matrix_t* matrix1;   ///< First matrix
+    const matrix_t* matrix2;   ///< Second matrix
+    matrix_t* result;          ///< Result of matrix1 * matrix2
+    unsigned int start;        ///< Start index of calculation
+    unsigned int end;          ///< End index of calculation
+    unsigned int thread_index; ///< Index of the thread
+    ttracker_t* ttracker;      ///< Tracker for per-thread times
+    unsigned int ttracker_tid; ///< Event index of the multiplication
 } matrix_args_t;
 
+/**
+ * Is used for multithreaded parsing. Every thread parses a chunk of the
+ * matrix string into the numbers of the chunk
+ */
+typedef struct _matrix_parse_args_t
+{
+    matrix_chunk_t chunk;      ///< Chunk and its numbers
+    matrix_t* matrix;          ///< Target matrix
+    unsigned int start_row;    ///< Index of the first row of the chunk
+    unsigned int thread_index; ///< Index of the thread
+} matrix_parse_args_t;
+
+/**
+ * Is used for multithreaded writing. Every thread formats a block of rows
+ * into its own buffer, which is written at the offset of the block
+ */
+typedef struct _matrix_write_args_t
+{
+    const matrix_t* matrix;    ///< Matrix to write
+    unsigned int start_row;    ///< First row of the block
+    unsigned int end_row;      ///< End row of the block
+    char* buffer;              ///< Formatted rows of the block
+    size_t length;             ///< Length of the formatted rows
+    off_t offset;              ///< Offset of the block in the file
+    int fd;                    ///< Descriptor of the file
+    unsigned int thread_index; ///< Index of the thread
+    int error;                 ///< MATRIX_SUCCESS, if the block is written
+} matrix_write_args_t;
+
 /**
  * Calculates the 1D index from 2D index values
  *
@@ -76,25 +102,116 @@ static inline unsigned int matrix_2d_index_col(unsigned int index_1d,
 void* matrix_mult_worker_thread(void* pthread_args);
 
 /**
- * Parses a given matrix string and sets the dimensions of the resulting matrix
+ * Splits the matrix string into one chunk per thread. Every chunk except the
+ * first starts at the '[' of a row, so it contains whole rows only
+ *
+ * @param matrix_as_string String representation of the matrix
+ * @param matrix Target matrix
+ * @param args Parser arguments for every thread
+ * @param thread_count Number of threads
+ */
+void matrix_split_string(const char* matrix_as_string, matrix_t* matrix,
+    matrix_parse_args_t* args, unsigned int thread_count);
+
+/**
+ * Validates a chunk of the matrix string, counts its rows and parses its
+ * numbers in a single pass
+ *
+ * @param thread_args Parser arguments
+ * @return NULL
+ */
+void* matrix_parse_worker_thread(void* thread_args);
+
+/**
+ * Checks that the parsed chunks fit together and sets the dimensions of the
+ * resulting matrix and the first row of every chunk
  *
  * The function may change the matrix attributes, even on failure
  *
- * @param matrix_as_string String representation of the matrix
+ * @param args Parser arguments for every thread
+ * @param thread_count Number of threads
  * @param matrix Target matrix
  * @return MATRIX_SUCCESS, if successful
  */
-int matrix_check_and_parse_dimensions(const char* matrix_as_string,
-    matrix_t* matrix);
+int matrix_merge_chunks(matrix_parse_args_t* args,
+    unsigned int thread_count, matrix_t* matrix);
 
 /**
- * Parses the numbers of a given matrix string
+ * Copies the numbers of a chunk into its rows of the matrix
  *
- * @param matrix_as_string String representation of the matrix
+ * @param thread_args Parser arguments
+ * @return NULL
+ */
+void* matrix_copy_worker_thread(void* thread_args);
+
+/**
+ * Parses the chunks in parallel, allocates the matrix and copies the
+ * numbers of the chunks into it in parallel. Frees the numbers of the
+ * chunks
+ *
+ * The function may change the matrix attributes, even on failure
+ *
+ * @param args Parser arguments for every thread
+ * @param thread_count Number of threads
  * @param matrix Target matrix
  * @return MATRIX_SUCCESS, if successful
  */
-int matrix_parse_numbers(const char* matrix_as_string,
-    matrix_t* matrix);
+int matrix_parse_numbers(matrix_parse_args_t* args,
+    unsigned int thread_count, matrix_t* matrix);
+
+/**
+ * Formats a number with the shortest digits, which are parsed back to the
+ * same number (Grisu2). Numbers from 1e-6 to below 1e21 are written without
+ * an exponent
+ *
+ * @param number The number
+ * @param buffer Target with room for MATRIX_BUFF_SIZE chars
+ * @return Number of chars written
+ */
+int matrix_format_number(double number, char* buffer);
+
+/**
+ * Splits the rows of the matrix into one block per thread
+ *
+ * @param matrix Matrix to write
+ * @param fd Descriptor of the file
+ * @param args Writer arguments for every thread
+ * @param thread_count Number of threads
+ */
+void matrix_split_rows(const matrix_t* matrix, int fd,
+    matrix_write_args_t* args, unsigned int thread_count);
+
+/**
+ * Formats the rows of a block into the buffer of the thread
+ *
+ * @param thread_args Writer arguments
+ * @return NULL
+ */
+void* matrix_format_worker_thread(void* thread_args);
+
+/**
+ * Writes the buffer of a block at its offset
+ *
+ * @param thread_args Writer arguments
+ * @return NULL
+ */
+void* matrix_write_worker_thread(void* thread_args);
+
+/**
+ * Formats the blocks in parallel, places every block behind the previous
+ * ones and writes them in parallel with pwrite. Frees the buffers
+ *
+ * @param args Writer arguments for every thread
+ * @param thread_count Number of threads
+ * @return MATRIX_SUCCESS, if successful
+ */
+int matrix_write_rows(matrix_write_args_t* args, unsigned int thread_count);
+
+/**
+ * Frees or unmaps the elements of the matrix
+ *
+ * @param matrix Matrix
+ */
+void matrix_cleanup(matrix_t* matrix);
 
 #endif
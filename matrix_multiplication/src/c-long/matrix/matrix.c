@@ -2,22 +2,112 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "matrix.h"
 #include "matrix_utils.h"
+#include "../file/file_utils.h"
 
-int matrix_from_string(const char* matrix_as_string, matrix_t* matrix)
+int matrix_from_string(const char* matrix_as_string, matrix_t* matrix,
+    unsigned int thread_count)
 {
-    if (matrix_check_and_parse_dimensions(matrix_as_string, matrix))
+    matrix->mapping = NULL;
+
+    matrix->array = NULL;
+
+    matrix_parse_args_t args[thread_count];
+    matrix_split_string(matrix_as_string, matrix, args, thread_count);
+
+    return matrix_parse_numbers(args, thread_count, matrix);
+}
+
+int matrix_read_file(const char* filename, matrix_t* matrix,
+    unsigned int thread_count, int* write_cache)
+{
+    *write_cache = 0;
+
+    if (matrix_is_binary_file(filename))
     {
-        return MATRIX_PAR_ERROR;
+        return matrix_from_binary_file(filename, matrix);
     }
 
-    if (matrix_parse_numbers(matrix_as_string, matrix))
+    int cache = input_cache_enabled();
+    char* sidecar = cache ? input_cache_find(filename, MATRIX_CACHE_SUFFIX)
+        : NULL;
+
+    if (sidecar != NULL)
     {
-        return MATRIX_MEM_ERROR;
+        int error = matrix_from_binary_file(sidecar, matrix);
+        free(sidecar);
+
+        return error;
+    }
+
+    char* matrix_as_string = read_file(filename);
+
+    if (matrix_as_string == NULL)
+    {
+        return MATRIX_FILE_ERROR;
     }
 
+    int error = matrix_from_string(matrix_as_string, matrix, thread_count);
+    free(matrix_as_string);
+
+    *write_cache = error == MATRIX_SUCCESS && cache;
+
+    return error;
+}
+
+int matrix_is_binary_file(const char* filename)
+{
+    char magic[MATRIX_FILE_MAGIC_SIZE];
+    FILE* fp = fopen(filename, "r");
+
+    if (fp == NULL)
+    {
+        return 0;
+    }
+
+    size_t read = fread(magic, 1, MATRIX_FILE_MAGIC_SIZE, fp);
+    fclose(fp);
+
+    return read == MATRIX_FILE_MAGIC_SIZE
+        && memcmp(magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE) == 0;
+}
+
+int matrix_from_binary_file(const char* filename, matrix_t* matrix)
+{
+    size_t size;
+    void* mapping = map_file(filename, &size);
+
+    if (mapping == NULL)
+    {
+        return MATRIX_FILE_ERROR;
+    }
+
+    const matrix_file_header_t* header = (const matrix_file_header_t*) mapping;
+
+    if (size < MATRIX_FILE_HEADER_SIZE
+        || memcmp(header->magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE)
+        || header->dtype != MATRIX_DTYPE
+        || header->element_size != sizeof(long long int)
+        || (unsigned long long) header->rows * header->cols
+            > (size - MATRIX_FILE_HEADER_SIZE) / sizeof(long long int))
+    {
+        munmap(mapping, size);
+        return MATRIX_PAR_ERROR;
+    }
+
+    matrix->rows = header->rows;
+    matrix->cols = header->cols;
+    matrix->mapping = mapping;
+    matrix->mapping_size = size;
+
+    matrix->array = (long long int*)
+        ((char*) mapping + MATRIX_FILE_HEADER_SIZE);
+
     return MATRIX_SUCCESS;
 }
 
@@ -31,6 +121,7 @@ int matrix_mult(const matrix_t* matrix1, const matrix_t* matrix2,
 
     result->rows = matrix1->rows;
     result->cols = matrix2->cols;
+    result->mapping = NULL;
 
     /* Allocate and check memory using calloc */
     result->array = (long long int*) calloc(result->rows * result->cols,
@@ -59,7 +150,8 @@ int matrix_mult(const matrix_t* matrix1, const matrix_t* matrix2,
 }
 
 int matrix_mult_parallel(const matrix_t* matrix1, const matrix_t* matrix2,
-    matrix_t* result, unsigned int thread_count)
+    matrix_t* result, unsigned int thread_count, ttracker_t* ttracker,
+    unsigned int ttracker_tid)
 {
     if (matrix1->cols != matrix2->rows)
     {
@@ -68,6 +160,7 @@ int matrix_mult_parallel(const matrix_t* matrix1, const matrix_t* matrix2,
 
     result->rows = matrix1->rows;
     result->cols = matrix2->cols;
+    result->mapping = NULL;
 
     /* Allocate and check memory using calloc */
     int array_length = result->rows * result->cols;
@@ -96,6 +189,9 @@ int matrix_mult_parallel(const matrix_t* matrix1, const matrix_t* matrix2,
         args[i].matrix1 = matrix1;
         args[i].matrix2 = matrix2;
         args[i].result = result;
+        args[i].thread_index = i;
+        args[i].ttracker = ttracker;
+        args[i].ttracker_tid = ttracker_tid;
 
         args[i].start = i * indizes_per_thread + index_offset;
         args[i].end = (i + 1) * indizes_per_thread + index_offset;
@@ -127,53 +223,75 @@ int matrix_mult_parallel(const matrix_t* matrix1, const matrix_t* matrix2,
     return MATRIX_SUCCESS;
 }
 
-int matrix_write_file(const matrix_t* matrix, const char* filename)
+int matrix_write_file(const matrix_t* matrix, const char* filename,
+    unsigned int thread_count)
 {
-    FILE* fp = fopen(filename, "w");
-    char buffer[MATRIX_BUFF_SIZE] = {0};
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
-    if (fp == NULL)
+    if (fd == -1)
     {
         return MATRIX_FILE_ERROR;
     }
 
-    fputc('[', fp);
+    matrix_write_args_t args[thread_count];
+    matrix_split_rows(matrix, fd, args, thread_count);
 
-    for (int row = 0; row < matrix->rows; ++row)
-    {
-        fputc('[', fp);
+    int error = matrix_write_rows(args, thread_count);
 
-        for (int col = 0; col < matrix->cols; ++col)
-        {
-            sprintf(buffer, "%lld",
-                matrix->array[matrix_1d_index(row, col, matrix)]);
+    if (close(fd) == -1 && !error)
+    {
+        error = MATRIX_FILE_ERROR;
+    }
 
-            fputs(buffer, fp);
-            memset(buffer, 0, MATRIX_BUFF_SIZE);
+    return error;
+}
 
-            if (col != matrix->cols - 1)
-            {
-                fputc(',', fp);
-            }
-        }
+int matrix_write_binary_file(const matrix_t* matrix, const char* filename)
+{
+    matrix_file_header_t header = {0};
+    memcpy(header.magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE);
+    header.dtype = MATRIX_DTYPE;
+    header.element_size = sizeof(long long int);
+    header.rows = matrix->rows;
+    header.cols = matrix->cols;
 
-        fputc(']', fp);
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
-        if (row != matrix->rows - 1)
-        {
-            fputc(',', fp);
-        }
+    if (fd == -1)
+    {
+        return MATRIX_FILE_ERROR;
     }
 
-    fputs("]\n", fp);
+    int error = write_file_at(fd, &header, sizeof(header), 0);
 
-    if (ferror(fp))
+    /* The elements are contiguous, so they are written at once */
+    if (!error)
     {
-        fclose(fp);
-        return MATRIX_FILE_ERROR;
+        error = write_file_at(fd, matrix->array,
+            (size_t) matrix->rows * matrix->cols * sizeof(long long int),
+            MATRIX_FILE_HEADER_SIZE);
     }
 
-    fclose(fp);
+    if (close(fd) == -1 || error)
+    {
+        return MATRIX_FILE_ERROR;
+    }
 
     return MATRIX_SUCCESS;
 }
+
+int matrix_write_cache(const matrix_t* matrix, const char* filename)
+{
+    matrix_file_header_t header = {0};
+    memcpy(header.magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE);
+    header.dtype = MATRIX_DTYPE;
+    header.element_size = sizeof(long long int);
+    header.rows = matrix->rows;
+    header.cols = matrix->cols;
+
+    input_cache_part_t part = { matrix->array,
+        (size_t) matrix->rows * matrix->cols * sizeof(long long int) };
+
+    return input_cache_write(filename, MATRIX_CACHE_SUFFIX, &header, &part, 1)
+        ? MATRIX_FILE_ERROR : MATRIX_SUCCESS;
+}
@@ -1,6 +1,12 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include <stddef.h>
+
+#include <ttracker.h>
+
+#include "../../cache/input_cache.h"
+
 /* Defines for matrix return codes */
 #define MATRIX_SUCCESS      0x00 ///< Success
 #define MATRIX_PAR_ERROR    0x01 ///< Parsing error
@@ -8,6 +14,30 @@
 #define MATRIX_DIM_ERROR    0x03 ///< Matrix dimensions don't match
 #define MATRIX_FILE_ERROR   0x04 ///< Could not write to file
 
+/* Defines for binary matrix files */
+#define MATRIX_FILE_MAGIC       "DBMATRX1" ///< First bytes of the file
+#define MATRIX_FILE_MAGIC_SIZE  8          ///< Size of the magic in bytes
+#define MATRIX_FILE_HEADER_SIZE 64         ///< Offset of the first element
+#define MATRIX_DTYPE_LONG       0x01       ///< Elements are long long ints
+#define MATRIX_DTYPE_DOUBLE     0x02       ///< Elements are doubles
+
+#define MATRIX_DTYPE MATRIX_DTYPE_LONG ///< Element type of this program
+#define MATRIX_CACHE_SUFFIX ".long.dbin" ///< Suffix of its sidecars
+
+/**
+ * Header of a binary matrix file. The elements follow the header directly
+ * row by row, so they are 64-byte aligned in a mapping of the file
+ */
+typedef struct _matrix_file_header_t
+{
+    char magic[MATRIX_FILE_MAGIC_SIZE]; ///< MATRIX_FILE_MAGIC
+    unsigned int dtype;                 ///< MATRIX_DTYPE_LONG or _DOUBLE
+    unsigned int element_size;          ///< Element size in bytes
+    unsigned int rows;                  ///< Rows of the matrix
+    unsigned int cols;                  ///< Cols of the matrix
+    unsigned long long reserved[5];     ///< Sidecar key or 0, pads to 64 bytes
+} matrix_file_header_t;
+
 /**
  * Represents a matrix
  */
@@ -16,6 +46,8 @@ typedef struct _matrix_t
     long long int* array; ///< Contains the elements row by row
     unsigned int rows;    ///< Rows of the matrix
     unsigned int cols;    ///< Cols of the matrix
+    void* mapping;        ///< Mapped binary file or NULL
+    size_t mapping_size;  ///< Size of the mapping in bytes
 } matrix_t;
 
 /**
@@ -25,9 +57,46 @@ typedef struct _matrix_t
  *
  * @param matrix_as_string String representation of the matrix
  * @param matrix Resulting matrix
+ * @param thread_count Threads for parsing
+ * @return MATRIX_SUCCESS, if successful
+ */
+int matrix_from_string(const char* matrix_as_string, matrix_t* matrix,
+    unsigned int thread_count);
+
+/**
+ * Reads a matrix file. Binary matrix files are mapped, text files are
+ * parsed. If the input cache is enabled, a text file is mapped from its
+ * valid sidecar instead, or its sidecar is written after parsing
+ *
+ * The function may change the matrix attributes, even on failure
+ *
+ * @param filename Name of the file
+ * @param matrix Resulting matrix
+ * @param thread_count Threads for parsing a text file
+ * @param write_cache Set to 1, if the matrix was parsed with the input cache
+ *        enabled, so its sidecar should be written with matrix_write_cache
+ * @return MATRIX_SUCCESS, if successful. MATRIX_FILE_ERROR, if the file
+ *         couldn't be read
+ */
+int matrix_read_file(const char* filename, matrix_t* matrix,
+    unsigned int thread_count, int* write_cache);
+
+/**
+ * Checks whether a file starts with the magic of a binary matrix file
+ *
+ * @param filename Name of the file
+ * @return 1, if the file is a binary matrix file, else 0
+ */
+int matrix_is_binary_file(const char* filename);
+
+/**
+ * Creates a matrix from a binary matrix file by mapping the file
+ *
+ * @param filename Name of the file
+ * @param matrix Resulting matrix
  * @return MATRIX_SUCCESS, if successful
  */
-int matrix_from_string(const char* matrix_as_string, matrix_t* matrix);
+int matrix_from_binary_file(const char* filename, matrix_t* matrix);
 
 /**
  * Performs a matrix multiplication
@@ -51,18 +120,43 @@ int matrix_mult(const matrix_t* matrix1, const matrix_t* matrix2,
  * @param matrix2 Second matrix
  * @param result Result of matrix1 * matrix2
  * @param thread_count Worker thread count
+ * @param ttracker Tracker for the per-thread multiplication times
+ * @param ttracker_tid Event index of the multiplication phase
  * @return MATRIX_SUCCESS, if successful
  */
 int matrix_mult_parallel(const matrix_t* matrix1, const matrix_t* matrix2,
-    matrix_t* result, unsigned int thread_count);
+    matrix_t* result, unsigned int thread_count, ttracker_t* ttracker,
+    unsigned int ttracker_tid);
 
 /**
- * Writes the matrix matrix to the file with name filename
+ * Writes the matrix matrix to the file with name filename. Every thread
+ * formats a block of rows, which is written at its offset in the file
  *
  * @param matrix Matrix to print
  * @param filename Name of the file
+ * @param thread_count Number of threads
+ * @return MATRIX_SUCCESS, if successful
+ */
+int matrix_write_file(const matrix_t* matrix, const char* filename,
+    unsigned int thread_count);
+
+/**
+ * Writes the matrix matrix to the binary matrix file with name filename
+ *
+ * @param matrix Matrix to write
+ * @param filename Name of the file
+ * @return MATRIX_SUCCESS, if successful
+ */
+int matrix_write_binary_file(const matrix_t* matrix, const char* filename);
+
+/**
+ * Writes a matrix parsed from a text file into the sidecar of the file (see
+ * cache/input_cache.h)
+ *
+ * @param matrix Parsed matrix
+ * @param filename Name of the text file
  * @return MATRIX_SUCCESS, if successful
  */
-int matrix_write_file(const matrix_t* matrix, const char* filename);
+int matrix_write_cache(const matrix_t* matrix, const char* filename);
 
 #endif
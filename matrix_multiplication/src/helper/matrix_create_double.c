@@ -1,76 +1,559 @@
-#include <time.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/random.h>
 
-#define BUFF_SIZE 32
+#define BUFF_SIZE   (4 << 20) ///< Output buffer of every thread in bytes
+#define NUMBER_SIZE 64        ///< Longest formatted number with brackets
+#define DECIMALS    6         ///< Digits after the decimal point
+#define SCALE       1000000   ///< 10^DECIMALS
+#define MAX_NUM     9.2e12    ///< Biggest |min_num|, |max_num| and range
+
+/* Defines for the Philox4x32-10 generator */
+#define PHILOX_ROUNDS 10          ///< Rounds per counter
+#define PHILOX_M0     0xD2511F53U ///< Multiplier of the first word
+#define PHILOX_M1     0xCD9E8D57U ///< Multiplier of the third word
+#define PHILOX_W0     0x9E3779B9U ///< Key increment of the first word
+#define PHILOX_W1     0xBB67AE85U ///< Key increment of the second word
+
+/* Defines for binary matrix files, see matrix/matrix.h of the programs */
+#define MATRIX_FILE_MAGIC       "DBMATRX1" ///< First bytes of the file
+#define MATRIX_FILE_MAGIC_SIZE  8          ///< Size of the magic in bytes
+#define MATRIX_DTYPE_LONG       0x01       ///< Elements are long long ints
+#define MATRIX_DTYPE_DOUBLE     0x02       ///< Elements are doubles
 
 /**
- * Generates a random number in [min;max]
+ * Header of a binary matrix file. The elements follow the header directly
+ * row by row
+ */
+typedef struct _matrix_file_header_t
+{
+    char magic[MATRIX_FILE_MAGIC_SIZE]; ///< MATRIX_FILE_MAGIC
+    unsigned int dtype;                 ///< MATRIX_DTYPE_LONG or _DOUBLE
+    unsigned int element_size;          ///< Element size in bytes
+    unsigned int rows;                  ///< Rows of the matrix
+    unsigned int cols;                  ///< Cols of the matrix
+    unsigned long long reserved[5];     ///< Pads the header to 64 bytes
+} matrix_file_header_t;
+
+/**
+ * Is used for creating the matrix in parallel. Every thread creates a block
+ * of elements and writes it at the offset of the block
+ */
+typedef struct _create_args_t
+{
+    unsigned long long start;  ///< First element of the block
+    unsigned long long end;    ///< End of the block
+    unsigned long long rows;   ///< Rows of the matrix
+    unsigned long long cols;   ///< Cols of the matrix
+    unsigned long long seed;   ///< Seed of the generator
+    long long min;             ///< Smallest element in millionths
+    unsigned long long range;  ///< Number of possible elements
+    int binary;                ///< 1 for a binary file, 0 for text
+    int fd;                    ///< Descriptor of the file
+    off_t offset;              ///< Offset of the block in the file
+    unsigned long long length; ///< Length of the block in bytes
+    int error;                 ///< EXIT_SUCCESS, if the block is written
+} create_args_t;
+
+/**
+ * Generates the random number with the given index (Philox4x32-10). The
+ * number only depends on the seed and the index, so every thread can
+ * generate any part of the matrix
  *
- * @param min Minimum number
- * @param max Maximum number
- * @return A random number
+ * @param seed Seed of the generator
+ * @param index Index of the number
+ * @return A random number in [0; 2^64 - 1]
  */
-static inline double random_number(double min, double max)
+static inline uint64_t random_number(uint64_t seed, uint64_t index)
 {
-    double scale = (double) rand() / RAND_MAX;
-    return min + scale * (max - min);
+    uint32_t counter[4] = { (uint32_t) index, (uint32_t) (index >> 32), 0, 0 };
+    uint32_t key[2] = { (uint32_t) seed, (uint32_t) (seed >> 32) };
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        uint64_t product0 = (uint64_t) PHILOX_M0 * counter[0];
+        uint64_t product1 = (uint64_t) PHILOX_M1 * counter[2];
+
+        counter[0] = (uint32_t) (product1 >> 32) ^ counter[1] ^ key[0];
+        counter[1] = (uint32_t) product1;
+        counter[2] = (uint32_t) (product0 >> 32) ^ counter[3] ^ key[1];
+        counter[3] = (uint32_t) product0;
+
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+
+    return ((uint64_t) counter[1] << 32) | counter[0];
 }
 
 /**
- * Reads parameters from argv and creates a matrix file
+ * Generates the element with the given index in [min;max] in millionths,
+ * so that the text with DECIMALS decimals is exact and is parsed to the
+ * same double as the element of a binary file
  *
- * @param argc Argument count
- * @param argv Argument strings
+ * @param args Creator arguments
+ * @param index Index of the element
+ * @return The element in millionths
+ */
+static inline long long int element(const create_args_t* args,
+    uint64_t index)
+{
+    uint64_t number = random_number(args->seed, index);
+    return args->min
+        + (long long) (((unsigned __int128) number * args->range) >> 64);
+}
+
+/**
+ * Two digit strings for the numbers 0 to 99
+ */
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+/**
+ * Counts the decimal digits of a number
+ *
+ * @param number The number
+ * @return Number of digits
+ */
+static inline int count_digits(unsigned long long number)
+{
+    int digits = 1;
+
+    for (unsigned long long limit = 10; digits < 20 && number >= limit;
+        limit *= 10)
+    {
+        ++digits;
+    }
+
+    return digits;
+}
+
+/**
+ * Formats the digits of a number with two digits per division, from the
+ * last to the first
+ *
+ * @param number The number
+ * @param digits Number of digits, see count_digits
+ * @param buffer Target with room for the digits
+ */
+static inline void format_digits(unsigned long long number, int digits,
+    char* buffer)
+{
+    char* position = buffer + digits;
+
+    while (number >= 100)
+    {
+        position -= 2;
+        memcpy(position, digit_pairs + number % 100 * 2, 2);
+        number /= 100;
+    }
+
+    if (number >= 10)
+    {
+        memcpy(position - 2, digit_pairs + number * 2, 2);
+    }
+    else
+    {
+        position[-1] = '0' + number;
+    }
+}
+
+/**
+ * Formats an element in millionths as decimal number with DECIMALS decimals
+ *
+ * @param number The element in millionths
+ * @param buffer Target with room for NUMBER_SIZE chars or NULL to count
+ * @return Number of chars
+ */
+static inline int format_number(long long int number, char* buffer)
+{
+    int sign = number < 0;
+    unsigned long long value = sign ? 0ULL - number
+        : (unsigned long long) number;
+    int digits = count_digits(value / SCALE);
+
+    if (buffer != NULL)
+    {
+        buffer[0] = '-';
+        format_digits(value / SCALE, digits, buffer + sign);
+        buffer[sign + digits] = '.';
+        memset(buffer + sign + digits + 1, '0', DECIMALS);
+        format_digits(value % SCALE, DECIMALS, buffer + sign + digits + 1);
+    }
+
+    return sign + digits + 1 + DECIMALS;
+}
+
+/**
+ * Formats an element with the brackets and commas around it. The first
+ * element of a row is preceded by its '[', the last one is followed by its
+ * ']'. The last element of the matrix is followed by "]]\n"
+ *
+ * @param args Creator arguments
+ * @param index Index of the element
+ * @param buffer Target with room for NUMBER_SIZE chars or NULL to count
+ * @return Number of chars
+ */
+static inline int format_element(const create_args_t* args,
+    unsigned long long index, char* buffer)
+{
+    unsigned long long row = index / args->cols;
+    unsigned long long col = index % args->cols;
+    const char* prefix = col > 0 ? "," : row > 0 ? ",[" : "[[";
+    const char* suffix = col < args->cols - 1 ? ""
+        : row < args->rows - 1 ? "]" : "]]\n";
+    int prefix_length = col > 0 ? 1 : 2;
+    int suffix_length = col < args->cols - 1 ? 0
+        : row < args->rows - 1 ? 1 : 3;
+
+    if (buffer == NULL)
+    {
+        return prefix_length + format_number(element(args, index), NULL)
+            + suffix_length;
+    }
+
+    memcpy(buffer, prefix, prefix_length);
+    int length = prefix_length
+        + format_number(element(args, index), buffer + prefix_length);
+    memcpy(buffer + length, suffix, suffix_length);
+
+    return length + suffix_length;
+}
+
+/**
+ * Writes a buffer completely at an offset
+ *
+ * @param fd Descriptor of the file
+ * @param buffer The buffer
+ * @param length Length of the buffer
+ * @param offset Offset in the file
  * @return EXIT_SUCCESS, if successful
  */
-int main(int argc, char *argv[])
+static int write_at(int fd, const char* buffer, size_t length, off_t offset)
 {
-    if (argc != 6)
+    while (length > 0)
     {
-        printf("Usage: %s rows cols min_num max_num filename\n", argv[0]);
-        return EXIT_FAILURE;
+        ssize_t written = pwrite(fd, buffer, length, offset);
+
+        if (written <= 0)
+        {
+            return EXIT_FAILURE;
+        }
+
+        buffer += written;
+        length -= written;
+        offset += written;
     }
 
-    const int rows = atoi(argv[1]);
-    const int cols = atoi(argv[2]);
-    const double min_num = atof(argv[3]);
-    const double max_num = atof(argv[4]);
-    const char* filename = argv[5];
+    return EXIT_SUCCESS;
+}
 
-    char buffer[BUFF_SIZE] = {0};
+/**
+ * Counts the text length of a block without writing it
+ *
+ * @param thread_args Creator arguments
+ * @return NULL
+ */
+static void* count_worker_thread(void* thread_args)
+{
+    create_args_t* args = (create_args_t*) thread_args;
+    unsigned long long length = 0;
 
-    time_t t;
-    srand((unsigned) time(&t));
+    for (unsigned long long i = args->start; i < args->end; ++i)
+    {
+        length += format_element(args, i, NULL);
+    }
+
+    args->length = length;
 
-    FILE *fp = fopen(filename, "w");
+    return NULL;
+}
 
-    fputc('[', fp);
-    for (int row = 0; row < rows; ++row)
+/**
+ * Creates a block as text or binary and writes it at its offset
+ *
+ * @param thread_args Creator arguments
+ * @return NULL
+ */
+static void* write_worker_thread(void* thread_args)
+{
+    create_args_t* args = (create_args_t*) thread_args;
+    char* buffer = (char*) malloc(BUFF_SIZE);
+    size_t length = 0;
+    off_t offset = args->offset;
+
+    args->error = EXIT_FAILURE;
+
+    if (buffer == NULL)
     {
-        fputc('[', fp);
+        return NULL;
+    }
 
-        for (int col = 0; col < cols; ++col)
+    for (unsigned long long i = args->start; i < args->end; ++i)
+    {
+        if (length + NUMBER_SIZE > BUFF_SIZE)
         {
-            sprintf(buffer, "%lf", random_number(min_num, max_num));
-            fputs(buffer, fp);
-            memset(buffer, 0, BUFF_SIZE);
-            if (col != cols - 1)
+            if (write_at(args->fd, buffer, length, offset))
             {
-                fputc(',', fp);
+                free(buffer);
+                return NULL;
             }
+
+            offset += length;
+            length = 0;
+        }
+
+        if (!args->binary)
+        {
+            length += format_element(args, i, buffer + length);
+            continue;
+        }
+
+        /* Both operands are exact, so this is the double of the text */
+        double number = (double) element(args, i) / SCALE;
+        memcpy(buffer + length, &number, sizeof(number));
+        length += sizeof(number);
+    }
+
+    if (write_at(args->fd, buffer, length, offset) == EXIT_SUCCESS)
+    {
+        args->error = EXIT_SUCCESS;
+    }
+
+    free(buffer);
+
+    return NULL;
+}
+
+/**
+ * Runs the worker function for every block. The main thread works on the
+ * first one
+ *
+ * @param worker Worker function
+ * @param args Creator arguments for every thread
+ * @param thread_count Number of threads
+ */
+static void run_threads(void* (*worker)(void*), create_args_t* args,
+    unsigned int thread_count)
+{
+    pthread_t threads[thread_count];
+
+    for (unsigned int i = 1; i < thread_count; ++i)
+    {
+        pthread_create(&threads[i], NULL, worker, &args[i]);
+    }
+
+    worker(&args[0]);
+
+    for (unsigned int i = 1; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/**
+ * Creates the matrix in parallel. Text is created in two passes: the
+ * threads count the length of their blocks first, so that every block can
+ * be written at its offset in the second pass. Binary blocks have a fixed
+ * size
+ *
+ * @param fd Descriptor of the file
+ * @param rows Rows of the matrix
+ * @param cols Cols of the matrix
+ * @param min Smallest element in millionths
+ * @param max Biggest element in millionths
+ * @param seed Seed of the generator
+ * @param binary 1 for a binary file, 0 for text
+ * @param thread_count Number of threads
+ * @return EXIT_SUCCESS, if successful
+ */
+static int create_matrix(int fd, unsigned int rows, unsigned int cols,
+    long long int min, long long int max, unsigned long long seed,
+    int binary, unsigned int thread_count)
+{
+    unsigned long long count = (unsigned long long) rows * cols;
+    create_args_t args[thread_count];
+
+    if (binary)
+    {
+        matrix_file_header_t header = {0};
+        memcpy(header.magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE);
+        header.dtype = MATRIX_DTYPE_DOUBLE;
+        header.element_size = sizeof(double);
+        header.rows = rows;
+        header.cols = cols;
+
+        if (write_at(fd, (const char*) &header, sizeof(header), 0))
+        {
+            return EXIT_FAILURE;
         }
+    }
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        args[i].start = count * i / thread_count;
+        args[i].end = count * (i + 1) / thread_count;
+        args[i].rows = rows;
+        args[i].cols = cols;
+        args[i].seed = seed;
+        args[i].min = min;
+        args[i].range = (unsigned long long) (max - min) + 1;
+        args[i].binary = binary;
+        args[i].fd = fd;
+        args[i].offset = sizeof(matrix_file_header_t)
+            + args[i].start * sizeof(double);
+    }
 
-        fputc(']', fp);
-        if (row != rows - 1)
+    if (!binary)
+    {
+        run_threads(count_worker_thread, args, thread_count);
+        args[0].offset = 0;
+
+        for (unsigned int i = 1; i < thread_count; ++i)
         {
-            fputc(',', fp);
+            args[i].offset = args[i - 1].offset + args[i - 1].length;
         }
     }
 
-    fputs("]\n", fp);
-    fclose(fp);
+    run_threads(write_worker_thread, args, thread_count);
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        if (args[i].error)
+        {
+            return EXIT_FAILURE;
+        }
+    }
 
     return EXIT_SUCCESS;
 }
+
+/**
+ * Reads parameters from argv and creates a matrix file. With --binary, a
+ * binary matrix file is created, which the programs map instead of
+ * parsing it. The same --seed always creates the same elements,
+ * independent of --threads
+ *
+ * @param argc Argument count
+ * @param argv Argument strings
+ * @return EXIT_SUCCESS, if successful
+ */
+int main(int argc, char *argv[])
+{
+    int binary = 0;
+    unsigned long long seed;
+    int seeded = 0;
+    long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int arg = 1;
+
+    /* Options come before the rows */
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0)
+    {
+        if (strcmp(argv[arg], "--binary") == 0)
+        {
+            binary = 1;
+            ++arg;
+        }
+        else if (strcmp(argv[arg], "--seed") == 0 && arg + 1 < argc)
+        {
+            seed = strtoull(argv[arg + 1], NULL, 0);
+            seeded = 1;
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc)
+        {
+            thread_count = atol(argv[arg + 1]);
+
+            if (thread_count <= 0)
+            {
+                printf("Invalid thread count. Use at least 1!\n");
+                return EXIT_FAILURE;
+            }
+
+            arg += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (argc - arg != 5)
+    {
+        printf("Usage: %s [--binary] [--seed S] [--threads N] "
+            "rows cols min_num max_num filename\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const int rows = atoi(argv[arg]);
+    const int cols = atoi(argv[arg + 1]);
+    const double min_value = atof(argv[arg + 2]);
+    const double max_value = atof(argv[arg + 3]);
+    const char* filename = argv[arg + 4];
+
+    if (rows <= 0 || cols <= 0)
+    {
+        printf("Invalid rows or cols. Use at least 1!\n");
+        return EXIT_FAILURE;
+    }
+
+    if (min_value > max_value)
+    {
+        printf("Invalid range. Use min_num <= max_num!\n");
+        return EXIT_FAILURE;
+    }
+
+    /* The millionths of the numbers and of the range must fit a long long */
+    if (!(fabs(min_value) <= MAX_NUM && fabs(max_value) <= MAX_NUM
+        && max_value - min_value <= MAX_NUM))
+    {
+        printf("Invalid range. Use numbers and a range up to %g!\n",
+            MAX_NUM);
+        return EXIT_FAILURE;
+    }
+
+    const long long int min_num = llround(min_value * SCALE);
+    const long long int max_num = llround(max_value * SCALE);
+
+    if (!seeded && getrandom(&seed, sizeof(seed), 0) != sizeof(seed))
+    {
+        printf("Could not create a seed!\n");
+        return EXIT_FAILURE;
+    }
+
+    if ((unsigned long long) thread_count > (unsigned long long) rows * cols)
+    {
+        thread_count = rows * cols;
+    }
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        printf("Could not open %s!\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    int result = create_matrix(fd, rows, cols, min_num, max_num, seed,
+        binary, thread_count);
+
+    if (close(fd) != 0)
+    {
+        result = EXIT_FAILURE;
+    }
+
+    if (result != EXIT_SUCCESS)
+    {
+        printf("Could not write %s!\n", filename);
+    }
+
+    return result;
+}
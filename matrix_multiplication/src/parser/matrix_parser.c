@@ -0,0 +1,1261 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+
+#include "matrix_parser.h"
+
+/* Defines for converting doubles */
+#define MATRIX_SMALLEST_POWER (-342) ///< Smaller powers of ten give 0
+#define MATRIX_LARGEST_POWER  308    ///< Larger powers of ten give inf
+#define MATRIX_MAX_DIGITS     19     ///< Digits, which always fit 64 bits
+#define MATRIX_MAX_EXPONENT   0x10000 ///< Exponents are clamped to this
+
+/**
+ * Powers of ten, which are exactly representable as double
+ */
+static const double matrix_exact_powers[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * 128 bit significands of the powers 5^q for q = -342, ..., 308, normalized
+ * to [2^127, 2^128). Positive powers are truncated, negative ones rounded
+ * up, as required by the Eisel-Lemire algorithm
+ */
+static const uint64_t matrix_powers_of_five[][2] =
+{
+    { 0xeef453d6923bd65aUL, 0x113faa2906a13b3fUL },
+    { 0x9558b4661b6565f8UL, 0x4ac7ca59a424c507UL },
+    { 0xbaaee17fa23ebf76UL, 0x5d79bcf00d2df649UL },
+    { 0xe95a99df8ace6f53UL, 0xf4d82c2c107973dcUL },
+    { 0x91d8a02bb6c10594UL, 0x79071b9b8a4be869UL },
+    { 0xb64ec836a47146f9UL, 0x9748e2826cdee284UL },
+    { 0xe3e27a444d8d98b7UL, 0xfd1b1b2308169b25UL },
+    { 0x8e6d8c6ab0787f72UL, 0xfe30f0f5e50e20f7UL },
+    { 0xb208ef855c969f4fUL, 0xbdbd2d335e51a935UL },
+    { 0xde8b2b66b3bc4723UL, 0xad2c788035e61382UL },
+    { 0x8b16fb203055ac76UL, 0x4c3bcb5021afcc31UL },
+    { 0xaddcb9e83c6b1793UL, 0xdf4abe242a1bbf3dUL },
+    { 0xd953e8624b85dd78UL, 0xd71d6dad34a2af0dUL },
+    { 0x87d4713d6f33aa6bUL, 0x8672648c40e5ad68UL },
+    { 0xa9c98d8ccb009506UL, 0x680efdaf511f18c2UL },
+    { 0xd43bf0effdc0ba48UL, 0x0212bd1b2566def2UL },
+    { 0x84a57695fe98746dUL, 0x014bb630f7604b57UL },
+    { 0xa5ced43b7e3e9188UL, 0x419ea3bd35385e2dUL },
+    { 0xcf42894a5dce35eaUL, 0x52064cac828675b9UL },
+    { 0x818995ce7aa0e1b2UL, 0x7343efebd1940993UL },
+    { 0xa1ebfb4219491a1fUL, 0x1014ebe6c5f90bf8UL },
+    { 0xca66fa129f9b60a6UL, 0xd41a26e077774ef6UL },
+    { 0xfd00b897478238d0UL, 0x8920b098955522b4UL },
+    { 0x9e20735e8cb16382UL, 0x55b46e5f5d5535b0UL },
+    { 0xc5a890362fddbc62UL, 0xeb2189f734aa831dUL },
+    { 0xf712b443bbd52b7bUL, 0xa5e9ec7501d523e4UL },
+    { 0x9a6bb0aa55653b2dUL, 0x47b233c92125366eUL },
+    { 0xc1069cd4eabe89f8UL, 0x999ec0bb696e840aUL },
+    { 0xf148440a256e2c76UL, 0xc00670ea43ca250dUL },
+    { 0x96cd2a865764dbcaUL, 0x380406926a5e5728UL },
+    { 0xbc807527ed3e12bcUL, 0xc605083704f5ecf2UL },
+    { 0xeba09271e88d976bUL, 0xf7864a44c633682eUL },
+    { 0x93445b8731587ea3UL, 0x7ab3ee6afbe0211dUL },
+    { 0xb8157268fdae9e4cUL, 0x5960ea05bad82964UL },
+    { 0xe61acf033d1a45dfUL, 0x6fb92487298e33bdUL },
+    { 0x8fd0c16206306babUL, 0xa5d3b6d479f8e056UL },
+    { 0xb3c4f1ba87bc8696UL, 0x8f48a4899877186cUL },
+    { 0xe0b62e2929aba83cUL, 0x331acdabfe94de87UL },
+    { 0x8c71dcd9ba0b4925UL, 0x9ff0c08b7f1d0b14UL },
+    { 0xaf8e5410288e1b6fUL, 0x07ecf0ae5ee44dd9UL },
+    { 0xdb71e91432b1a24aUL, 0xc9e82cd9f69d6150UL },
+    { 0x892731ac9faf056eUL, 0xbe311c083a225cd2UL },
+    { 0xab70fe17c79ac6caUL, 0x6dbd630a48aaf406UL },
+    { 0xd64d3d9db981787dUL, 0x092cbbccdad5b108UL },
+    { 0x85f0468293f0eb4eUL, 0x25bbf56008c58ea5UL },
+    { 0xa76c582338ed2621UL, 0xaf2af2b80af6f24eUL },
+    { 0xd1476e2c07286faaUL, 0x1af5af660db4aee1UL },
+    { 0x82cca4db847945caUL, 0x50d98d9fc890ed4dUL },
+    { 0xa37fce126597973cUL, 0xe50ff107bab528a0UL },
+    { 0xcc5fc196fefd7d0cUL, 0x1e53ed49a96272c8UL },
+    { 0xff77b1fcbebcdc4fUL, 0x25e8e89c13bb0f7aUL },
+    { 0x9faacf3df73609b1UL, 0x77b191618c54e9acUL },
+    { 0xc795830d75038c1dUL, 0xd59df5b9ef6a2417UL },
+    { 0xf97ae3d0d2446f25UL, 0x4b0573286b44ad1dUL },
+    { 0x9becce62836ac577UL, 0x4ee367f9430aec32UL },
+    { 0xc2e801fb244576d5UL, 0x229c41f793cda73fUL },
+    { 0xf3a20279ed56d48aUL, 0x6b43527578c1110fUL },
+    { 0x9845418c345644d6UL, 0x830a13896b78aaa9UL },
+    { 0xbe5691ef416bd60cUL, 0x23cc986bc656d553UL },
+    { 0xedec366b11c6cb8fUL, 0x2cbfbe86b7ec8aa8UL },
+    { 0x94b3a202eb1c3f39UL, 0x7bf7d71432f3d6a9UL },
+    { 0xb9e08a83a5e34f07UL, 0xdaf5ccd93fb0cc53UL },
+    { 0xe858ad248f5c22c9UL, 0xd1b3400f8f9cff68UL },
+    { 0x91376c36d99995beUL, 0x23100809b9c21fa1UL },
+    { 0xb58547448ffffb2dUL, 0xabd40a0c2832a78aUL },
+    { 0xe2e69915b3fff9f9UL, 0x16c90c8f323f516cUL },
+    { 0x8dd01fad907ffc3bUL, 0xae3da7d97f6792e3UL },
+    { 0xb1442798f49ffb4aUL, 0x99cd11cfdf41779cUL },
+    { 0xdd95317f31c7fa1dUL, 0x40405643d711d583UL },
+    { 0x8a7d3eef7f1cfc52UL, 0x482835ea666b2572UL },
+    { 0xad1c8eab5ee43b66UL, 0xda3243650005eecfUL },
+    { 0xd863b256369d4a40UL, 0x90bed43e40076a82UL },
+    { 0x873e4f75e2224e68UL, 0x5a7744a6e804a291UL },
+    { 0xa90de3535aaae202UL, 0x711515d0a205cb36UL },
+    { 0xd3515c2831559a83UL, 0x0d5a5b44ca873e03UL },
+    { 0x8412d9991ed58091UL, 0xe858790afe9486c2UL },
+    { 0xa5178fff668ae0b6UL, 0x626e974dbe39a872UL },
+    { 0xce5d73ff402d98e3UL, 0xfb0a3d212dc8128fUL },
+    { 0x80fa687f881c7f8eUL, 0x7ce66634bc9d0b99UL },
+    { 0xa139029f6a239f72UL, 0x1c1fffc1ebc44e80UL },
+    { 0xc987434744ac874eUL, 0xa327ffb266b56220UL },
+    { 0xfbe9141915d7a922UL, 0x4bf1ff9f0062baa8UL },
+    { 0x9d71ac8fada6c9b5UL, 0x6f773fc3603db4a9UL },
+    { 0xc4ce17b399107c22UL, 0xcb550fb4384d21d3UL },
+    { 0xf6019da07f549b2bUL, 0x7e2a53a146606a48UL },
+    { 0x99c102844f94e0fbUL, 0x2eda7444cbfc426dUL },
+    { 0xc0314325637a1939UL, 0xfa911155fefb5308UL },
+    { 0xf03d93eebc589f88UL, 0x793555ab7eba27caUL },
+    { 0x96267c7535b763b5UL, 0x4bc1558b2f3458deUL },
+    { 0xbbb01b9283253ca2UL, 0x9eb1aaedfb016f16UL },
+    { 0xea9c227723ee8bcbUL, 0x465e15a979c1cadcUL },
+    { 0x92a1958a7675175fUL, 0x0bfacd89ec191ec9UL },
+    { 0xb749faed14125d36UL, 0xcef980ec671f667bUL },
+    { 0xe51c79a85916f484UL, 0x82b7e12780e7401aUL },
+    { 0x8f31cc0937ae58d2UL, 0xd1b2ecb8b0908810UL },
+    { 0xb2fe3f0b8599ef07UL, 0x861fa7e6dcb4aa15UL },
+    { 0xdfbdcece67006ac9UL, 0x67a791e093e1d49aUL },
+    { 0x8bd6a141006042bdUL, 0xe0c8bb2c5c6d24e0UL },
+    { 0xaecc49914078536dUL, 0x58fae9f773886e18UL },
+    { 0xda7f5bf590966848UL, 0xaf39a475506a899eUL },
+    { 0x888f99797a5e012dUL, 0x6d8406c952429603UL },
+    { 0xaab37fd7d8f58178UL, 0xc8e5087ba6d33b83UL },
+    { 0xd5605fcdcf32e1d6UL, 0xfb1e4a9a90880a64UL },
+    { 0x855c3be0a17fcd26UL, 0x5cf2eea09a55067fUL },
+    { 0xa6b34ad8c9dfc06fUL, 0xf42faa48c0ea481eUL },
+    { 0xd0601d8efc57b08bUL, 0xf13b94daf124da26UL },
+    { 0x823c12795db6ce57UL, 0x76c53d08d6b70858UL },
+    { 0xa2cb1717b52481edUL, 0x54768c4b0c64ca6eUL },
+    { 0xcb7ddcdda26da268UL, 0xa9942f5dcf7dfd09UL },
+    { 0xfe5d54150b090b02UL, 0xd3f93b35435d7c4cUL },
+    { 0x9efa548d26e5a6e1UL, 0xc47bc5014a1a6dafUL },
+    { 0xc6b8e9b0709f109aUL, 0x359ab6419ca1091bUL },
+    { 0xf867241c8cc6d4c0UL, 0xc30163d203c94b62UL },
+    { 0x9b407691d7fc44f8UL, 0x79e0de63425dcf1dUL },
+    { 0xc21094364dfb5636UL, 0x985915fc12f542e4UL },
+    { 0xf294b943e17a2bc4UL, 0x3e6f5b7b17b2939dUL },
+    { 0x979cf3ca6cec5b5aUL, 0xa705992ceecf9c42UL },
+    { 0xbd8430bd08277231UL, 0x50c6ff782a838353UL },
+    { 0xece53cec4a314ebdUL, 0xa4f8bf5635246428UL },
+    { 0x940f4613ae5ed136UL, 0x871b7795e136be99UL },
+    { 0xb913179899f68584UL, 0x28e2557b59846e3fUL },
+    { 0xe757dd7ec07426e5UL, 0x331aeada2fe589cfUL },
+    { 0x9096ea6f3848984fUL, 0x3ff0d2c85def7621UL },
+    { 0xb4bca50b065abe63UL, 0x0fed077a756b53a9UL },
+    { 0xe1ebce4dc7f16dfbUL, 0xd3e8495912c62894UL },
+    { 0x8d3360f09cf6e4bdUL, 0x64712dd7abbbd95cUL },
+    { 0xb080392cc4349decUL, 0xbd8d794d96aacfb3UL },
+    { 0xdca04777f541c567UL, 0xecf0d7a0fc5583a0UL },
+    { 0x89e42caaf9491b60UL, 0xf41686c49db57244UL },
+    { 0xac5d37d5b79b6239UL, 0x311c2875c522ced5UL },
+    { 0xd77485cb25823ac7UL, 0x7d633293366b828bUL },
+    { 0x86a8d39ef77164bcUL, 0xae5dff9c02033197UL },
+    { 0xa8530886b54dbdebUL, 0xd9f57f830283fdfcUL },
+    { 0xd267caa862a12d66UL, 0xd072df63c324fd7bUL },
+    { 0x8380dea93da4bc60UL, 0x4247cb9e59f71e6dUL },
+    { 0xa46116538d0deb78UL, 0x52d9be85f074e608UL },
+    { 0xcd795be870516656UL, 0x67902e276c921f8bUL },
+    { 0x806bd9714632dff6UL, 0x00ba1cd8a3db53b6UL },
+    { 0xa086cfcd97bf97f3UL, 0x80e8a40eccd228a4UL },
+    { 0xc8a883c0fdaf7df0UL, 0x6122cd128006b2cdUL },
+    { 0xfad2a4b13d1b5d6cUL, 0x796b805720085f81UL },
+    { 0x9cc3a6eec6311a63UL, 0xcbe3303674053bb0UL },
+    { 0xc3f490aa77bd60fcUL, 0xbedbfc4411068a9cUL },
+    { 0xf4f1b4d515acb93bUL, 0xee92fb5515482d44UL },
+    { 0x991711052d8bf3c5UL, 0x751bdd152d4d1c4aUL },
+    { 0xbf5cd54678eef0b6UL, 0xd262d45a78a0635dUL },
+    { 0xef340a98172aace4UL, 0x86fb897116c87c34UL },
+    { 0x9580869f0e7aac0eUL, 0xd45d35e6ae3d4da0UL },
+    { 0xbae0a846d2195712UL, 0x8974836059cca109UL },
+    { 0xe998d258869facd7UL, 0x2bd1a438703fc94bUL },
+    { 0x91ff83775423cc06UL, 0x7b6306a34627ddcfUL },
+    { 0xb67f6455292cbf08UL, 0x1a3bc84c17b1d542UL },
+    { 0xe41f3d6a7377eecaUL, 0x20caba5f1d9e4a93UL },
+    { 0x8e938662882af53eUL, 0x547eb47b7282ee9cUL },
+    { 0xb23867fb2a35b28dUL, 0xe99e619a4f23aa43UL },
+    { 0xdec681f9f4c31f31UL, 0x6405fa00e2ec94d4UL },
+    { 0x8b3c113c38f9f37eUL, 0xde83bc408dd3dd04UL },
+    { 0xae0b158b4738705eUL, 0x9624ab50b148d445UL },
+    { 0xd98ddaee19068c76UL, 0x3badd624dd9b0957UL },
+    { 0x87f8a8d4cfa417c9UL, 0xe54ca5d70a80e5d6UL },
+    { 0xa9f6d30a038d1dbcUL, 0x5e9fcf4ccd211f4cUL },
+    { 0xd47487cc8470652bUL, 0x7647c3200069671fUL },
+    { 0x84c8d4dfd2c63f3bUL, 0x29ecd9f40041e073UL },
+    { 0xa5fb0a17c777cf09UL, 0xf468107100525890UL },
+    { 0xcf79cc9db955c2ccUL, 0x7182148d4066eeb4UL },
+    { 0x81ac1fe293d599bfUL, 0xc6f14cd848405530UL },
+    { 0xa21727db38cb002fUL, 0xb8ada00e5a506a7cUL },
+    { 0xca9cf1d206fdc03bUL, 0xa6d90811f0e4851cUL },
+    { 0xfd442e4688bd304aUL, 0x908f4a166d1da663UL },
+    { 0x9e4a9cec15763e2eUL, 0x9a598e4e043287feUL },
+    { 0xc5dd44271ad3cdbaUL, 0x40eff1e1853f29fdUL },
+    { 0xf7549530e188c128UL, 0xd12bee59e68ef47cUL },
+    { 0x9a94dd3e8cf578b9UL, 0x82bb74f8301958ceUL },
+    { 0xc13a148e3032d6e7UL, 0xe36a52363c1faf01UL },
+    { 0xf18899b1bc3f8ca1UL, 0xdc44e6c3cb279ac1UL },
+    { 0x96f5600f15a7b7e5UL, 0x29ab103a5ef8c0b9UL },
+    { 0xbcb2b812db11a5deUL, 0x7415d448f6b6f0e7UL },
+    { 0xebdf661791d60f56UL, 0x111b495b3464ad21UL },
+    { 0x936b9fcebb25c995UL, 0xcab10dd900beec34UL },
+    { 0xb84687c269ef3bfbUL, 0x3d5d514f40eea742UL },
+    { 0xe65829b3046b0afaUL, 0x0cb4a5a3112a5112UL },
+    { 0x8ff71a0fe2c2e6dcUL, 0x47f0e785eaba72abUL },
+    { 0xb3f4e093db73a093UL, 0x59ed216765690f56UL },
+    { 0xe0f218b8d25088b8UL, 0x306869c13ec3532cUL },
+    { 0x8c974f7383725573UL, 0x1e414218c73a13fbUL },
+    { 0xafbd2350644eeacfUL, 0xe5d1929ef90898faUL },
+    { 0xdbac6c247d62a583UL, 0xdf45f746b74abf39UL },
+    { 0x894bc396ce5da772UL, 0x6b8bba8c328eb783UL },
+    { 0xab9eb47c81f5114fUL, 0x066ea92f3f326564UL },
+    { 0xd686619ba27255a2UL, 0xc80a537b0efefebdUL },
+    { 0x8613fd0145877585UL, 0xbd06742ce95f5f36UL },
+    { 0xa798fc4196e952e7UL, 0x2c48113823b73704UL },
+    { 0xd17f3b51fca3a7a0UL, 0xf75a15862ca504c5UL },
+    { 0x82ef85133de648c4UL, 0x9a984d73dbe722fbUL },
+    { 0xa3ab66580d5fdaf5UL, 0xc13e60d0d2e0ebbaUL },
+    { 0xcc963fee10b7d1b3UL, 0x318df905079926a8UL },
+    { 0xffbbcfe994e5c61fUL, 0xfdf17746497f7052UL },
+    { 0x9fd561f1fd0f9bd3UL, 0xfeb6ea8bedefa633UL },
+    { 0xc7caba6e7c5382c8UL, 0xfe64a52ee96b8fc0UL },
+    { 0xf9bd690a1b68637bUL, 0x3dfdce7aa3c673b0UL },
+    { 0x9c1661a651213e2dUL, 0x06bea10ca65c084eUL },
+    { 0xc31bfa0fe5698db8UL, 0x486e494fcff30a62UL },
+    { 0xf3e2f893dec3f126UL, 0x5a89dba3c3efccfaUL },
+    { 0x986ddb5c6b3a76b7UL, 0xf89629465a75e01cUL },
+    { 0xbe89523386091465UL, 0xf6bbb397f1135823UL },
+    { 0xee2ba6c0678b597fUL, 0x746aa07ded582e2cUL },
+    { 0x94db483840b717efUL, 0xa8c2a44eb4571cdcUL },
+    { 0xba121a4650e4ddebUL, 0x92f34d62616ce413UL },
+    { 0xe896a0d7e51e1566UL, 0x77b020baf9c81d17UL },
+    { 0x915e2486ef32cd60UL, 0x0ace1474dc1d122eUL },
+    { 0xb5b5ada8aaff80b8UL, 0x0d819992132456baUL },
+    { 0xe3231912d5bf60e6UL, 0x10e1fff697ed6c69UL },
+    { 0x8df5efabc5979c8fUL, 0xca8d3ffa1ef463c1UL },
+    { 0xb1736b96b6fd83b3UL, 0xbd308ff8a6b17cb2UL },
+    { 0xddd0467c64bce4a0UL, 0xac7cb3f6d05ddbdeUL },
+    { 0x8aa22c0dbef60ee4UL, 0x6bcdf07a423aa96bUL },
+    { 0xad4ab7112eb3929dUL, 0x86c16c98d2c953c6UL },
+    { 0xd89d64d57a607744UL, 0xe871c7bf077ba8b7UL },
+    { 0x87625f056c7c4a8bUL, 0x11471cd764ad4972UL },
+    { 0xa93af6c6c79b5d2dUL, 0xd598e40d3dd89bcfUL },
+    { 0xd389b47879823479UL, 0x4aff1d108d4ec2c3UL },
+    { 0x843610cb4bf160cbUL, 0xcedf722a585139baUL },
+    { 0xa54394fe1eedb8feUL, 0xc2974eb4ee658828UL },
+    { 0xce947a3da6a9273eUL, 0x733d226229feea32UL },
+    { 0x811ccc668829b887UL, 0x0806357d5a3f525fUL },
+    { 0xa163ff802a3426a8UL, 0xca07c2dcb0cf26f7UL },
+    { 0xc9bcff6034c13052UL, 0xfc89b393dd02f0b5UL },
+    { 0xfc2c3f3841f17c67UL, 0xbbac2078d443ace2UL },
+    { 0x9d9ba7832936edc0UL, 0xd54b944b84aa4c0dUL },
+    { 0xc5029163f384a931UL, 0x0a9e795e65d4df11UL },
+    { 0xf64335bcf065d37dUL, 0x4d4617b5ff4a16d5UL },
+    { 0x99ea0196163fa42eUL, 0x504bced1bf8e4e45UL },
+    { 0xc06481fb9bcf8d39UL, 0xe45ec2862f71e1d6UL },
+    { 0xf07da27a82c37088UL, 0x5d767327bb4e5a4cUL },
+    { 0x964e858c91ba2655UL, 0x3a6a07f8d510f86fUL },
+    { 0xbbe226efb628afeaUL, 0x890489f70a55368bUL },
+    { 0xeadab0aba3b2dbe5UL, 0x2b45ac74ccea842eUL },
+    { 0x92c8ae6b464fc96fUL, 0x3b0b8bc90012929dUL },
+    { 0xb77ada0617e3bbcbUL, 0x09ce6ebb40173744UL },
+    { 0xe55990879ddcaabdUL, 0xcc420a6a101d0515UL },
+    { 0x8f57fa54c2a9eab6UL, 0x9fa946824a12232dUL },
+    { 0xb32df8e9f3546564UL, 0x47939822dc96abf9UL },
+    { 0xdff9772470297ebdUL, 0x59787e2b93bc56f7UL },
+    { 0x8bfbea76c619ef36UL, 0x57eb4edb3c55b65aUL },
+    { 0xaefae51477a06b03UL, 0xede622920b6b23f1UL },
+    { 0xdab99e59958885c4UL, 0xe95fab368e45ecedUL },
+    { 0x88b402f7fd75539bUL, 0x11dbcb0218ebb414UL },
+    { 0xaae103b5fcd2a881UL, 0xd652bdc29f26a119UL },
+    { 0xd59944a37c0752a2UL, 0x4be76d3346f0495fUL },
+    { 0x857fcae62d8493a5UL, 0x6f70a4400c562ddbUL },
+    { 0xa6dfbd9fb8e5b88eUL, 0xcb4ccd500f6bb952UL },
+    { 0xd097ad07a71f26b2UL, 0x7e2000a41346a7a7UL },
+    { 0x825ecc24c873782fUL, 0x8ed400668c0c28c8UL },
+    { 0xa2f67f2dfa90563bUL, 0x728900802f0f32faUL },
+    { 0xcbb41ef979346bcaUL, 0x4f2b40a03ad2ffb9UL },
+    { 0xfea126b7d78186bcUL, 0xe2f610c84987bfa8UL },
+    { 0x9f24b832e6b0f436UL, 0x0dd9ca7d2df4d7c9UL },
+    { 0xc6ede63fa05d3143UL, 0x91503d1c79720dbbUL },
+    { 0xf8a95fcf88747d94UL, 0x75a44c6397ce912aUL },
+    { 0x9b69dbe1b548ce7cUL, 0xc986afbe3ee11abaUL },
+    { 0xc24452da229b021bUL, 0xfbe85badce996168UL },
+    { 0xf2d56790ab41c2a2UL, 0xfae27299423fb9c3UL },
+    { 0x97c560ba6b0919a5UL, 0xdccd879fc967d41aUL },
+    { 0xbdb6b8e905cb600fUL, 0x5400e987bbc1c920UL },
+    { 0xed246723473e3813UL, 0x290123e9aab23b68UL },
+    { 0x9436c0760c86e30bUL, 0xf9a0b6720aaf6521UL },
+    { 0xb94470938fa89bceUL, 0xf808e40e8d5b3e69UL },
+    { 0xe7958cb87392c2c2UL, 0xb60b1d1230b20e04UL },
+    { 0x90bd77f3483bb9b9UL, 0xb1c6f22b5e6f48c2UL },
+    { 0xb4ecd5f01a4aa828UL, 0x1e38aeb6360b1af3UL },
+    { 0xe2280b6c20dd5232UL, 0x25c6da63c38de1b0UL },
+    { 0x8d590723948a535fUL, 0x579c487e5a38ad0eUL },
+    { 0xb0af48ec79ace837UL, 0x2d835a9df0c6d851UL },
+    { 0xdcdb1b2798182244UL, 0xf8e431456cf88e65UL },
+    { 0x8a08f0f8bf0f156bUL, 0x1b8e9ecb641b58ffUL },
+    { 0xac8b2d36eed2dac5UL, 0xe272467e3d222f3fUL },
+    { 0xd7adf884aa879177UL, 0x5b0ed81dcc6abb0fUL },
+    { 0x86ccbb52ea94baeaUL, 0x98e947129fc2b4e9UL },
+    { 0xa87fea27a539e9a5UL, 0x3f2398d747b36224UL },
+    { 0xd29fe4b18e88640eUL, 0x8eec7f0d19a03aadUL },
+    { 0x83a3eeeef9153e89UL, 0x1953cf68300424acUL },
+    { 0xa48ceaaab75a8e2bUL, 0x5fa8c3423c052dd7UL },
+    { 0xcdb02555653131b6UL, 0x3792f412cb06794dUL },
+    { 0x808e17555f3ebf11UL, 0xe2bbd88bbee40bd0UL },
+    { 0xa0b19d2ab70e6ed6UL, 0x5b6aceaeae9d0ec4UL },
+    { 0xc8de047564d20a8bUL, 0xf245825a5a445275UL },
+    { 0xfb158592be068d2eUL, 0xeed6e2f0f0d56712UL },
+    { 0x9ced737bb6c4183dUL, 0x55464dd69685606bUL },
+    { 0xc428d05aa4751e4cUL, 0xaa97e14c3c26b886UL },
+    { 0xf53304714d9265dfUL, 0xd53dd99f4b3066a8UL },
+    { 0x993fe2c6d07b7fabUL, 0xe546a8038efe4029UL },
+    { 0xbf8fdb78849a5f96UL, 0xde98520472bdd033UL },
+    { 0xef73d256a5c0f77cUL, 0x963e66858f6d4440UL },
+    { 0x95a8637627989aadUL, 0xdde7001379a44aa8UL },
+    { 0xbb127c53b17ec159UL, 0x5560c018580d5d52UL },
+    { 0xe9d71b689dde71afUL, 0xaab8f01e6e10b4a6UL },
+    { 0x9226712162ab070dUL, 0xcab3961304ca70e8UL },
+    { 0xb6b00d69bb55c8d1UL, 0x3d607b97c5fd0d22UL },
+    { 0xe45c10c42a2b3b05UL, 0x8cb89a7db77c506aUL },
+    { 0x8eb98a7a9a5b04e3UL, 0x77f3608e92adb242UL },
+    { 0xb267ed1940f1c61cUL, 0x55f038b237591ed3UL },
+    { 0xdf01e85f912e37a3UL, 0x6b6c46dec52f6688UL },
+    { 0x8b61313bbabce2c6UL, 0x2323ac4b3b3da015UL },
+    { 0xae397d8aa96c1b77UL, 0xabec975e0a0d081aUL },
+    { 0xd9c7dced53c72255UL, 0x96e7bd358c904a21UL },
+    { 0x881cea14545c7575UL, 0x7e50d64177da2e54UL },
+    { 0xaa242499697392d2UL, 0xdde50bd1d5d0b9e9UL },
+    { 0xd4ad2dbfc3d07787UL, 0x955e4ec64b44e864UL },
+    { 0x84ec3c97da624ab4UL, 0xbd5af13bef0b113eUL },
+    { 0xa6274bbdd0fadd61UL, 0xecb1ad8aeacdd58eUL },
+    { 0xcfb11ead453994baUL, 0x67de18eda5814af2UL },
+    { 0x81ceb32c4b43fcf4UL, 0x80eacf948770ced7UL },
+    { 0xa2425ff75e14fc31UL, 0xa1258379a94d028dUL },
+    { 0xcad2f7f5359a3b3eUL, 0x096ee45813a04330UL },
+    { 0xfd87b5f28300ca0dUL, 0x8bca9d6e188853fcUL },
+    { 0x9e74d1b791e07e48UL, 0x775ea264cf55347eUL },
+    { 0xc612062576589ddaUL, 0x95364afe032a819eUL },
+    { 0xf79687aed3eec551UL, 0x3a83ddbd83f52205UL },
+    { 0x9abe14cd44753b52UL, 0xc4926a9672793543UL },
+    { 0xc16d9a0095928a27UL, 0x75b7053c0f178294UL },
+    { 0xf1c90080baf72cb1UL, 0x5324c68b12dd6339UL },
+    { 0x971da05074da7beeUL, 0xd3f6fc16ebca5e04UL },
+    { 0xbce5086492111aeaUL, 0x88f4bb1ca6bcf585UL },
+    { 0xec1e4a7db69561a5UL, 0x2b31e9e3d06c32e6UL },
+    { 0x9392ee8e921d5d07UL, 0x3aff322e62439fd0UL },
+    { 0xb877aa3236a4b449UL, 0x09befeb9fad487c3UL },
+    { 0xe69594bec44de15bUL, 0x4c2ebe687989a9b4UL },
+    { 0x901d7cf73ab0acd9UL, 0x0f9d37014bf60a11UL },
+    { 0xb424dc35095cd80fUL, 0x538484c19ef38c95UL },
+    { 0xe12e13424bb40e13UL, 0x2865a5f206b06fbaUL },
+    { 0x8cbccc096f5088cbUL, 0xf93f87b7442e45d4UL },
+    { 0xafebff0bcb24aafeUL, 0xf78f69a51539d749UL },
+    { 0xdbe6fecebdedd5beUL, 0xb573440e5a884d1cUL },
+    { 0x89705f4136b4a597UL, 0x31680a88f8953031UL },
+    { 0xabcc77118461cefcUL, 0xfdc20d2b36ba7c3eUL },
+    { 0xd6bf94d5e57a42bcUL, 0x3d32907604691b4dUL },
+    { 0x8637bd05af6c69b5UL, 0xa63f9a49c2c1b110UL },
+    { 0xa7c5ac471b478423UL, 0x0fcf80dc33721d54UL },
+    { 0xd1b71758e219652bUL, 0xd3c36113404ea4a9UL },
+    { 0x83126e978d4fdf3bUL, 0x645a1cac083126eaUL },
+    { 0xa3d70a3d70a3d70aUL, 0x3d70a3d70a3d70a4UL },
+    { 0xccccccccccccccccUL, 0xcccccccccccccccdUL },
+    { 0x8000000000000000UL, 0x0000000000000000UL },
+    { 0xa000000000000000UL, 0x0000000000000000UL },
+    { 0xc800000000000000UL, 0x0000000000000000UL },
+    { 0xfa00000000000000UL, 0x0000000000000000UL },
+    { 0x9c40000000000000UL, 0x0000000000000000UL },
+    { 0xc350000000000000UL, 0x0000000000000000UL },
+    { 0xf424000000000000UL, 0x0000000000000000UL },
+    { 0x9896800000000000UL, 0x0000000000000000UL },
+    { 0xbebc200000000000UL, 0x0000000000000000UL },
+    { 0xee6b280000000000UL, 0x0000000000000000UL },
+    { 0x9502f90000000000UL, 0x0000000000000000UL },
+    { 0xba43b74000000000UL, 0x0000000000000000UL },
+    { 0xe8d4a51000000000UL, 0x0000000000000000UL },
+    { 0x9184e72a00000000UL, 0x0000000000000000UL },
+    { 0xb5e620f480000000UL, 0x0000000000000000UL },
+    { 0xe35fa931a0000000UL, 0x0000000000000000UL },
+    { 0x8e1bc9bf04000000UL, 0x0000000000000000UL },
+    { 0xb1a2bc2ec5000000UL, 0x0000000000000000UL },
+    { 0xde0b6b3a76400000UL, 0x0000000000000000UL },
+    { 0x8ac7230489e80000UL, 0x0000000000000000UL },
+    { 0xad78ebc5ac620000UL, 0x0000000000000000UL },
+    { 0xd8d726b7177a8000UL, 0x0000000000000000UL },
+    { 0x878678326eac9000UL, 0x0000000000000000UL },
+    { 0xa968163f0a57b400UL, 0x0000000000000000UL },
+    { 0xd3c21bcecceda100UL, 0x0000000000000000UL },
+    { 0x84595161401484a0UL, 0x0000000000000000UL },
+    { 0xa56fa5b99019a5c8UL, 0x0000000000000000UL },
+    { 0xcecb8f27f4200f3aUL, 0x0000000000000000UL },
+    { 0x813f3978f8940984UL, 0x4000000000000000UL },
+    { 0xa18f07d736b90be5UL, 0x5000000000000000UL },
+    { 0xc9f2c9cd04674edeUL, 0xa400000000000000UL },
+    { 0xfc6f7c4045812296UL, 0x4d00000000000000UL },
+    { 0x9dc5ada82b70b59dUL, 0xf020000000000000UL },
+    { 0xc5371912364ce305UL, 0x6c28000000000000UL },
+    { 0xf684df56c3e01bc6UL, 0xc732000000000000UL },
+    { 0x9a130b963a6c115cUL, 0x3c7f400000000000UL },
+    { 0xc097ce7bc90715b3UL, 0x4b9f100000000000UL },
+    { 0xf0bdc21abb48db20UL, 0x1e86d40000000000UL },
+    { 0x96769950b50d88f4UL, 0x1314448000000000UL },
+    { 0xbc143fa4e250eb31UL, 0x17d955a000000000UL },
+    { 0xeb194f8e1ae525fdUL, 0x5dcfab0800000000UL },
+    { 0x92efd1b8d0cf37beUL, 0x5aa1cae500000000UL },
+    { 0xb7abc627050305adUL, 0xf14a3d9e40000000UL },
+    { 0xe596b7b0c643c719UL, 0x6d9ccd05d0000000UL },
+    { 0x8f7e32ce7bea5c6fUL, 0xe4820023a2000000UL },
+    { 0xb35dbf821ae4f38bUL, 0xdda2802c8a800000UL },
+    { 0xe0352f62a19e306eUL, 0xd50b2037ad200000UL },
+    { 0x8c213d9da502de45UL, 0x4526f422cc340000UL },
+    { 0xaf298d050e4395d6UL, 0x9670b12b7f410000UL },
+    { 0xdaf3f04651d47b4cUL, 0x3c0cdd765f114000UL },
+    { 0x88d8762bf324cd0fUL, 0xa5880a69fb6ac800UL },
+    { 0xab0e93b6efee0053UL, 0x8eea0d047a457a00UL },
+    { 0xd5d238a4abe98068UL, 0x72a4904598d6d880UL },
+    { 0x85a36366eb71f041UL, 0x47a6da2b7f864750UL },
+    { 0xa70c3c40a64e6c51UL, 0x999090b65f67d924UL },
+    { 0xd0cf4b50cfe20765UL, 0xfff4b4e3f741cf6dUL },
+    { 0x82818f1281ed449fUL, 0xbff8f10e7a8921a4UL },
+    { 0xa321f2d7226895c7UL, 0xaff72d52192b6a0dUL },
+    { 0xcbea6f8ceb02bb39UL, 0x9bf4f8a69f764490UL },
+    { 0xfee50b7025c36a08UL, 0x02f236d04753d5b4UL },
+    { 0x9f4f2726179a2245UL, 0x01d762422c946590UL },
+    { 0xc722f0ef9d80aad6UL, 0x424d3ad2b7b97ef5UL },
+    { 0xf8ebad2b84e0d58bUL, 0xd2e0898765a7deb2UL },
+    { 0x9b934c3b330c8577UL, 0x63cc55f49f88eb2fUL },
+    { 0xc2781f49ffcfa6d5UL, 0x3cbf6b71c76b25fbUL },
+    { 0xf316271c7fc3908aUL, 0x8bef464e3945ef7aUL },
+    { 0x97edd871cfda3a56UL, 0x97758bf0e3cbb5acUL },
+    { 0xbde94e8e43d0c8ecUL, 0x3d52eeed1cbea317UL },
+    { 0xed63a231d4c4fb27UL, 0x4ca7aaa863ee4bddUL },
+    { 0x945e455f24fb1cf8UL, 0x8fe8caa93e74ef6aUL },
+    { 0xb975d6b6ee39e436UL, 0xb3e2fd538e122b44UL },
+    { 0xe7d34c64a9c85d44UL, 0x60dbbca87196b616UL },
+    { 0x90e40fbeea1d3a4aUL, 0xbc8955e946fe31cdUL },
+    { 0xb51d13aea4a488ddUL, 0x6babab6398bdbe41UL },
+    { 0xe264589a4dcdab14UL, 0xc696963c7eed2dd1UL },
+    { 0x8d7eb76070a08aecUL, 0xfc1e1de5cf543ca2UL },
+    { 0xb0de65388cc8ada8UL, 0x3b25a55f43294bcbUL },
+    { 0xdd15fe86affad912UL, 0x49ef0eb713f39ebeUL },
+    { 0x8a2dbf142dfcc7abUL, 0x6e3569326c784337UL },
+    { 0xacb92ed9397bf996UL, 0x49c2c37f07965404UL },
+    { 0xd7e77a8f87daf7fbUL, 0xdc33745ec97be906UL },
+    { 0x86f0ac99b4e8dafdUL, 0x69a028bb3ded71a3UL },
+    { 0xa8acd7c0222311bcUL, 0xc40832ea0d68ce0cUL },
+    { 0xd2d80db02aabd62bUL, 0xf50a3fa490c30190UL },
+    { 0x83c7088e1aab65dbUL, 0x792667c6da79e0faUL },
+    { 0xa4b8cab1a1563f52UL, 0x577001b891185938UL },
+    { 0xcde6fd5e09abcf26UL, 0xed4c0226b55e6f86UL },
+    { 0x80b05e5ac60b6178UL, 0x544f8158315b05b4UL },
+    { 0xa0dc75f1778e39d6UL, 0x696361ae3db1c721UL },
+    { 0xc913936dd571c84cUL, 0x03bc3a19cd1e38e9UL },
+    { 0xfb5878494ace3a5fUL, 0x04ab48a04065c723UL },
+    { 0x9d174b2dcec0e47bUL, 0x62eb0d64283f9c76UL },
+    { 0xc45d1df942711d9aUL, 0x3ba5d0bd324f8394UL },
+    { 0xf5746577930d6500UL, 0xca8f44ec7ee36479UL },
+    { 0x9968bf6abbe85f20UL, 0x7e998b13cf4e1ecbUL },
+    { 0xbfc2ef456ae276e8UL, 0x9e3fedd8c321a67eUL },
+    { 0xefb3ab16c59b14a2UL, 0xc5cfe94ef3ea101eUL },
+    { 0x95d04aee3b80ece5UL, 0xbba1f1d158724a12UL },
+    { 0xbb445da9ca61281fUL, 0x2a8a6e45ae8edc97UL },
+    { 0xea1575143cf97226UL, 0xf52d09d71a3293bdUL },
+    { 0x924d692ca61be758UL, 0x593c2626705f9c56UL },
+    { 0xb6e0c377cfa2e12eUL, 0x6f8b2fb00c77836cUL },
+    { 0xe498f455c38b997aUL, 0x0b6dfb9c0f956447UL },
+    { 0x8edf98b59a373fecUL, 0x4724bd4189bd5eacUL },
+    { 0xb2977ee300c50fe7UL, 0x58edec91ec2cb657UL },
+    { 0xdf3d5e9bc0f653e1UL, 0x2f2967b66737e3edUL },
+    { 0x8b865b215899f46cUL, 0xbd79e0d20082ee74UL },
+    { 0xae67f1e9aec07187UL, 0xecd8590680a3aa11UL },
+    { 0xda01ee641a708de9UL, 0xe80e6f4820cc9495UL },
+    { 0x884134fe908658b2UL, 0x3109058d147fdcddUL },
+    { 0xaa51823e34a7eedeUL, 0xbd4b46f0599fd415UL },
+    { 0xd4e5e2cdc1d1ea96UL, 0x6c9e18ac7007c91aUL },
+    { 0x850fadc09923329eUL, 0x03e2cf6bc604ddb0UL },
+    { 0xa6539930bf6bff45UL, 0x84db8346b786151cUL },
+    { 0xcfe87f7cef46ff16UL, 0xe612641865679a63UL },
+    { 0x81f14fae158c5f6eUL, 0x4fcb7e8f3f60c07eUL },
+    { 0xa26da3999aef7749UL, 0xe3be5e330f38f09dUL },
+    { 0xcb090c8001ab551cUL, 0x5cadf5bfd3072cc5UL },
+    { 0xfdcb4fa002162a63UL, 0x73d9732fc7c8f7f6UL },
+    { 0x9e9f11c4014dda7eUL, 0x2867e7fddcdd9afaUL },
+    { 0xc646d63501a1511dUL, 0xb281e1fd541501b8UL },
+    { 0xf7d88bc24209a565UL, 0x1f225a7ca91a4226UL },
+    { 0x9ae757596946075fUL, 0x3375788de9b06958UL },
+    { 0xc1a12d2fc3978937UL, 0x0052d6b1641c83aeUL },
+    { 0xf209787bb47d6b84UL, 0xc0678c5dbd23a49aUL },
+    { 0x9745eb4d50ce6332UL, 0xf840b7ba963646e0UL },
+    { 0xbd176620a501fbffUL, 0xb650e5a93bc3d898UL },
+    { 0xec5d3fa8ce427affUL, 0xa3e51f138ab4cebeUL },
+    { 0x93ba47c980e98cdfUL, 0xc66f336c36b10137UL },
+    { 0xb8a8d9bbe123f017UL, 0xb80b0047445d4184UL },
+    { 0xe6d3102ad96cec1dUL, 0xa60dc059157491e5UL },
+    { 0x9043ea1ac7e41392UL, 0x87c89837ad68db2fUL },
+    { 0xb454e4a179dd1877UL, 0x29babe4598c311fbUL },
+    { 0xe16a1dc9d8545e94UL, 0xf4296dd6fef3d67aUL },
+    { 0x8ce2529e2734bb1dUL, 0x1899e4a65f58660cUL },
+    { 0xb01ae745b101e9e4UL, 0x5ec05dcff72e7f8fUL },
+    { 0xdc21a1171d42645dUL, 0x76707543f4fa1f73UL },
+    { 0x899504ae72497ebaUL, 0x6a06494a791c53a8UL },
+    { 0xabfa45da0edbde69UL, 0x0487db9d17636892UL },
+    { 0xd6f8d7509292d603UL, 0x45a9d2845d3c42b6UL },
+    { 0x865b86925b9bc5c2UL, 0x0b8a2392ba45a9b2UL },
+    { 0xa7f26836f282b732UL, 0x8e6cac7768d7141eUL },
+    { 0xd1ef0244af2364ffUL, 0x3207d795430cd926UL },
+    { 0x8335616aed761f1fUL, 0x7f44e6bd49e807b8UL },
+    { 0xa402b9c5a8d3a6e7UL, 0x5f16206c9c6209a6UL },
+    { 0xcd036837130890a1UL, 0x36dba887c37a8c0fUL },
+    { 0x802221226be55a64UL, 0xc2494954da2c9789UL },
+    { 0xa02aa96b06deb0fdUL, 0xf2db9baa10b7bd6cUL },
+    { 0xc83553c5c8965d3dUL, 0x6f92829494e5acc7UL },
+    { 0xfa42a8b73abbf48cUL, 0xcb772339ba1f17f9UL },
+    { 0x9c69a97284b578d7UL, 0xff2a760414536efbUL },
+    { 0xc38413cf25e2d70dUL, 0xfef5138519684abaUL },
+    { 0xf46518c2ef5b8cd1UL, 0x7eb258665fc25d69UL },
+    { 0x98bf2f79d5993802UL, 0xef2f773ffbd97a61UL },
+    { 0xbeeefb584aff8603UL, 0xaafb550ffacfd8faUL },
+    { 0xeeaaba2e5dbf6784UL, 0x95ba2a53f983cf38UL },
+    { 0x952ab45cfa97a0b2UL, 0xdd945a747bf26183UL },
+    { 0xba756174393d88dfUL, 0x94f971119aeef9e4UL },
+    { 0xe912b9d1478ceb17UL, 0x7a37cd5601aab85dUL },
+    { 0x91abb422ccb812eeUL, 0xac62e055c10ab33aUL },
+    { 0xb616a12b7fe617aaUL, 0x577b986b314d6009UL },
+    { 0xe39c49765fdf9d94UL, 0xed5a7e85fda0b80bUL },
+    { 0x8e41ade9fbebc27dUL, 0x14588f13be847307UL },
+    { 0xb1d219647ae6b31cUL, 0x596eb2d8ae258fc8UL },
+    { 0xde469fbd99a05fe3UL, 0x6fca5f8ed9aef3bbUL },
+    { 0x8aec23d680043beeUL, 0x25de7bb9480d5854UL },
+    { 0xada72ccc20054ae9UL, 0xaf561aa79a10ae6aUL },
+    { 0xd910f7ff28069da4UL, 0x1b2ba1518094da04UL },
+    { 0x87aa9aff79042286UL, 0x90fb44d2f05d0842UL },
+    { 0xa99541bf57452b28UL, 0x353a1607ac744a53UL },
+    { 0xd3fa922f2d1675f2UL, 0x42889b8997915ce8UL },
+    { 0x847c9b5d7c2e09b7UL, 0x69956135febada11UL },
+    { 0xa59bc234db398c25UL, 0x43fab9837e699095UL },
+    { 0xcf02b2c21207ef2eUL, 0x94f967e45e03f4bbUL },
+    { 0x8161afb94b44f57dUL, 0x1d1be0eebac278f5UL },
+    { 0xa1ba1ba79e1632dcUL, 0x6462d92a69731732UL },
+    { 0xca28a291859bbf93UL, 0x7d7b8f7503cfdcfeUL },
+    { 0xfcb2cb35e702af78UL, 0x5cda735244c3d43eUL },
+    { 0x9defbf01b061adabUL, 0x3a0888136afa64a7UL },
+    { 0xc56baec21c7a1916UL, 0x088aaa1845b8fdd0UL },
+    { 0xf6c69a72a3989f5bUL, 0x8aad549e57273d45UL },
+    { 0x9a3c2087a63f6399UL, 0x36ac54e2f678864bUL },
+    { 0xc0cb28a98fcf3c7fUL, 0x84576a1bb416a7ddUL },
+    { 0xf0fdf2d3f3c30b9fUL, 0x656d44a2a11c51d5UL },
+    { 0x969eb7c47859e743UL, 0x9f644ae5a4b1b325UL },
+    { 0xbc4665b596706114UL, 0x873d5d9f0dde1feeUL },
+    { 0xeb57ff22fc0c7959UL, 0xa90cb506d155a7eaUL },
+    { 0x9316ff75dd87cbd8UL, 0x09a7f12442d588f2UL },
+    { 0xb7dcbf5354e9beceUL, 0x0c11ed6d538aeb2fUL },
+    { 0xe5d3ef282a242e81UL, 0x8f1668c8a86da5faUL },
+    { 0x8fa475791a569d10UL, 0xf96e017d694487bcUL },
+    { 0xb38d92d760ec4455UL, 0x37c981dcc395a9acUL },
+    { 0xe070f78d3927556aUL, 0x85bbe253f47b1417UL },
+    { 0x8c469ab843b89562UL, 0x93956d7478ccec8eUL },
+    { 0xaf58416654a6babbUL, 0x387ac8d1970027b2UL },
+    { 0xdb2e51bfe9d0696aUL, 0x06997b05fcc0319eUL },
+    { 0x88fcf317f22241e2UL, 0x441fece3bdf81f03UL },
+    { 0xab3c2fddeeaad25aUL, 0xd527e81cad7626c3UL },
+    { 0xd60b3bd56a5586f1UL, 0x8a71e223d8d3b074UL },
+    { 0x85c7056562757456UL, 0xf6872d5667844e49UL },
+    { 0xa738c6bebb12d16cUL, 0xb428f8ac016561dbUL },
+    { 0xd106f86e69d785c7UL, 0xe13336d701beba52UL },
+    { 0x82a45b450226b39cUL, 0xecc0024661173473UL },
+    { 0xa34d721642b06084UL, 0x27f002d7f95d0190UL },
+    { 0xcc20ce9bd35c78a5UL, 0x31ec038df7b441f4UL },
+    { 0xff290242c83396ceUL, 0x7e67047175a15271UL },
+    { 0x9f79a169bd203e41UL, 0x0f0062c6e984d386UL },
+    { 0xc75809c42c684dd1UL, 0x52c07b78a3e60868UL },
+    { 0xf92e0c3537826145UL, 0xa7709a56ccdf8a82UL },
+    { 0x9bbcc7a142b17ccbUL, 0x88a66076400bb691UL },
+    { 0xc2abf989935ddbfeUL, 0x6acff893d00ea435UL },
+    { 0xf356f7ebf83552feUL, 0x0583f6b8c4124d43UL },
+    { 0x98165af37b2153deUL, 0xc3727a337a8b704aUL },
+    { 0xbe1bf1b059e9a8d6UL, 0x744f18c0592e4c5cUL },
+    { 0xeda2ee1c7064130cUL, 0x1162def06f79df73UL },
+    { 0x9485d4d1c63e8be7UL, 0x8addcb5645ac2ba8UL },
+    { 0xb9a74a0637ce2ee1UL, 0x6d953e2bd7173692UL },
+    { 0xe8111c87c5c1ba99UL, 0xc8fa8db6ccdd0437UL },
+    { 0x910ab1d4db9914a0UL, 0x1d9c9892400a22a2UL },
+    { 0xb54d5e4a127f59c8UL, 0x2503beb6d00cab4bUL },
+    { 0xe2a0b5dc971f303aUL, 0x2e44ae64840fd61dUL },
+    { 0x8da471a9de737e24UL, 0x5ceaecfed289e5d2UL },
+    { 0xb10d8e1456105dadUL, 0x7425a83e872c5f47UL },
+    { 0xdd50f1996b947518UL, 0xd12f124e28f77719UL },
+    { 0x8a5296ffe33cc92fUL, 0x82bd6b70d99aaa6fUL },
+    { 0xace73cbfdc0bfb7bUL, 0x636cc64d1001550bUL },
+    { 0xd8210befd30efa5aUL, 0x3c47f7e05401aa4eUL },
+    { 0x8714a775e3e95c78UL, 0x65acfaec34810a71UL },
+    { 0xa8d9d1535ce3b396UL, 0x7f1839a741a14d0dUL },
+    { 0xd31045a8341ca07cUL, 0x1ede48111209a050UL },
+    { 0x83ea2b892091e44dUL, 0x934aed0aab460432UL },
+    { 0xa4e4b66b68b65d60UL, 0xf81da84d5617853fUL },
+    { 0xce1de40642e3f4b9UL, 0x36251260ab9d668eUL },
+    { 0x80d2ae83e9ce78f3UL, 0xc1d72b7c6b426019UL },
+    { 0xa1075a24e4421730UL, 0xb24cf65b8612f81fUL },
+    { 0xc94930ae1d529cfcUL, 0xdee033f26797b627UL },
+    { 0xfb9b7cd9a4a7443cUL, 0x169840ef017da3b1UL },
+    { 0x9d412e0806e88aa5UL, 0x8e1f289560ee864eUL },
+    { 0xc491798a08a2ad4eUL, 0xf1a6f2bab92a27e2UL },
+    { 0xf5b5d7ec8acb58a2UL, 0xae10af696774b1dbUL },
+    { 0x9991a6f3d6bf1765UL, 0xacca6da1e0a8ef29UL },
+    { 0xbff610b0cc6edd3fUL, 0x17fd090a58d32af3UL },
+    { 0xeff394dcff8a948eUL, 0xddfc4b4cef07f5b0UL },
+    { 0x95f83d0a1fb69cd9UL, 0x4abdaf101564f98eUL },
+    { 0xbb764c4ca7a4440fUL, 0x9d6d1ad41abe37f1UL },
+    { 0xea53df5fd18d5513UL, 0x84c86189216dc5edUL },
+    { 0x92746b9be2f8552cUL, 0x32fd3cf5b4e49bb4UL },
+    { 0xb7118682dbb66a77UL, 0x3fbc8c33221dc2a1UL },
+    { 0xe4d5e82392a40515UL, 0x0fabaf3feaa5334aUL },
+    { 0x8f05b1163ba6832dUL, 0x29cb4d87f2a7400eUL },
+    { 0xb2c71d5bca9023f8UL, 0x743e20e9ef511012UL },
+    { 0xdf78e4b2bd342cf6UL, 0x914da9246b255416UL },
+    { 0x8bab8eefb6409c1aUL, 0x1ad089b6c2f7548eUL },
+    { 0xae9672aba3d0c320UL, 0xa184ac2473b529b1UL },
+    { 0xda3c0f568cc4f3e8UL, 0xc9e5d72d90a2741eUL },
+    { 0x8865899617fb1871UL, 0x7e2fa67c7a658892UL },
+    { 0xaa7eebfb9df9de8dUL, 0xddbb901b98feeab7UL },
+    { 0xd51ea6fa85785631UL, 0x552a74227f3ea565UL },
+    { 0x8533285c936b35deUL, 0xd53a88958f87275fUL },
+    { 0xa67ff273b8460356UL, 0x8a892abaf368f137UL },
+    { 0xd01fef10a657842cUL, 0x2d2b7569b0432d85UL },
+    { 0x8213f56a67f6b29bUL, 0x9c3b29620e29fc73UL },
+    { 0xa298f2c501f45f42UL, 0x8349f3ba91b47b8fUL },
+    { 0xcb3f2f7642717713UL, 0x241c70a936219a73UL },
+    { 0xfe0efb53d30dd4d7UL, 0xed238cd383aa0110UL },
+    { 0x9ec95d1463e8a506UL, 0xf4363804324a40aaUL },
+    { 0xc67bb4597ce2ce48UL, 0xb143c6053edcd0d5UL },
+    { 0xf81aa16fdc1b81daUL, 0xdd94b7868e94050aUL },
+    { 0x9b10a4e5e9913128UL, 0xca7cf2b4191c8326UL },
+    { 0xc1d4ce1f63f57d72UL, 0xfd1c2f611f63a3f0UL },
+    { 0xf24a01a73cf2dccfUL, 0xbc633b39673c8cecUL },
+    { 0x976e41088617ca01UL, 0xd5be0503e085d813UL },
+    { 0xbd49d14aa79dbc82UL, 0x4b2d8644d8a74e18UL },
+    { 0xec9c459d51852ba2UL, 0xddf8e7d60ed1219eUL },
+    { 0x93e1ab8252f33b45UL, 0xcabb90e5c942b503UL },
+    { 0xb8da1662e7b00a17UL, 0x3d6a751f3b936243UL },
+    { 0xe7109bfba19c0c9dUL, 0x0cc512670a783ad4UL },
+    { 0x906a617d450187e2UL, 0x27fb2b80668b24c5UL },
+    { 0xb484f9dc9641e9daUL, 0xb1f9f660802dedf6UL },
+    { 0xe1a63853bbd26451UL, 0x5e7873f8a0396973UL },
+    { 0x8d07e33455637eb2UL, 0xdb0b487b6423e1e8UL },
+    { 0xb049dc016abc5e5fUL, 0x91ce1a9a3d2cda62UL },
+    { 0xdc5c5301c56b75f7UL, 0x7641a140cc7810fbUL },
+    { 0x89b9b3e11b6329baUL, 0xa9e904c87fcb0a9dUL },
+    { 0xac2820d9623bf429UL, 0x546345fa9fbdcd44UL },
+    { 0xd732290fbacaf133UL, 0xa97c177947ad4095UL },
+    { 0x867f59a9d4bed6c0UL, 0x49ed8eabcccc485dUL },
+    { 0xa81f301449ee8c70UL, 0x5c68f256bfff5a74UL },
+    { 0xd226fc195c6a2f8cUL, 0x73832eec6fff3111UL },
+    { 0x83585d8fd9c25db7UL, 0xc831fd53c5ff7eabUL },
+    { 0xa42e74f3d032f525UL, 0xba3e7ca8b77f5e55UL },
+    { 0xcd3a1230c43fb26fUL, 0x28ce1bd2e55f35ebUL },
+    { 0x80444b5e7aa7cf85UL, 0x7980d163cf5b81b3UL },
+    { 0xa0555e361951c366UL, 0xd7e105bcc332621fUL },
+    { 0xc86ab5c39fa63440UL, 0x8dd9472bf3fefaa7UL },
+    { 0xfa856334878fc150UL, 0xb14f98f6f0feb951UL },
+    { 0x9c935e00d4b9d8d2UL, 0x6ed1bf9a569f33d3UL },
+    { 0xc3b8358109e84f07UL, 0x0a862f80ec4700c8UL },
+    { 0xf4a642e14c6262c8UL, 0xcd27bb612758c0faUL },
+    { 0x98e7e9cccfbd7dbdUL, 0x8038d51cb897789cUL },
+    { 0xbf21e44003acdd2cUL, 0xe0470a63e6bd56c3UL },
+    { 0xeeea5d5004981478UL, 0x1858ccfce06cac74UL },
+    { 0x95527a5202df0ccbUL, 0x0f37801e0c43ebc8UL },
+    { 0xbaa718e68396cffdUL, 0xd30560258f54e6baUL },
+    { 0xe950df20247c83fdUL, 0x47c6b82ef32a2069UL },
+    { 0x91d28b7416cdd27eUL, 0x4cdc331d57fa5441UL },
+    { 0xb6472e511c81471dUL, 0xe0133fe4adf8e952UL },
+    { 0xe3d8f9e563a198e5UL, 0x58180fddd97723a6UL },
+    { 0x8e679c2f5e44ff8fUL, 0x570f09eaa7ea7648UL }
+};
+
+/**
+ * Checks whether a char is a digit
+ *
+ * @param token The char
+ * @return true, if the char is a digit
+ */
+static inline bool matrix_is_digit(char token)
+{
+    return (unsigned char) (token - '0') < 10;
+}
+
+/**
+ * Checks whether eight chars loaded into an integer are all digits
+ *
+ * @param value The chars, the first one in the lowest byte
+ * @return true, if all chars are digits
+ */
+static inline bool matrix_is_eight_digits(uint64_t value)
+{
+    return !(((value + 0x4646464646464646UL)
+        | (value - 0x3030303030303030UL)) & 0x8080808080808080UL);
+}
+
+/**
+ * Converts eight digits at once with a few multiplications (SWAR)
+ *
+ * @param value The digits, the first one in the lowest byte
+ * @return Value of the digits
+ */
+static inline uint64_t matrix_parse_eight_digits(uint64_t value)
+{
+    value -= 0x3030303030303030UL;
+    value = (value * 10) + (value >> 8);
+    value = (((value & 0x000000FF000000FFUL) * 0x000F424000000064UL)
+        + (((value >> 16) & 0x000000FF000000FFUL) * 0x0000271000000001UL))
+        >> 32;
+
+    return value;
+}
+
+/**
+ * Appends digits to a number. Eight digits are converted at once, if the
+ * CPU is little-endian
+ *
+ * @param position First char to check
+ * @param end End of the string
+ * @param number Number, to which the digits are appended
+ * @return First char after the digits
+ */
+static inline const char* matrix_parse_digits(const char* position,
+    const char* end, uint64_t* number)
+{
+    uint64_t value = *number;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t eight_digits;
+
+    while (end - position >= 8)
+    {
+        memcpy(&eight_digits, position, sizeof(eight_digits));
+
+        if (!matrix_is_eight_digits(eight_digits))
+        {
+            break;
+        }
+
+        value = value * 100000000 + matrix_parse_eight_digits(eight_digits);
+        position += 8;
+    }
+#endif
+
+    while (position < end && matrix_is_digit(*position))
+    {
+        value = value * 10 + (uint64_t) (*position - '0');
+        ++position;
+    }
+
+    *number = value;
+
+    return position;
+}
+
+/**
+ * Parses a long long int. Numbers, which don't fit, are invalid
+ *
+ * @param position First char of the number
+ * @param end End of the string
+ * @param number Resulting number
+ * @return First char after the number or NULL, if it is invalid
+ */
+static inline const char* matrix_parse_long(const char* position,
+    const char* end, long long* number)
+{
+    bool negative = *position == '-';
+
+    if (*position == '-' || *position == '+')
+    {
+        ++position;
+    }
+
+    const char* digits = position;
+
+    while (position < end && *position == '0')
+    {
+        ++position;
+    }
+
+    const char* significant = position;
+    uint64_t value = 0;
+    position = matrix_parse_digits(position, end, &value);
+
+    if (position == digits || position - significant > MATRIX_MAX_DIGITS
+        || value > (uint64_t) INT64_MAX + negative)
+    {
+        return NULL;
+    }
+
+    *number = negative ? (long long) (0 - value) : (long long) value;
+
+    return position;
+}
+
+/**
+ * Multiplies two 64 bit integers to a 128 bit integer
+ *
+ * @param a First factor
+ * @param b Second factor
+ * @param high Upper 64 bits of the product
+ * @return Lower 64 bits of the product
+ */
+static inline uint64_t matrix_multiply_128(uint64_t a, uint64_t b,
+    uint64_t* high)
+{
+    unsigned __int128 product = (unsigned __int128) a * b;
+    *high = (uint64_t) (product >> 64);
+
+    return (uint64_t) product;
+}
+
+/**
+ * Converts w * 10^q to the nearest double with the Eisel-Lemire algorithm.
+ * It fails, if the 128 bit product is too close to a rounding boundary or
+ * the result is subnormal or too large
+ *
+ * @param q Decimal exponent in [MATRIX_SMALLEST_POWER, _LARGEST_POWER]
+ * @param w Decimal significand, not 0
+ * @param negative Sign of the number
+ * @param number Resulting number
+ * @return true, if successful
+ */
+static inline bool matrix_eisel_lemire(int64_t q, uint64_t w, bool negative,
+    double* number)
+{
+    const uint64_t* power = matrix_powers_of_five[q - MATRIX_SMALLEST_POWER];
+
+    /* floor(log2(10^q)) + 1024 + 63, the exponent of the product */
+    int64_t exponent = (((152170 + 65536) * q) >> 16) + 1024 + 63;
+    int leading_zeros = __builtin_clzll(w);
+    w <<= leading_zeros;
+
+    uint64_t upper;
+    uint64_t lower = matrix_multiply_128(w, power[0], &upper);
+
+    /* The lower bits may carry into the upper ones, use the full 128 bits */
+    if ((upper & 0x1FF) == 0x1FF && lower + w < lower)
+    {
+        uint64_t middle_high;
+        uint64_t low = matrix_multiply_128(w, power[1], &middle_high);
+        uint64_t middle = lower + middle_high;
+
+        if (middle < lower)
+        {
+            ++upper;
+        }
+
+        if (middle + 1 == 0 && (upper & 0x1FF) == 0x1FF && low + w < low)
+        {
+            return false;
+        }
+
+        lower = middle;
+    }
+
+    uint64_t upper_bit = upper >> 63;
+    uint64_t mantissa = upper >> (upper_bit + 9);
+    leading_zeros += (int) (1 ^ upper_bit);
+
+    /* Exactly halfway between two doubles */
+    if (lower == 0 && (upper & 0x1FF) == 0 && (mantissa & 3) == 1)
+    {
+        return false;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+
+    if (mantissa >= (1UL << 53))
+    {
+        mantissa = 1UL << 52;
+        --leading_zeros;
+    }
+
+    mantissa &= ~(1UL << 52);
+    int64_t real_exponent = exponent - leading_zeros;
+
+    if (real_exponent < 1 || real_exponent > 2046)
+    {
+        return false;
+    }
+
+    mantissa |= (uint64_t) real_exponent << 52;
+    mantissa |= (uint64_t) negative << 63;
+    memcpy(number, &mantissa, sizeof(*number));
+
+    return true;
+}
+
+/**
+ * Converts a number with strtod, if it can't be converted exactly by the
+ * fast paths
+ *
+ * @param start First char of the number
+ * @param end First char after the number
+ * @param number Resulting number
+ * @return First char after the number or NULL, if out of memory
+ */
+static const char* matrix_parse_double_fallback(const char* start,
+    const char* end, double* number)
+{
+    size_t length = end - start;
+    char buffer[MATRIX_PARSER_MAX_TOKEN];
+    char* token = buffer;
+
+    /* The number may end the string, so it is copied to terminate it */
+    if (length >= MATRIX_PARSER_MAX_TOKEN)
+    {
+        token = (char*) malloc(length + 1);
+
+        if (token == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    memcpy(token, start, length);
+    token[length] = '\0';
+    *number = strtod(token, NULL);
+
+    if (token != buffer)
+    {
+        free(token);
+    }
+
+    return end;
+}
+
+/**
+ * Parses the special values "inf", "infinity" and "nan" in any case, which
+ * matrix_format_number writes for overflowed elements
+ *
+ * @param position First char after the sign
+ * @param end End of the string
+ * @param negative true, if the value has a '-' sign
+ * @param number Resulting number
+ * @return First char after the value or NULL, if it is no special value
+ */
+static const char* matrix_parse_special(const char* position,
+    const char* end, bool negative, double* number)
+{
+    /* "infinity" is checked before its prefix "inf" */
+    static const char* const names[] = { "infinity", "inf", "nan" };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        size_t length = strlen(names[i]);
+
+        if ((size_t) (end - position) >= length
+            && strncasecmp(position, names[i], length) == 0)
+        {
+            double value = i < 2 ? INFINITY : NAN;
+            *number = negative ? -value : value;
+            return position + length;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Parses a double
+ *
+ * @param position First char of the number
+ * @param end End of the string
+ * @param number Resulting number
+ * @return First char after the number or NULL, if it is invalid
+ */
+static inline const char* matrix_parse_double(const char* position,
+    const char* end, double* number)
+{
+    const char* start = position;
+    bool negative = *position == '-';
+
+    if (*position == '-' || *position == '+')
+    {
+        ++position;
+    }
+
+    const char* digits = position;
+    uint64_t w = 0;
+    position = matrix_parse_digits(position, end, &w);
+    int64_t digit_count = position - digits;
+
+    if (digit_count == 0)
+    {
+        return matrix_parse_special(position, end, negative, number);
+    }
+
+    int64_t q = 0;
+
+    if (position < end && *position == '.')
+    {
+        const char* fraction = ++position;
+        position = matrix_parse_digits(position, end, &w);
+        q = fraction - position;
+
+        if (q == 0)
+        {
+            return NULL;
+        }
+
+        digit_count -= q;
+    }
+
+    if (position < end && (*position == 'e' || *position == 'E'))
+    {
+        ++position;
+        bool negative_exponent = position < end && *position == '-';
+
+        if (position < end && (*position == '-' || *position == '+'))
+        {
+            ++position;
+        }
+
+        if (position == end || !matrix_is_digit(*position))
+        {
+            return NULL;
+        }
+
+        int64_t exponent = 0;
+
+        while (position < end && matrix_is_digit(*position))
+        {
+            if (exponent < MATRIX_MAX_EXPONENT)
+            {
+                exponent = exponent * 10 + (*position - '0');
+            }
+
+            ++position;
+        }
+
+        q += negative_exponent ? -exponent : exponent;
+    }
+
+    /* Leading zeros are no significant digits */
+    if (digit_count > MATRIX_MAX_DIGITS)
+    {
+        for (const char* zero = digits; zero < position
+            && (*zero == '0' || *zero == '.'); ++zero)
+        {
+            digit_count -= *zero == '0';
+        }
+
+        if (digit_count > MATRIX_MAX_DIGITS)
+        {
+            return matrix_parse_double_fallback(start, position, number);
+        }
+    }
+
+    if (w == 0 || q < MATRIX_SMALLEST_POWER)
+    {
+        *number = negative ? -0.0 : 0.0;
+    }
+    else if (q > MATRIX_LARGEST_POWER)
+    {
+        *number = negative ? -INFINITY : INFINITY;
+    }
+    else if (q >= -22 && q <= 22 && w <= (1UL << 53))
+    {
+        /* Both factors are exact, so the result is rounded correctly */
+        double value = (double) w;
+        value = q < 0 ? value / matrix_exact_powers[-q]
+            : value * matrix_exact_powers[q];
+        *number = negative ? -value : value;
+    }
+    else if (!matrix_eisel_lemire(q, w, negative, number))
+    {
+        return matrix_parse_double_fallback(start, position, number);
+    }
+
+    return position;
+}
+
+/**
+ * Enlarges the buffer of the numbers. The new capacity is extrapolated
+ * from the numbers in the parsed part of the chunk
+ *
+ * @param chunk Chunk
+ * @param position First unparsed char
+ * @return MATRIX_PARSER_SUCCESS, if successful
+ */
+static int matrix_grow_chunk(matrix_chunk_t* chunk, const char* position)
+{
+    size_t capacity = MATRIX_PARSER_CAPACITY;
+
+    if (chunk->count > 0)
+    {
+        size_t length = chunk->end - chunk->start;
+        size_t parsed = position - chunk->start;
+        size_t minimum = chunk->capacity + chunk->capacity / 2;
+
+        capacity = (size_t) (1.0625 * chunk->count * length / parsed) + 1;
+        capacity = capacity > minimum ? capacity : minimum;
+    }
+
+    void* numbers;
+
+    if (posix_memalign(&numbers, MATRIX_PARSER_ALIGNMENT,
+        capacity * sizeof(uint64_t)))
+    {
+        return MATRIX_PARSER_MEM_ERROR;
+    }
+
+    if (chunk->count > 0)
+    {
+        memcpy(numbers, chunk->numbers, chunk->count * sizeof(uint64_t));
+    }
+
+    free(chunk->numbers);
+    chunk->numbers = numbers;
+    chunk->capacity = capacity;
+
+    return MATRIX_PARSER_SUCCESS;
+}
+
+int matrix_parse_chunk(matrix_chunk_t* chunk)
+{
+    const char* position = chunk->start;
+    const char* end = chunk->end;
+    int bracket_count = chunk->bracket_count;
+    unsigned char expected_token = chunk->expected_token;
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    size_t row_start = 0;
+
+    chunk->numbers = NULL;
+    chunk->count = 0;
+    chunk->capacity = 0;
+    chunk->error = MATRIX_PARSER_PAR_ERROR;
+
+    while (position < end)
+    {
+        switch (*position)
+        {
+        case '[':
+            if (!(expected_token & TOKEN_BRACKET_OPEN))
+            {
+                return chunk->error;
+            }
+
+            if (bracket_count < 1)
+            {
+                expected_token = TOKEN_BRACKET_OPEN;
+            }
+            else
+            {
+                expected_token = TOKEN_NUMBER;
+                row_start = chunk->count;
+            }
+
+            ++bracket_count;
+            ++position;
+            break;
+
+        case ']':
+            if (!(expected_token & TOKEN_BRACKET_CLOSE))
+            {
+                return chunk->error;
+            }
+
+            if (bracket_count == 2)
+            {
+                unsigned int row_cols = chunk->count - row_start;
+
+                if (cols != 0 && cols != row_cols)
+                {
+                    return chunk->error;
+                }
+
+                cols = row_cols;
+                ++rows;
+                expected_token = TOKEN_BRACKET_CLOSE | TOKEN_COMMA;
+            }
+            else
+            {
+                expected_token = TOKEN_NONE;
+            }
+
+            --bracket_count;
+            ++position;
+            break;
+
+        case ',':
+            if (!(expected_token & TOKEN_COMMA))
+            {
+                return chunk->error;
+            }
+
+            expected_token = bracket_count == 1 ? TOKEN_BRACKET_OPEN
+                : TOKEN_NUMBER;
+            ++position;
+            break;
+
+        case ' ': case '\n':
+            ++position;
+            break;
+
+        default:
+            if (!(expected_token & TOKEN_NUMBER))
+            {
+                return chunk->error;
+            }
+
+            if (chunk->count == chunk->capacity
+                && matrix_grow_chunk(chunk, position))
+            {
+                chunk->error = MATRIX_PARSER_MEM_ERROR;
+                return chunk->error;
+            }
+
+            if (chunk->dtype == MATRIX_PARSER_LONG)
+            {
+                position = matrix_parse_long(position, end,
+                    (long long*) chunk->numbers + chunk->count);
+            }
+            else
+            {
+                position = matrix_parse_double(position, end,
+                    (double*) chunk->numbers + chunk->count);
+            }
+
+            if (position == NULL)
+            {
+                return chunk->error;
+            }
+
+            ++chunk->count;
+            expected_token = TOKEN_COMMA | TOKEN_BRACKET_CLOSE;
+            break;
+        }
+    }
+
+    chunk->rows = rows;
+    chunk->cols = cols;
+    chunk->bracket_count = bracket_count;
+    chunk->expected_token = expected_token;
+    chunk->error = MATRIX_PARSER_SUCCESS;
+
+    return chunk->error;
+}
+
+void matrix_free_chunk(matrix_chunk_t* chunk)
+{
+    free(chunk->numbers);
+    chunk->numbers = NULL;
+    chunk->count = 0;
+    chunk->capacity = 0;
+}
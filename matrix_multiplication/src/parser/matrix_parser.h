@@ -0,0 +1,72 @@
+#ifndef MATRIX_PARSER_H
+#define MATRIX_PARSER_H
+
+#include <stddef.h>
+
+/* Defines for parser return codes, equal to the matrix return codes */
+#define MATRIX_PARSER_SUCCESS   0x00 ///< Success
+#define MATRIX_PARSER_PAR_ERROR 0x01 ///< Parsing error
+#define MATRIX_PARSER_MEM_ERROR 0x02 ///< Memory allocation error
+
+/* Defines for number types, equal to the matrix element types */
+#define MATRIX_PARSER_LONG      0x01 ///< Numbers are long long ints
+#define MATRIX_PARSER_DOUBLE    0x02 ///< Numbers are doubles
+
+/* Defines for parsing */
+#define TOKEN_NONE          0x01 ///< Nothing is expected
+#define TOKEN_COMMA         0x08 ///< ',' is expected
+#define TOKEN_NUMBER        0x10 ///< A number is expected
+#define TOKEN_BRACKET_OPEN  0x20 ///< '[' is expected
+#define TOKEN_BRACKET_CLOSE 0x40 ///< ']' is expected
+
+/* Defines for sizes */
+#define MATRIX_PARSER_ALIGNMENT 64  ///< Alignment of the numbers in bytes
+#define MATRIX_PARSER_CAPACITY  256 ///< Numbers of the first allocation
+#define MATRIX_PARSER_MAX_TOKEN 128 ///< Longest number copied to the stack
+
+/**
+ * A chunk of a matrix string, which is validated and parsed in one pass.
+ * Before parsing, the state fields hold the state of the parser at the start
+ * of the chunk, afterwards at its end
+ */
+typedef struct _matrix_chunk_t
+{
+    const char* start;            ///< First char of the chunk
+    const char* end;              ///< End of the chunk
+    unsigned int dtype;           ///< MATRIX_PARSER_LONG or _DOUBLE
+    int bracket_count;            ///< Open brackets
+    unsigned char expected_token; ///< Expected tokens
+    void* numbers;                ///< Numbers of the chunk, 64-byte aligned
+    size_t count;                 ///< Numbers parsed
+    size_t capacity;              ///< Numbers, which fit into the buffer
+    unsigned int rows;            ///< Rows closed in the chunk
+    unsigned int cols;            ///< Cols of the rows or 0 without rows
+    int error;                    ///< MATRIX_PARSER_SUCCESS, if valid
+} matrix_chunk_t;
+
+/**
+ * Validates a chunk of a matrix string, counts its rows and cols and
+ * converts its numbers in a single pass. The numbers are appended to a
+ * growable buffer, which is owned by the chunk
+ *
+ * Numbers consist of an optional sign and digits. Doubles may additionally
+ * have a fraction and an exponent (e.g. -1.5e-3) or be one of "inf",
+ * "infinity" and "nan" in any case, as written for overflowed elements of
+ * a result. Doubles are converted exactly with the Clinger fast path or
+ * the Eisel-Lemire algorithm and only fall back to strtod for more than 19
+ * digits or values close to a rounding boundary. Spaces and newlines are
+ * allowed between the tokens
+ *
+ * @param chunk Chunk with its start state
+ * @return MATRIX_PARSER_SUCCESS, if successful
+ */
+int matrix_parse_chunk(matrix_chunk_t* chunk);
+
+/**
+ * Frees the numbers of a chunk
+ *
+ * @param chunk Chunk
+ */
+void matrix_free_chunk(matrix_chunk_t* chunk);
+
+#endif
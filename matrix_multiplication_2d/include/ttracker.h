@@ -2,9 +2,46 @@
 #define TTRACKER_H
 
 #include <time.h>
+#include <stddef.h>
 
 /* Defines for return codes */
 #define TTRACKER_SUCCESS 0x0 ///< Success
+#define TTRACKER_FAILURE 0x1 ///< Failure
+
+/* Defines for sizes */
+#define TTRACKER_CACHE_LINE 128 ///< Alignment of per-thread slots
+#define TTRACKER_SPAN_DEPTH 32 ///< Maximum nesting depth of spans per thread
+#define TTRACKER_SPAN_CAPACITY (1 << 20) ///< Default size of the span buffer
+#define TTRACKER_TSC_CALIBRATION 10000000 ///< TSC calibration time in ns
+
+/* Defines for hardware performance counters */
+#define TTRACKER_CYCLES         0 ///< CPU cycles
+#define TTRACKER_INSTRUCTIONS   1 ///< Retired instructions
+#define TTRACKER_LLC_MISSES     2 ///< Last level cache read misses
+#define TTRACKER_BRANCH_MISSES  3 ///< Mispredicted branches
+#define TTRACKER_DTLB_MISSES    4 ///< Data TLB read misses
+#define TTRACKER_COUNTER_COUNT  5 ///< Number of hardware counters
+
+/* Defines for resource usage */
+#define TTRACKER_MAX_RSS         0 ///< Peak resident set size in KiB
+#define TTRACKER_MINOR_FAULTS    1 ///< Page faults without I/O
+#define TTRACKER_MAJOR_FAULTS    2 ///< Page faults with I/O
+#define TTRACKER_VOL_SWITCHES    3 ///< Voluntary context switches
+#define TTRACKER_INVOL_SWITCHES  4 ///< Involuntary context switches
+#define TTRACKER_MIGRATIONS      5 ///< CPU migrations, -1 if not available
+#define TTRACKER_RUSAGE_COUNT    6 ///< Number of resource usage values
+
+/* Defines for wait histograms */
+#define TTRACKER_WAIT_BUCKETS   24 ///< Buckets of a wait histogram
+#define TTRACKER_WAIT_SHIFT      8 ///< First bucket is below 2^8 ns
+
+/* Defines for environment variables */
+#define TTRACKER_ENV_COUNTERS "TTRACKER_COUNTERS" ///< Enables counters, if 1
+#define TTRACKER_ENV_RUSAGE "TTRACKER_RUSAGE" ///< Enables resource usage, if 1
+#define TTRACKER_ENV_WAITS "TTRACKER_WAITS" ///< Enables wait histograms, if 1
+#define TTRACKER_ENV_AFFINITY "DBENCH_AFFINITY" ///< Thread pinning policy
+#define TTRACKER_ENV_TRACE "TTRACKER_TRACE" ///< Trace file, enables spans
+#define TTRACKER_ENV_CLOCK "TTRACKER_CLOCK" ///< Disables TSC, if monotonic
 
 #ifdef __cplusplus
 extern "C"
@@ -12,27 +49,150 @@ extern "C"
 #endif
 
 /**
- * Represents a time interval from ts_start to ts_stop
+ * Represents a time interval from start to stop. All times are in ticks of
+ * the timer backend, see ttracker_t
  */
 typedef struct _ttracker_event_t
 {
-    struct timespec ts_start; ///< Start of interval
-    struct timespec ts_stop;  ///< Stop of interval
+    long long start; ///< Start of interval
+    long long stop;  ///< Stop of interval
+    long long counters[TTRACKER_COUNTER_COUNT]; ///< Counter deltas
+    long long rusage[TTRACKER_RUSAGE_COUNT]; ///< Resource usage deltas
 } ttracker_event_t;
 
+/**
+ * Represents the accumulated time of one event in one thread
+ */
+typedef struct _ttracker_thread_event_t
+{
+    long long start;    ///< Start of the current interval
+    long long ticks;    ///< Accumulated time of all intervals
+    unsigned int count; ///< Number of finished intervals
+    unsigned int depth; ///< Nesting depth of start/stop calls
+    int status;         ///< If not TTRACKER_SUCCESS, measurement failed
+} ttracker_thread_event_t;
+
+/**
+ * Represents the waits of one thread during one event, e.g. at barriers
+ * or for new tasks
+ *
+ * Bucket 0 counts waits below 2^TTRACKER_WAIT_SHIFT ns, bucket b counts
+ * waits from 2^(b + TTRACKER_WAIT_SHIFT - 1) ns up to twice as long and
+ * the last bucket counts all longer waits
+ */
+typedef struct _ttracker_wait_t
+{
+    long long start;            ///< Start of the current wait
+    long long ticks;            ///< Accumulated time of all waits
+    unsigned long long count;   ///< Number of finished waits
+    unsigned long long buckets[TTRACKER_WAIT_BUCKETS]; ///< Wait histogram
+} ttracker_wait_t;
+
+/**
+ * Represents a finished span from start to stop in one thread
+ */
+typedef struct _ttracker_span_t
+{
+    const char* name;   ///< Name of the span, not copied
+    long long id;       ///< Appended to the name, if not negative
+    long long start;    ///< Start of span
+    long long stop;     ///< Stop of span
+    int thread_id;      ///< Kernel thread id of the recording thread
+    unsigned int depth; ///< Nesting depth, 0 for top level spans
+} ttracker_span_t;
+
 /**
  * Represents a tracker for time events
+ *
+ * Times are read from the TSC, if it is invariant. Otherwise, or if the
+ * environment variable TTRACKER_CLOCK is monotonic, they are read with
+ * clock_gettime(CLOCK_MONOTONIC_RAW) and a tick is one nanosecond
  */
 typedef struct _ttracker_t
 {
     int status; ///< If not TTRACKER_SUCCESS, the measurement(s) failed
     ttracker_event_t* events; ///< All time events
     unsigned int event_count; ///< Event count
+    void* thread_slots; ///< Cache-line-aligned per-thread event slots
+    size_t thread_slot_size; ///< Size of a single slot in bytes
+    unsigned int thread_count; ///< Number of per-thread slots
+    int counter_fds[TTRACKER_COUNTER_COUNT]; ///< perf_event file descriptors
+    int counters_enabled; ///< If not 0, counters are read on start/stop
+    int migration_fd; ///< perf_event file descriptor for CPU migrations
+    int rusage_enabled; ///< If not 0, resource usage is read on start/stop
+    int waits_enabled; ///< If not 0, waits are added to the histograms
+    ttracker_span_t* spans; ///< Ring buffer of finished spans
+    unsigned long long span_capacity; ///< Size of the ring buffer
+    unsigned long long span_count; ///< Number of spans ever recorded
+    const char* trace_file; ///< Written on cleanup, if not NULL
+    int tsc_enabled; ///< If not 0, ticks are read from the TSC
+    double nsec_per_tick; ///< Calibrated length of a TSC tick
+    long long tick_base; ///< TSC value at nsec_base
+    long long nsec_base; ///< CLOCK_MONOTONIC_RAW time at tick_base
+    long long* samples; ///< Durations of the repeated event in ticks
+    unsigned int sample_count; ///< Number of samples
+    unsigned int sample_capacity; ///< Maximum number of samples
 } ttracker_t;
 
+/**
+ * Removes the options --repeat N and --warmup K from the arguments, so
+ * that the remaining arguments can be parsed as before. The defaults are
+ * one repetition without warmup
+ *
+ * @param argc Argument count, is updated
+ * @param argv Argument strings, are updated
+ * @param repeat Target for the number of measured repetitions (N >= 1)
+ * @param warmup Target for the number of unmeasured repetitions (K >= 0)
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_parse_repeat(int* argc, char* argv[], unsigned int* repeat,
+    unsigned int* warmup);
+
+/**
+ * Pins the calling thread to a CPU according to the environment variable
+ * DBENCH_AFFINITY. Does nothing, if it is not set
+ *
+ * compact: Fills the cores of one NUMA node after another
+ * scatter: Distributes consecutive threads round-robin across the nodes
+ * A list:  Uses the listed CPUs (e.g. 0,2,4-7) in the given order
+ *
+ * With compact and scatter, the hardware threads of a core are only used
+ * after all cores are in use. Only CPUs of the initial affinity mask of
+ * the process are used, thread indices beyond the CPU count wrap around.
+ * Repeated calls with the same index are cheap, so that pool threads can
+ * call it for every task
+ *
+ * @param thread_index Index of the thread, 0 for the main thread
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_pin_thread(unsigned int thread_index);
+
+/**
+ * Restores the initial affinity mask of the process for the calling
+ * thread. Threads inherit the mask of the thread that creates them, so
+ * helper threads (e.g. for reading or writing files), which are created by
+ * the pinned main thread, call it to not share its CPU. Does nothing, if
+ * DBENCH_AFFINITY is not set
+ *
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_unpin_thread(void);
+
+#ifndef TTRACKER_DISABLE
+
 /**
  * Initializes the time tracker
  *
+ * Checks for an invariant TSC and calibrates it against
+ * CLOCK_MONOTONIC_RAW, which takes TTRACKER_TSC_CALIBRATION nanoseconds.
+ * If the environment variable TTRACKER_COUNTERS is 1, the hardware
+ * counters are initialized as well. If the environment variable
+ * TTRACKER_RUSAGE is 1, the resource usage is tracked as well. If the
+ * environment variable TTRACKER_WAITS is 1, the wait histograms are
+ * enabled. If the environment variable TTRACKER_TRACE is set, spans are
+ * recorded and written to that file on cleanup. The calling thread is
+ * pinned as thread 0, see ttracker_pin_thread
+ *
  * @param tracker The tracker to initialize
  * @param events The events array
  * @pararm event_count Number of events to monitor
@@ -40,6 +200,75 @@ typedef struct _ttracker_t
 void ttracker_init(ttracker_t* tracker, ttracker_event_t* events,
     unsigned int event_count);
 
+/**
+ * Opens the hardware performance counters for the calling thread. The
+ * counters are inherited by all threads created afterwards, their counts
+ * are included as soon as they are joined. If a counter is not available,
+ * the tracker stays time-only
+ *
+ * @param tracker The initialized tracker
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_init_counters(ttracker_t* tracker);
+
+/**
+ * Enables tracking of the resource usage of the whole process. Peak RSS,
+ * page faults and context switches are read with getrusage, CPU
+ * migrations with a software perf_event, which is inherited like the
+ * hardware counters
+ *
+ * @param tracker The initialized tracker
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_init_rusage(ttracker_t* tracker);
+
+/**
+ * Enables the wait histograms. Every thread slot holds one histogram per
+ * event, which is filled by ttracker_wait_begin and ttracker_wait_end
+ *
+ * @param tracker The initialized tracker
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_init_waits(ttracker_t* tracker);
+
+/**
+ * Allocates one cache-line-separated event slot per thread. Every slot
+ * holds event_count events, so the same event indices can be used
+ *
+ * @param tracker The initialized tracker
+ * @param thread_count Number of threads that track events
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_init_threads(ttracker_t* tracker, unsigned int thread_count);
+
+/**
+ * Allocates the ring buffer for spans. If more than capacity spans are
+ * recorded, the oldest ones are overwritten
+ *
+ * @param tracker The initialized tracker
+ * @param capacity Number of spans to keep
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_init_spans(ttracker_t* tracker, unsigned long long capacity);
+
+/**
+ * Allocates the storage for the durations of a repeated event
+ *
+ * @param tracker The initialized tracker
+ * @param capacity Number of samples to keep
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_init_samples(ttracker_t* tracker, unsigned int capacity);
+
+/**
+ * Writes the trace file, if TTRACKER_TRACE is set, frees the per-thread
+ * event slots, spans and samples and closes the hardware and software
+ * counters
+ *
+ * @param tracker The tracker to clean up
+ */
+void ttracker_cleanup(ttracker_t* tracker);
+
 /**
  * Tracks a start event
  *
@@ -49,20 +278,233 @@ void ttracker_init(ttracker_t* tracker, ttracker_event_t* events,
 void ttracker_start(ttracker_t* tracker, unsigned int tid);
 
 /**
- * Tracks a stop event
+ * Tracks a stop event. If spans are initialized, the event is recorded as
+ * span "event <tid>" as well
  *
  * @param tracker The tracker to use
  * @pararm tid The event index. Must be 0 <= tid < event_count
  */
 void ttracker_stop(ttracker_t* tracker, unsigned int tid);
 
+/**
+ * Tracks a start event in the slot of a thread. Nested calls for the same
+ * event are only counted once. Ignored, if tracker is NULL or the slot
+ * does not exist
+ *
+ * @param tracker The tracker to use
+ * @param thread_index The slot index. Must be 0 <= thread_index < thread_count
+ * @pararm tid The event index. Must be 0 <= tid < event_count
+ */
+void ttracker_thread_start(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid);
+
+/**
+ * Tracks a stop event in the slot of a thread and adds the interval to
+ * the accumulated time of the event
+ *
+ * @param tracker The tracker to use
+ * @param thread_index The slot index. Must be 0 <= thread_index < thread_count
+ * @pararm tid The event index. Must be 0 <= tid < event_count
+ */
+void ttracker_thread_stop(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid);
+
+/**
+ * Tracks the start of a wait in the slot of a thread, e.g. right before
+ * a barrier. Ignored, if tracker is NULL, the slot does not exist or the
+ * wait histograms are not enabled
+ *
+ * @param tracker The tracker to use
+ * @param thread_index The slot index. Must be 0 <= thread_index < thread_count
+ * @pararm tid The event index, during which the thread waits
+ */
+void ttracker_wait_begin(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid);
+
+/**
+ * Tracks the end of a wait in the slot of a thread and adds the wait to
+ * the histogram of the event
+ *
+ * @param tracker The tracker to use
+ * @param thread_index The slot index. Must be 0 <= thread_index < thread_count
+ * @pararm tid The event index, during which the thread waits
+ */
+void ttracker_wait_end(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid);
+
+/**
+ * Adds the duration of the last interval of an event as sample. Ignored,
+ * if all samples are used
+ *
+ * @param tracker The tracker to use
+ * @pararm tid The event index. Must be 0 <= tid < event_count
+ */
+void ttracker_add_sample(ttracker_t* tracker, unsigned int tid);
+
+/**
+ * Merges the status of all thread slots into the tracker status. Must be
+ * called after all threads have finished
+ *
+ * @param tracker The tracker to use
+ */
+void ttracker_merge_threads(ttracker_t* tracker);
+
+/**
+ * Merges the thread slots and clears their times, so that they only
+ * contain the next repetition. Must be called after all threads have
+ * finished
+ *
+ * @param tracker The tracker to use
+ */
+void ttracker_reset_threads(ttracker_t* tracker);
+
+/**
+ * Begins a span in the calling thread. Spans of one thread nest, every
+ * begin must be followed by an end in the same thread. Ignored, if tracker
+ * is NULL or spans are not initialized
+ *
+ * @param tracker The tracker to use
+ * @param name Name of the span. Must stay valid until the trace is written
+ * @param id Appended to the name, if not negative (e.g. "bit 17")
+ */
+void ttracker_span_begin(ttracker_t* tracker, const char* name, long long id);
+
+/**
+ * Ends the innermost span of the calling thread and records it. Can be
+ * called from any thread concurrently
+ *
+ * @param tracker The tracker to use
+ */
+void ttracker_span_end(ttracker_t* tracker);
+
+/**
+ * Writes all recorded spans in trace event format, which can be opened
+ * with Perfetto or chrome://tracing. Must be called after all threads
+ * have finished
+ *
+ * @param tracker The tracker to use
+ * @param filename The file to write
+ * @return TTRACKER_SUCCESS, if successful
+ */
+int ttracker_write_trace(const ttracker_t* tracker, const char* filename);
+
 /**
  * Prints all tracked events in SECONDS.NANOSECONDS format separated by commas
  *
+ * The line always has the same columns for the same number of events, so
+ * that their indices don't depend on the options. Absent data is printed
+ * as empty cells. The columns are, in this order:
+ *
+ * - the time of every event
+ * - the min, max and mean time over all thread slots of every event,
+ *   empty if no thread tracked the event
+ * - the min, median, p90, p99 and standard deviation of the samples,
+ *   empty if fewer than two samples were added
+ * - the cycles, instructions, LLC misses, branch misses and dTLB misses of
+ *   every event, empty if the hardware counters are disabled
+ * - the peak RSS at the stop of every event, its minor and major page
+ *   faults, its voluntary and involuntary context switches and its CPU
+ *   migrations, empty if the resource usage is disabled
+ *
+ * If the wait histograms are enabled, a wait report is printed to stderr.
+ * It contains one CSV line for every thread and event with waits: the
+ * event, the thread, the number of waits, the total wait time, its share
+ * of the event time and the histogram buckets
+ *
  * @param tracker The tracker to print
  */
 void ttracker_print_sec(const ttracker_t* tracker);
 
+#else
+
+/*
+ * TTRACKER_DISABLE compiles the time tracking out. All functions do
+ * nothing, so that the instrumentation can stay in the hot paths
+ */
+
+static inline void ttracker_init(ttracker_t* tracker,
+    ttracker_event_t* events, unsigned int event_count)
+{
+    tracker->status = TTRACKER_SUCCESS;
+    tracker->events = events;
+    tracker->event_count = event_count;
+
+    ttracker_pin_thread(0);
+}
+
+static inline int ttracker_init_counters(ttracker_t* tracker)
+{
+    return TTRACKER_FAILURE;
+}
+
+static inline int ttracker_init_rusage(ttracker_t* tracker)
+{
+    return TTRACKER_FAILURE;
+}
+
+static inline int ttracker_init_waits(ttracker_t* tracker)
+{
+    return TTRACKER_FAILURE;
+}
+
+static inline int ttracker_init_threads(ttracker_t* tracker,
+    unsigned int thread_count)
+{
+    return TTRACKER_SUCCESS;
+}
+
+static inline int ttracker_init_spans(ttracker_t* tracker,
+    unsigned long long capacity)
+{
+    return TTRACKER_FAILURE;
+}
+
+static inline int ttracker_init_samples(ttracker_t* tracker,
+    unsigned int capacity)
+{
+    return TTRACKER_SUCCESS;
+}
+
+static inline void ttracker_cleanup(ttracker_t* tracker) {}
+
+static inline void ttracker_start(ttracker_t* tracker, unsigned int tid) {}
+
+static inline void ttracker_stop(ttracker_t* tracker, unsigned int tid) {}
+
+static inline void ttracker_thread_start(ttracker_t* tracker,
+    unsigned int thread_index, unsigned int tid) {}
+
+static inline void ttracker_thread_stop(ttracker_t* tracker,
+    unsigned int thread_index, unsigned int tid) {}
+
+static inline void ttracker_wait_begin(ttracker_t* tracker,
+    unsigned int thread_index, unsigned int tid) {}
+
+static inline void ttracker_wait_end(ttracker_t* tracker,
+    unsigned int thread_index, unsigned int tid) {}
+
+static inline void ttracker_span_begin(ttracker_t* tracker,
+    const char* name, long long id) {}
+
+static inline void ttracker_span_end(ttracker_t* tracker) {}
+
+static inline int ttracker_write_trace(const ttracker_t* tracker,
+    const char* filename)
+{
+    return TTRACKER_FAILURE;
+}
+
+static inline void ttracker_add_sample(ttracker_t* tracker,
+    unsigned int tid) {}
+
+static inline void ttracker_merge_threads(ttracker_t* tracker) {}
+
+static inline void ttracker_reset_threads(ttracker_t* tracker) {}
+
+static inline void ttracker_print_sec(const ttracker_t* tracker) {}
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
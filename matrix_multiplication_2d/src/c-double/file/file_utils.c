@@ -1,5 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "file_utils.h"
 
@@ -56,3 +60,57 @@ char* read_file(const char* filename)
 
     return str;
 }
+
+void* map_file(const char* filename, size_t* size)
+{
+    int fd = open(filename, O_RDONLY);
+
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    /* Populate, so that page faults are not counted in the computation */
+    void* mapping = mmap(NULL, file_stat.st_size, PROT_READ,
+        MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    *size = file_stat.st_size;
+
+    return mapping;
+}
+
+int write_file_at(int fd, const void* buffer, size_t size, off_t offset)
+{
+    const char* position = (const char*) buffer;
+
+    /* pwrite may write less than requested */
+    while (size > 0)
+    {
+        ssize_t written = pwrite(fd, position, size, offset);
+
+        if (written == -1)
+        {
+            return FILE_FAILURE;
+        }
+
+        position += written;
+        offset += written;
+        size -= written;
+    }
+
+    return FILE_SUCCESS;
+}
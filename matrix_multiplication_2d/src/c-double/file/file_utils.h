@@ -1,6 +1,13 @@
 #ifndef FILE_UTILS_H
 #define FILE_UTILS_H
 
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Defines for file return codes */
+#define FILE_SUCCESS 0x0 ///< Success
+#define FILE_FAILURE 0x1 ///< Failure
+
 /**
  * Reads a whole file into memory
  *
@@ -10,4 +17,25 @@
  */
 char* read_file(const char* filename);
 
+/**
+ * Maps a whole file read-only into memory. All pages are faulted in
+ * before the function returns
+ *
+ * @param filename Name of the file
+ * @param size Size of the file and the mapping in bytes
+ * @return On success: Pointer to the mapping. On error: NULL
+ */
+void* map_file(const char* filename, size_t* size);
+
+/**
+ * Writes a buffer completely to a file at the given offset
+ *
+ * @param fd File descriptor
+ * @param buffer Buffer to write
+ * @param size Size of the buffer in bytes
+ * @param offset Offset in the file
+ * @return FILE_SUCCESS, if successful
+ */
+int write_file_at(int fd, const void* buffer, size_t size, off_t offset);
+
 #endif
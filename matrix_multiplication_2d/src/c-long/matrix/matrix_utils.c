@@ -2,9 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <sys/mman.h>
 
 #include "matrix.h"
 #include "matrix_utils.h"
+#include "../file/file_utils.h"
 
 void matrix_mult_worker_thread_range(matrix_args_t* args, int start_row, 
     int end_row, int start_col, int end_col)
@@ -25,6 +28,10 @@ void matrix_mult_worker_thread_range(matrix_args_t* args, int start_row,
 void* matrix_mult_worker_thread(void* pthread_args)
 {
     matrix_args_t* args = (matrix_args_t*) pthread_args;
+    ttracker_pin_thread(args->thread_index);
+    ttracker_thread_start(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+    ttracker_span_begin(args->ttracker, "worker", args->thread_index);
 
     /* Finish first row */
     if (args->start_row == args->end_row)
@@ -32,6 +39,10 @@ void* matrix_mult_worker_thread(void* pthread_args)
         matrix_mult_worker_thread_range(args, args->start_row,
             args->end_row, args->start_col, args->end_col);
 
+        ttracker_span_end(args->ttracker);
+        ttracker_thread_stop(args->ttracker, args->thread_index,
+            args->ttracker_tid);
+
         return NULL;
     }
     else
@@ -48,203 +59,373 @@ void* matrix_mult_worker_thread(void* pthread_args)
     matrix_mult_worker_thread_range(args, args->end_row, args->end_row, 0,
         args->end_col);
 
+    ttracker_span_end(args->ttracker);
+    ttracker_thread_stop(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+
+    return NULL;
+}
+
+/**
+ * Runs the worker function for every chunk or block. The main thread works
+ * on the first one
+ *
+ * @param worker Worker function
+ * @param args Parser or writer arguments for every thread
+ * @param args_size Size of the arguments of one thread
+ * @param thread_count Number of threads
+ */
+static void matrix_run_threads(void* (*worker)(void*), void* args,
+    size_t args_size, unsigned int thread_count)
+{
+    unsigned int spawned_count = thread_count - 1; // Excludes main thread
+    pthread_t threads[thread_count];
+
+    for (unsigned int i = 0; i < spawned_count; ++i)
+    {
+        pthread_create(&threads[i], NULL, worker,
+            (char*) args + (i + 1) * args_size);
+    }
+
+    worker(args);
+
+    for (unsigned int i = 0; i < spawned_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void matrix_split_string(const char* matrix_as_string, matrix_t* matrix,
+    matrix_parse_args_t* args, unsigned int thread_count)
+{
+    size_t length = strlen(matrix_as_string);
+    const char* end = matrix_as_string + length;
+
+    /* Every '[' after the first one opens a row */
+    const char* rows_start = memchr(matrix_as_string, '[', length);
+    rows_start = rows_start != NULL ? rows_start + 1 : end;
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        const char* start = matrix_as_string + length * i / thread_count;
+
+        if (i > 0)
+        {
+            start = start > rows_start ? start : rows_start;
+            start = memchr(start, '[', end - start);
+            start = start != NULL ? start : end;
+            args[i - 1].chunk.end = start;
+        }
+
+        /* All chunks except the first start in the outer brackets */
+        args[i].chunk.start = start;
+        args[i].chunk.dtype = MATRIX_DTYPE;
+        args[i].chunk.bracket_count = i > 0 ? 1 : 0;
+        args[i].chunk.expected_token = TOKEN_BRACKET_OPEN;
+        args[i].chunk.numbers = NULL;
+        args[i].matrix = matrix;
+        args[i].thread_index = i;
+    }
+
+    args[thread_count - 1].chunk.end = end;
+}
+
+void* matrix_parse_worker_thread(void* thread_args)
+{
+    matrix_parse_args_t* args = (matrix_parse_args_t*) thread_args;
+    ttracker_pin_thread(args->thread_index);
+
+    matrix_parse_chunk(&args->chunk);
+
     return NULL;
 }
 
-int matrix_check_and_parse_dimensions(const char* matrix_as_string,
-    matrix_t* matrix)
+int matrix_merge_chunks(matrix_parse_args_t* args,
+    unsigned int thread_count, matrix_t* matrix)
 {
+    const matrix_chunk_t* previous = &args[0].chunk;
     unsigned int rows = 0;
     unsigned int cols = 0;
-    int inner_commas = 0;
-    int outer_commas = 0;
-    int bracket_count = 0;
-    bool seen_colon = false;
-    unsigned char expected_token = TOKEN_BRACKET_OPEN;
-    char token;
-
-    /* Parse string and set dimensions */
-    while ((token = *(matrix_as_string++)))
+
+    for (unsigned int i = 0; i < thread_count; ++i)
     {
-        switch (token)
+        const matrix_chunk_t* chunk = &args[i].chunk;
+        args[i].start_row = rows;
+
+        /* Empty chunks don't change the state */
+        if (i > 0 && chunk->start == chunk->end)
         {
-        case '[':
-            if (!(expected_token & TOKEN_BRACKET_OPEN))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+            continue;
+        }
 
-            if (bracket_count < 1)
-            {
-                expected_token = TOKEN_BRACKET_OPEN;
-            }
-            else
-            {
-                expected_token = TOKEN_SIGN | TOKEN_NUMBER;
-            }
+        /* The parser codes equal the matrix codes */
+        if (chunk->error)
+        {
+            return chunk->error;
+        }
 
-            ++bracket_count;
-            break;
+        /* The previous chunk must end, where the next row can start */
+        if (i > 0 && (previous->bracket_count != 1
+            || previous->expected_token != TOKEN_BRACKET_OPEN))
+        {
+            return MATRIX_PAR_ERROR;
+        }
 
-        case ']':
-            if (!(expected_token & TOKEN_BRACKET_CLOSE))
+        if (chunk->cols != 0)
+        {
+            if (cols != 0 && cols != chunk->cols)
             {
                 return MATRIX_PAR_ERROR;
             }
-            if (bracket_count == 2)
-            {
-                if (cols == 0)
-                {
-                    cols = inner_commas + 1;
-                }
-                else
-                {
-                    if (cols != (inner_commas + 1))
-                    {
-                        return MATRIX_PAR_ERROR;
-                    }
-                }
-
-                inner_commas = 0;
-                expected_token = TOKEN_BRACKET_CLOSE | TOKEN_COMMA;
-            }
-            else if (bracket_count == 1)
-            {
-                rows = outer_commas + 1;
-                expected_token = TOKEN_NONE;
-            }
 
-            --bracket_count;
-            break;
+            cols = chunk->cols;
+        }
 
-        case ',':
-            if (!(expected_token & TOKEN_COMMA))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+        rows += chunk->rows;
+        previous = chunk;
+    }
 
-            switch (bracket_count)
-            {
-            case 1:
-                ++outer_commas;
-                expected_token = TOKEN_BRACKET_OPEN;
-                break;
-
-            case 2:
-                ++inner_commas;
-                expected_token = TOKEN_SIGN | TOKEN_NUMBER;
-                break;
-            }
+    /* The outer brackets must be closed */
+    if (previous->bracket_count != 0)
+    {
+        return MATRIX_PAR_ERROR;
+    }
+
+    matrix->rows = rows;
+    matrix->cols = cols;
 
-            seen_colon = false;
-            break;
+    return MATRIX_SUCCESS;
+}
 
-        case '+': case '-':
-            if (!(expected_token & TOKEN_SIGN))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+void* matrix_copy_worker_thread(void* thread_args)
+{
+    matrix_parse_args_t* args = (matrix_parse_args_t*) thread_args;
+    matrix_t* matrix = args->matrix;
+    const long long* numbers = (const long long*) args->chunk.numbers;
+    ttracker_pin_thread(args->thread_index);
+
+    if (args->chunk.count == 0)
+    {
+        return NULL;
+    }
 
-            expected_token = TOKEN_NUMBER;
-            break;
+    for (unsigned int row = 0; row < args->chunk.rows; ++row)
+    {
+        memcpy(matrix->array[args->start_row + row],
+            numbers + (size_t) row * matrix->cols,
+            sizeof(*numbers) * matrix->cols);
+    }
 
-        case '.':
-            if (!(expected_token & TOKEN_COLON))
-            {
-                return MATRIX_PAR_ERROR;
-            }
+    return NULL;
+}
+
+int matrix_parse_numbers(matrix_parse_args_t* args,
+    unsigned int thread_count, matrix_t* matrix)
+{
+    matrix_run_threads(matrix_parse_worker_thread, args, sizeof(*args),
+        thread_count);
+
+    int error = matrix_merge_chunks(args, thread_count, matrix);
+
+    if (!error)
+    {
+        if (matrix_malloc(matrix))
+        {
+            error = MATRIX_MEM_ERROR;
+        }
+        else
+        {
+            matrix_run_threads(matrix_copy_worker_thread, args, sizeof(*args),
+                thread_count);
+        }
+    }
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        matrix_free_chunk(&args[i].chunk);
+    }
+
+    return error;
+}
+
+/**
+ * Pairs of decimal digits from "00" to "99"
+ */
+static const char matrix_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+int matrix_format_number(long long number, char* buffer)
+{
+    char digits[MATRIX_BUFF_SIZE];
+    char* position = digits + MATRIX_BUFF_SIZE;
+    unsigned long long value = number < 0
+        ? 0ULL - number : (unsigned long long) number;
+
+    /* Two digits per division, from the last to the first */
+    while (value >= 100)
+    {
+        position -= 2;
+        memcpy(position, matrix_digit_pairs + value % 100 * 2, 2);
+        value /= 100;
+    }
+
+    if (value >= 10)
+    {
+        position -= 2;
+        memcpy(position, matrix_digit_pairs + value * 2, 2);
+    }
+    else
+    {
+        *(--position) = '0' + value;
+    }
+
+    if (number < 0)
+    {
+        *(--position) = '-';
+    }
+
+    int length = digits + MATRIX_BUFF_SIZE - position;
+    memcpy(buffer, position, length);
+
+    return length;
+}
+
+void matrix_split_rows(const matrix_t* matrix, int fd,
+    matrix_write_args_t* args, unsigned int thread_count)
+{
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        args[i].matrix = matrix;
+        args[i].start_row = (unsigned long long) matrix->rows * i
+            / thread_count;
+        args[i].end_row = (unsigned long long) matrix->rows * (i + 1)
+            / thread_count;
+        args[i].buffer = NULL;
+        args[i].length = 0;
+        args[i].offset = 0;
+        args[i].fd = fd;
+        args[i].thread_index = i;
+        args[i].error = MATRIX_SUCCESS;
+    }
+}
+
+void* matrix_format_worker_thread(void* thread_args)
+{
+    matrix_write_args_t* args = (matrix_write_args_t*) thread_args;
+    const matrix_t* matrix = args->matrix;
+    ttracker_pin_thread(args->thread_index);
+
+    /* A row needs at most a full buffer per number, a comma and brackets */
+    size_t row_size = (size_t) matrix->cols * (MATRIX_BUFF_SIZE + 1) + 3;
+    size_t capacity = 0;
+    size_t length = 0;
 
-            expected_token = TOKEN_NUMBER;
-            seen_colon = true;
-            break;
+    for (unsigned int row = args->start_row; row < args->end_row; ++row)
+    {
+        if (length + row_size > capacity)
+        {
+            capacity = capacity > row_size ? capacity * 2 : 8 * row_size;
+            char* buffer = (char*) realloc(args->buffer, capacity);
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            if (!(expected_token & TOKEN_NUMBER))
+            if (buffer == NULL)
             {
-                return MATRIX_PAR_ERROR;
+                args->error = MATRIX_MEM_ERROR;
+                return NULL;
             }
 
-            expected_token = TOKEN_NUMBER | TOKEN_COMMA | TOKEN_BRACKET_CLOSE;
+            args->buffer = buffer;
+        }
+
+        const long long* values = matrix->array[row];
+        char* position = args->buffer + length;
+        *(position++) = '[';
 
-            if (!seen_colon)
+        for (int col = 0; col < matrix->cols; ++col)
+        {
+            if (col > 0)
             {
-                expected_token |= TOKEN_COLON;
+                *(position++) = ',';
             }
 
-            break;
+            position += matrix_format_number(values[col], position);
+        }
 
-        case ' ': case '\n':
-            break;
+        *(position++) = ']';
 
-        default:
-            return MATRIX_PAR_ERROR;
+        if (row != matrix->rows - 1)
+        {
+            *(position++) = ',';
         }
+
+        length = position - args->buffer;
     }
 
-    matrix->rows = rows;
-    matrix->cols = cols;
+    args->length = length;
 
-    return MATRIX_SUCCESS;
+    return NULL;
 }
 
-int matrix_parse_numbers(const char* matrix_as_string,
-    matrix_t* matrix)
+void* matrix_write_worker_thread(void* thread_args)
 {
-    /* Allocate and check memory */
-    if (matrix_malloc(matrix))
+    matrix_write_args_t* args = (matrix_write_args_t*) thread_args;
+    ttracker_pin_thread(args->thread_index);
+
+    if (write_file_at(args->fd, args->buffer, args->length, args->offset))
     {
-        return MATRIX_MEM_ERROR;
+        args->error = MATRIX_FILE_ERROR;
     }
 
-    bool num_available = false;
-    int matrix_index = 0;
-    int buffer_index = 0;
-    char num_buffer[MATRIX_BUFF_SIZE] = {0};
-    char token;
+    return NULL;
+}
+
+int matrix_write_rows(matrix_write_args_t* args, unsigned int thread_count)
+{
+    matrix_run_threads(matrix_format_worker_thread, args, sizeof(*args),
+        thread_count);
+
+    /* Every block starts behind the previous ones and the opening '[' */
+    int error = MATRIX_SUCCESS;
+    off_t offset = 1;
 
-    /* Parse numbers */
-    while ((token = *(matrix_as_string++)))
+    for (unsigned int i = 0; i < thread_count; ++i)
     {
-        switch (token)
-        {
-        case '+': case '-': case '.':
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            num_available = true;
-
-            // Fill buffer with tokens
-            num_buffer[buffer_index] = token;
-            ++buffer_index;
-            break;
-
-        case ',': case ']':
-            if (!num_available)
-            {
-                break;
-            }
-            num_available = false;
-            int row = matrix_2d_index_row(matrix_index, matrix);
-            int col = matrix_2d_index_col(matrix_index, matrix);
-            matrix->array[row][col] = atoll(num_buffer);
+        args[i].offset = offset;
+        offset += args[i].length;
+        error = error ? error : args[i].error;
+    }
 
-            // Reset buffer
-            memset(num_buffer, 0, buffer_index + 1);
-            buffer_index = 0;
+    if (!error)
+    {
+        matrix_run_threads(matrix_write_worker_thread, args, sizeof(*args),
+            thread_count);
 
-            ++matrix_index;
-            break;
+        for (unsigned int i = 0; i < thread_count; ++i)
+        {
+            error = error ? error : args[i].error;
+        }
 
-        default:
-            break;
+        if (write_file_at(args[0].fd, "[", 1, 0)
+            || write_file_at(args[0].fd, "]\n", 2, offset))
+        {
+            error = MATRIX_FILE_ERROR;
         }
     }
 
-    return MATRIX_SUCCESS;
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        free(args[i].buffer);
+        args[i].buffer = NULL;
+    }
+
+    return error;
 }
 
 int matrix_malloc(matrix_t* matrix)
 {
+    matrix->mapping = NULL;
+
     matrix->array = (long long int**) malloc(sizeof(long long int*)
         * matrix->rows);
 
@@ -277,9 +458,18 @@ void matrix_cleanup(matrix_t* matrix)
 {
     if (matrix->array == NULL) return;
 
-    for (int row = 0; row < matrix->rows; ++row)
+    /* The rows of a mapped matrix point into the mapping */
+    if (matrix->mapping != NULL)
     {
-        free(matrix->array[row]);
+        munmap(matrix->mapping, matrix->mapping_size);
+        matrix->mapping = NULL;
+    }
+    else
+    {
+        for (int row = 0; row < matrix->rows; ++row)
+        {
+            free(matrix->array[row]);
+        }
     }
 
     free(matrix->array);
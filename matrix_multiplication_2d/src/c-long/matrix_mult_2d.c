@@ -16,7 +16,10 @@
 
 /**
  * Reads two matrix files and the thread_count from argv and outputs
- * the result of the matrix multiplication
+ * the result of the matrix multiplication. With --repeat N and --warmup K,
+ * the matrices are multiplied K + N times and the last N multiplications
+ * are measured. Parsed text files are cached in binary sidecars, which
+ * later runs map instead (see DBENCH_INPUT_CACHE)
  *
  * @param argc Argument count
  * @param argv Argument strings
@@ -29,9 +32,14 @@ int main(int argc, char* argv[])
     ttracker_init(&ttracker, ttracker_events, TTRACKER_TOTAL);
     ttracker_start(&ttracker, TTRACKER_MAIN);
 
-    if (argc < 4 || argc > 5)
+    unsigned int repeat;
+    unsigned int warmup;
+
+    if (ttracker_parse_repeat(&argc, argv, &repeat, &warmup)
+        || argc < 4 || argc > 5)
     {
-        printf("Usage: %s file1 file2 outfile [thread_count=1]\n", argv[0]);
+        printf("Usage: %s [--repeat N] [--warmup K] file1 file2 outfile "
+            "[thread_count=1]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
@@ -48,65 +56,91 @@ int main(int argc, char* argv[])
         }
     }
 
+    if (ttracker_init_threads(&ttracker, thread_count)
+        || ttracker_init_samples(&ttracker, repeat))
+    {
+        printf("Could not initialize time tracker!\n");
+        return EXIT_FAILURE;
+    }
+
     matrix_t matrix1;
     matrix_t matrix2;
     matrix_t result;
+    int write_cache1;
+    int write_cache2;
 
     ttracker_start(&ttracker, TTRACKER_PARSING);
 
-    char* matrix_as_string = read_file(argv[1]);
-    if (matrix_as_string == NULL)
-    {
-        printf("Could not read matrix1 file!\n");
-        return EXIT_FAILURE;
-    }
-
+    /* The result is written in the format of the first matrix file */
+    int binary = matrix_is_binary_file(argv[1]);
     int error_occurred = 0;
 
-    error_occurred = matrix_from_string(matrix_as_string, &matrix1);
+    error_occurred = matrix_read_file(argv[1], &matrix1, thread_count,
+        &write_cache1);
     if (error_occurred)
     {
-        printf("Could not parse matrix 1!\n");
-        free(matrix_as_string);
+        printf(error_occurred == MATRIX_FILE_ERROR
+            ? "Could not read matrix1 file!\n"
+            : "Could not parse matrix 1!\n");
         return EXIT_FAILURE;
     }
 
-    free(matrix_as_string);
-    matrix_as_string = read_file(argv[2]);
-
-    if (matrix_as_string == NULL)
-    {
-        printf("Could not read matrix2 file!\n");
-        matrix_cleanup(&matrix1);
-        return EXIT_FAILURE;
-    }
-
-    error_occurred = matrix_from_string(matrix_as_string, &matrix2);
+    error_occurred = matrix_read_file(argv[2], &matrix2, thread_count,
+        &write_cache2);
     if (error_occurred)
     {
-        printf("Could not parse matrix 2!\n");
-        free(matrix_as_string);
+        printf(error_occurred == MATRIX_FILE_ERROR
+            ? "Could not read matrix2 file!\n"
+            : "Could not parse matrix 2!\n");
         matrix_cleanup(&matrix1);
         return EXIT_FAILURE;
     }
 
-    free(matrix_as_string);
-
     ttracker_stop(&ttracker, TTRACKER_PARSING);
 
-    ttracker_start(&ttracker, TTRACKER_MULT);
-
-    if (thread_count == 1)
+    /* The sidecars are written outside of the events */
+    if (write_cache1)
     {
-        error_occurred = matrix_mult(&matrix1, &matrix2, &result);
+        matrix_write_cache(&matrix1, argv[1]);
     }
-    else
+
+    if (write_cache2)
     {
-        error_occurred =
-            matrix_mult_parallel(&matrix1, &matrix2, &result, thread_count);
+        matrix_write_cache(&matrix2, argv[2]);
     }
 
-    ttracker_stop(&ttracker, TTRACKER_MULT);
+    for (unsigned int i = 0; i < warmup + repeat && !error_occurred; ++i)
+    {
+        /* Every multiplication allocates a new result */
+        if (i > 0)
+        {
+            matrix_cleanup(&result);
+        }
+
+        ttracker_reset_threads(&ttracker);
+        ttracker_start(&ttracker, TTRACKER_MULT);
+
+        if (thread_count == 1)
+        {
+            ttracker_thread_start(&ttracker, 0, TTRACKER_MULT);
+            ttracker_span_begin(&ttracker, "worker", 0);
+            error_occurred = matrix_mult(&matrix1, &matrix2, &result);
+            ttracker_span_end(&ttracker);
+            ttracker_thread_stop(&ttracker, 0, TTRACKER_MULT);
+        }
+        else
+        {
+            error_occurred = matrix_mult_parallel(&matrix1, &matrix2, &result,
+                thread_count, &ttracker, TTRACKER_MULT);
+        }
+
+        ttracker_stop(&ttracker, TTRACKER_MULT);
+
+        if (i >= warmup)
+        {
+            ttracker_add_sample(&ttracker, TTRACKER_MULT);
+        }
+    }
 
     if (error_occurred)
     {
@@ -118,7 +152,10 @@ int main(int argc, char* argv[])
 
     ttracker_start(&ttracker, TTRACKER_WRITE);
 
-    if (matrix_write_file(&result, argv[3]))
+    error_occurred = binary ? matrix_write_binary_file(&result, argv[3])
+        : matrix_write_file(&result, argv[3], thread_count);
+
+    if (error_occurred)
     {
         printf("Could not write result matrix to file!\n");
         matrix_cleanup(&matrix1);
@@ -134,14 +171,17 @@ int main(int argc, char* argv[])
     matrix_cleanup(&result);
 
     ttracker_stop(&ttracker, TTRACKER_MAIN);
+    ttracker_merge_threads(&ttracker);
 
     if (ttracker.status != TTRACKER_SUCCESS)
     {
         printf("Error with measuring time!\n");
+        ttracker_cleanup(&ttracker);
         return EXIT_FAILURE;
     }
 
     ttracker_print_sec(&ttracker);
+    ttracker_cleanup(&ttracker);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,76 @@
+#ifndef INPUT_CACHE_H
+#define INPUT_CACHE_H
+
+#include <stddef.h>
+
+/* Defines for input cache return codes */
+#define INPUT_CACHE_SUCCESS 0x0 ///< Success
+#define INPUT_CACHE_FAILURE 0x1 ///< Failure
+
+/* Defines for the input cache */
+#define INPUT_CACHE_ENV         "DBENCH_INPUT_CACHE" ///< "1" enables it
+#define INPUT_CACHE_HEADER_SIZE 64      ///< Size of the binary file header
+#define INPUT_CACHE_KEY_OFFSET  32      ///< Offset of the key in the header
+#define INPUT_CACHE_CHUNK_SIZE  1048576 ///< Bytes hashed per read
+
+/**
+ * Identifies the text file, from which a sidecar was created. It is stored
+ * in the reserved bytes at the end of the header of the sidecar
+ */
+typedef struct _input_cache_key_t
+{
+    unsigned long long size;     ///< Size of the text file in bytes
+    unsigned long long mtime;    ///< Modification time in nanoseconds
+    unsigned long long hash;     ///< Hash of the content
+    unsigned long long reserved; ///< Always 0
+} input_cache_key_t;
+
+/**
+ * A part of the elements of a sidecar, e.g. a row of a matrix
+ */
+typedef struct _input_cache_part_t
+{
+    const void* data; ///< First byte of the part
+    size_t size;      ///< Size of the part in bytes
+} input_cache_part_t;
+
+/**
+ * Checks whether the input cache is enabled. It is enabled by setting the
+ * environment variable DBENCH_INPUT_CACHE to "1", "on", "true" or "yes",
+ * otherwise text files are always parsed
+ *
+ * @return 1, if the cache is enabled, else 0
+ */
+int input_cache_enabled(void);
+
+/**
+ * Finds the sidecar of a text file, which is its name followed by the
+ * suffix. The sidecar is only valid, if the key in its header matches the
+ * size, the modification time and the hash of the whole text file. A found
+ * sidecar is reported on stderr
+ *
+ * @param filename Name of the text file
+ * @param suffix Suffix of the sidecar, e.g. ".dbin"
+ * @return Name of the valid sidecar, which must be freed, or NULL
+ */
+char* input_cache_find(const char* filename, const char* suffix);
+
+/**
+ * Writes the sidecar of a text file. The sidecar consists of the header with
+ * the key of the text file and the parts. It is written to a temporary file,
+ * which replaces the sidecar when it is complete, so a sidecar is never seen
+ * half-written. The result is reported on stderr. The sidecar is written
+ * synchronously, so it should be called outside of the measured events
+ *
+ * @param filename Name of the text file
+ * @param suffix Suffix of the sidecar, e.g. ".dbin"
+ * @param header Binary file header of INPUT_CACHE_HEADER_SIZE bytes, its
+ *        key bytes are overwritten in the sidecar
+ * @param parts Parts of the elements
+ * @param part_count Number of parts
+ * @return INPUT_CACHE_SUCCESS, if the sidecar was written
+ */
+int input_cache_write(const char* filename, const char* suffix,
+    const void* header, const input_cache_part_t* parts, size_t part_count);
+
+#endif
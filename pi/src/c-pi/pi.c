@@ -18,10 +18,11 @@
  */
 typedef struct _pi_args_t
 {
-    long step_count;    ///< Step count
-    int thread_count;   ///< Thread count
-    int tid;            ///< Thread index
-    double value;       ///< Calculated value
+    long step_count;      ///< Step count
+    int thread_count;     ///< Thread count
+    int tid;              ///< Thread index
+    double value;         ///< Calculated value
+    ttracker_t* ttracker; ///< Tracker for per-thread times
 } pi_args_t;
 
 /**
@@ -33,6 +34,9 @@ typedef struct _pi_args_t
 void* worker_thread(void *pthread_args)
 {
     pi_args_t* args = (pi_args_t*) pthread_args;
+    ttracker_pin_thread(args->tid);
+    ttracker_thread_start(args->ttracker, args->tid, TTRACKER_CALC);
+    ttracker_span_begin(args->ttracker, "worker", args->tid);
 
     double sum = 0.0;
     double step = 1.0 / args->step_count;
@@ -51,11 +55,16 @@ void* worker_thread(void *pthread_args)
     }
     
     args->value = sum;
+    ttracker_span_end(args->ttracker);
+    ttracker_thread_stop(args->ttracker, args->tid, TTRACKER_CALC);
+
     return NULL;
 }
 
 /**
- * Reads the number of steps and calculates pi
+ * Reads the number of steps and calculates pi. With --repeat N and
+ * --warmup K, pi is calculated K + N times and the last N calculations
+ * are measured
  *
  * @param argc Argument count
  * @param argv Argument strings
@@ -68,9 +77,14 @@ int main(int argc, char* argv[])
     ttracker_init(&ttracker, ttracker_events, TTRACKER_TOTAL);
     ttracker_start(&ttracker, TTRACKER_MAIN);
 
-    if (argc < 2 || argc > 3)
+    unsigned int repeat;
+    unsigned int warmup;
+
+    if (ttracker_parse_repeat(&argc, argv, &repeat, &warmup)
+        || argc < 2 || argc > 3)
     {
-        printf("Usage: %s step_count [thread_count=1]\n", argv[0]);
+        printf("Usage: %s [--repeat N] [--warmup K] step_count "
+            "[thread_count=1]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
@@ -96,45 +110,66 @@ int main(int argc, char* argv[])
         }
     }
 
-    ttracker_start(&ttracker, TTRACKER_CALC);
-
-    int spawned_count = thread_count - 1; // Main thread also works
-    pi_args_t args[thread_count];
-    pthread_t threads[spawned_count]; 
-    
-    /* Create thread args */
-    for (int i = 0; i < thread_count; ++i)
+    if (ttracker_init_threads(&ttracker, thread_count)
+        || ttracker_init_samples(&ttracker, repeat))
     {
-        args[i].step_count = step_count;
-        args[i].thread_count = thread_count;
-        args[i].tid = i;
+        printf("Could not initialize time tracker!\n");
+        return EXIT_FAILURE;
     }
 
-    /* Create threads */
-    for (int i = 0; i < spawned_count; ++i)
+    double pi = 0.0;
+
+    for (unsigned int repetition = 0; repetition < warmup + repeat;
+        ++repetition)
     {
-        pthread_create(&threads[i], NULL, worker_thread, (void*) &args[i + 1]);
-    }
+        ttracker_reset_threads(&ttracker);
+        ttracker_start(&ttracker, TTRACKER_CALC);
+
+        int spawned_count = thread_count - 1; // Main thread also works
+        pi_args_t args[thread_count];
+        pthread_t threads[spawned_count]; 
+        
+        /* Create thread args */
+        for (int i = 0; i < thread_count; ++i)
+        {
+            args[i].step_count = step_count;
+            args[i].thread_count = thread_count;
+            args[i].tid = i;
+            args[i].ttracker = &ttracker;
+        }
 
-    worker_thread((void*) &args[0]);
+        /* Create threads */
+        for (int i = 0; i < spawned_count; ++i)
+        {
+            pthread_create(&threads[i], NULL, worker_thread,
+                (void*) &args[i + 1]);
+        }
 
-    /* Wait for all threads to finish */
-    for (int i = 0; i < spawned_count; ++i)
-    {
-        pthread_join(threads[i], NULL);
-    }
+        worker_thread((void*) &args[0]);
 
-    double sum = 0.0;
+        /* Wait for all threads to finish */
+        for (int i = 0; i < spawned_count; ++i)
+        {
+            pthread_join(threads[i], NULL);
+        }
 
-    for (int i = 0; i < thread_count; ++i)
-    {
-        sum += args[i].value;
-    }
+        double sum = 0.0;
+
+        for (int i = 0; i < thread_count; ++i)
+        {
+            sum += args[i].value;
+        }
+
+        double step = 1.0 / step_count;
+        pi = sum * step;
 
-    double step = 1.0 / step_count;
-    double pi = sum * step;
+        ttracker_stop(&ttracker, TTRACKER_CALC);
 
-    ttracker_stop(&ttracker, TTRACKER_CALC);
+        if (repetition >= warmup)
+        {
+            ttracker_add_sample(&ttracker, TTRACKER_CALC);
+        }
+    }
 
     /* Prevent the compiler from optimizing away the pi variable */
     FILE* fp = fopen("/dev/null", "w");
@@ -143,7 +178,9 @@ int main(int argc, char* argv[])
 
     ttracker_stop(&ttracker, TTRACKER_MAIN);
 
+    ttracker_merge_threads(&ttracker);
     ttracker_print_sec(&ttracker);
+    ttracker_cleanup(&ttracker);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,217 @@
+#include "input_cache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* Defines for the content hash */
+#define HASH_OFFSET 0xCBF29CE484222325ULL ///< Hash of no bytes
+#define HASH_PRIME  0x9E3779B97F4A7C15ULL ///< Multiplier per word
+
+/**
+ * Concatenates the name of a text file and a suffix
+ *
+ * @param filename Name of the text file
+ * @param suffix Suffix
+ * @return The name, which must be freed, or NULL
+ */
+static char* input_cache_path(const char* filename, const char* suffix)
+{
+    size_t length = strlen(filename);
+    char* path = (char*) malloc(length + strlen(suffix) + 1);
+
+    if (path != NULL)
+    {
+        memcpy(path, filename, length);
+        strcpy(path + length, suffix);
+    }
+
+    return path;
+}
+
+/**
+ * Computes the key of a text file. The whole file is hashed word by word,
+ * which is much cheaper than parsing it, so that every changed byte makes
+ * the sidecar invalid
+ *
+ * @param filename Name of the text file
+ * @param key The key
+ * @return INPUT_CACHE_SUCCESS, if successful
+ */
+static int input_cache_key(const char* filename, input_cache_key_t* key)
+{
+    int fd = open(filename, O_RDONLY);
+
+    if (fd == -1)
+    {
+        return INPUT_CACHE_FAILURE;
+    }
+
+    struct stat file_stat;
+    unsigned long long word;
+    /* The last word of the file is padded with zeros */
+    unsigned char* chunk = (unsigned char*) malloc(INPUT_CACHE_CHUNK_SIZE
+        + sizeof(word));
+
+    if (chunk == NULL || fstat(fd, &file_stat) == -1)
+    {
+        free(chunk);
+        close(fd);
+        return INPUT_CACHE_FAILURE;
+    }
+
+    size_t size = file_stat.st_size;
+    unsigned long long hash = HASH_OFFSET;
+    int error = INPUT_CACHE_SUCCESS;
+
+    for (size_t offset = 0; offset < size && !error;
+        offset += INPUT_CACHE_CHUNK_SIZE)
+    {
+        size_t chunk_size = size - offset < INPUT_CACHE_CHUNK_SIZE
+            ? size - offset : INPUT_CACHE_CHUNK_SIZE;
+
+        if (pread(fd, chunk, chunk_size, offset) != (ssize_t) chunk_size)
+        {
+            error = INPUT_CACHE_FAILURE;
+            break;
+        }
+
+        memset(chunk + chunk_size, 0, sizeof(word));
+
+        for (size_t byte = 0; byte < chunk_size; byte += sizeof(word))
+        {
+            memcpy(&word, chunk + byte, sizeof(word));
+            hash = (hash ^ word) * HASH_PRIME;
+            hash ^= hash >> 32;
+        }
+    }
+
+    free(chunk);
+    close(fd);
+
+    key->size = size;
+    key->mtime = (unsigned long long) file_stat.st_mtim.tv_sec * 1000000000
+        + file_stat.st_mtim.tv_nsec;
+    key->hash = hash;
+    key->reserved = 0;
+
+    return error;
+}
+
+int input_cache_enabled(void)
+{
+    const char* value = getenv(INPUT_CACHE_ENV);
+
+    return value != NULL && (strcmp(value, "1") == 0
+        || strcasecmp(value, "on") == 0 || strcasecmp(value, "true") == 0
+        || strcasecmp(value, "yes") == 0);
+}
+
+char* input_cache_find(const char* filename, const char* suffix)
+{
+    input_cache_key_t key;
+    input_cache_key_t sidecar_key;
+    char* path = input_cache_path(filename, suffix);
+
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd == -1)
+    {
+        free(path);
+        return NULL;
+    }
+
+    ssize_t read = pread(fd, &sidecar_key, sizeof(sidecar_key),
+        INPUT_CACHE_KEY_OFFSET);
+    close(fd);
+
+    if (read != sizeof(sidecar_key) || input_cache_key(filename, &key)
+        || memcmp(&key, &sidecar_key, sizeof(key)) != 0)
+    {
+        free(path);
+        return NULL;
+    }
+
+    fprintf(stderr, "Input read from sidecar %s\n", path);
+
+    return path;
+}
+
+int input_cache_write(const char* filename, const char* suffix,
+    const void* header, const input_cache_part_t* parts, size_t part_count)
+{
+    input_cache_key_t key;
+    char temp_suffix[32];
+    char* path = input_cache_path(filename, suffix);
+
+    if (path == NULL)
+    {
+        return INPUT_CACHE_FAILURE;
+    }
+
+    /* Unique per process, e.g. if two runs parse the same file */
+    snprintf(temp_suffix, sizeof(temp_suffix), ".%ld.tmp", (long) getpid());
+    char* temp_path = input_cache_path(path, temp_suffix);
+    int fd = temp_path != NULL && input_cache_key(filename, &key) == 0
+        ? open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+
+    if (fd == -1)
+    {
+        fprintf(stderr, "Input parsed, could not write sidecar %s!\n", path);
+        free(temp_path);
+        free(path);
+        return INPUT_CACHE_FAILURE;
+    }
+
+    char key_header[INPUT_CACHE_HEADER_SIZE];
+    memcpy(key_header, header, INPUT_CACHE_HEADER_SIZE);
+    memcpy(key_header + INPUT_CACHE_KEY_OFFSET, &key, sizeof(key));
+
+    int error = INPUT_CACHE_SUCCESS;
+
+    for (size_t i = 0; i <= part_count && !error; ++i)
+    {
+        const char* data = i == 0
+            ? key_header : (const char*) parts[i - 1].data;
+        size_t size = i == 0 ? INPUT_CACHE_HEADER_SIZE : parts[i - 1].size;
+
+        while (size > 0)
+        {
+            ssize_t written = write(fd, data, size);
+
+            if (written <= 0)
+            {
+                error = INPUT_CACHE_FAILURE;
+                break;
+            }
+
+            data += written;
+            size -= written;
+        }
+    }
+
+    if (close(fd) == -1 || error || rename(temp_path, path) == -1)
+    {
+        unlink(temp_path);
+        error = INPUT_CACHE_FAILURE;
+        fprintf(stderr, "Input parsed, could not write sidecar %s!\n", path);
+    }
+    else
+    {
+        fprintf(stderr, "Input parsed, wrote sidecar %s\n", path);
+    }
+
+    free(temp_path);
+    free(path);
+
+    return error;
+}
@@ -17,7 +17,10 @@
 #define TTRACKER_TOTAL   4 ///< Total events tracked
 
 /**
- * Reads a number list from argv and sorts the list using quick sort
+ * Reads a number list from argv and sorts the list using quick sort. With
+ * --repeat N and --warmup K, the list is sorted K + N times and the last N
+ * sorts are measured. A parsed text file is cached in a binary sidecar,
+ * which later runs map instead (see DBENCH_INPUT_CACHE)
  *
  * @param argc Argument count
  * @param argv Argument strings
@@ -30,9 +33,14 @@ int main(int argc, char* argv[])
     ttracker_init(&ttracker, ttracker_events, TTRACKER_TOTAL);
     ttracker_start(&ttracker, TTRACKER_MAIN);
 
-    if (argc < 2 || argc > 3)
+    unsigned int repeat;
+    unsigned int warmup;
+
+    if (ttracker_parse_repeat(&argc, argv, &repeat, &warmup)
+        || argc < 2 || argc > 3)
     {
-        std::cout << "Usage: " <<  argv[0] << " array_file [thread_count=1]\n";
+        std::cout << "Usage: " <<  argv[0]
+            << " [--repeat N] [--warmup K] array_file [thread_count=1]\n";
         return EXIT_FAILURE;
     }
 
@@ -49,33 +57,98 @@ int main(int argc, char* argv[])
         }
     }
 
-    ttracker_start(&ttracker, TTRACKER_PARSE);
-    auto array_string = std::shared_ptr<char>(read_file(argv[1]), free);
-
-    if (array_string == NULL)
+    if (ttracker_init_threads(&ttracker, thread_count)
+        || ttracker_init_samples(&ttracker, repeat))
     {
-        std::cout << "Could not read array_file!\n";
+        std::cout << "Could not initialize time tracker!\n";
         return EXIT_FAILURE;
     }
 
+    ttracker_start(&ttracker, TTRACKER_PARSE);
     std::vector<unsigned long> vector;
-    unsigned long long vector_size;
+    bool write_cache = false;
+    char* sidecar = nullptr;
+    bool binary = is_array_file(argv[1]);
 
-    try
+    if (!binary && input_cache_enabled())
     {
-        vector_size = sort_check_and_parse_length(array_string);
-        vector = sort_parse_numbers(vector_size, array_string);
+        sidecar = input_cache_find(argv[1], ARRAY_CACHE_SUFFIX);
     }
-    catch (const std::exception& ex)
+
+    if (binary || sidecar != nullptr)
     {
-        std::cout << ex.what() << "\n";
-        return EXIT_FAILURE;
+        // Binary array files and their sidecars are mapped and copied
+        array_file_t array_file;
+        int error = map_array_file(binary ? argv[1] : sidecar, &array_file);
+        std::free(sidecar);
+
+        if (error)
+        {
+            std::cout << "Could not map array_file!\n";
+            return EXIT_FAILURE;
+        }
+
+        if (array_file.element_size == sizeof(unsigned long))
+        {
+            auto data = static_cast<const unsigned long*>(array_file.data);
+            vector.assign(data, data + array_file.count);
+        }
+        else
+        {
+            auto data = static_cast<const unsigned int*>(array_file.data);
+            vector.assign(data, data + array_file.count);
+        }
+
+        unmap_array_file(&array_file);
+    }
+    else
+    {
+        // Text array files are read and parsed at the same time
+        try
+        {
+            vector = sort_read_numbers(argv[1], thread_count);
+        }
+        catch (const std::exception& ex)
+        {
+            std::cout << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+
+        write_cache = input_cache_enabled();
     }
     ttracker_stop(&ttracker,TTRACKER_PARSE);
 
-    ttracker_start(&ttracker, TTRACKER_SORT);
-    sort(vector, thread_count);
-    ttracker_stop(&ttracker, TTRACKER_SORT);
+    // The sidecar is written before sorting and outside of the events
+    if (write_cache)
+    {
+        write_array_cache(argv[1], vector.data(), vector.size());
+    }
+
+    // Untouched copy of the vector for repetitions
+    std::vector<unsigned long> original;
+
+    if (warmup + repeat > 1)
+    {
+        original = vector;
+    }
+
+    for (unsigned int i = 0; i < warmup + repeat; ++i)
+    {
+        if (i > 0)
+        {
+            std::copy(original.begin(), original.end(), vector.begin());
+        }
+
+        ttracker_reset_threads(&ttracker);
+        ttracker_start(&ttracker, TTRACKER_SORT);
+        sort(vector, thread_count, &ttracker, TTRACKER_SORT);
+        ttracker_stop(&ttracker, TTRACKER_SORT);
+
+        if (i >= warmup)
+        {
+            ttracker_add_sample(&ttracker, TTRACKER_SORT);
+        }
+    }
 
     ttracker_start(&ttracker, TTRACKER_VERIFY);
     if (!std::is_sorted(vector.begin(), vector.end()))
@@ -86,7 +159,9 @@ int main(int argc, char* argv[])
     ttracker_stop(&ttracker, TTRACKER_VERIFY);
 
     ttracker_stop(&ttracker, TTRACKER_MAIN);
+    ttracker_merge_threads(&ttracker);
     ttracker_print_sec(&ttracker);
+    ttracker_cleanup(&ttracker);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,32 @@
+#ifndef SMALL_SORT_HPP
+#define SMALL_SORT_HPP
+
+#include <cstddef>
+
+/* Defines for sorting small ranges */
+#define SMALL_SORT_MAX        256                  ///< Max. elements
+#define SMALL_SORT_CUTOFF_ENV "DBENCH_SORT_CUTOFF" ///< Sequential cutoff
+
+/**
+ * Sorts up to SMALL_SORT_MAX elements with a bitonic sorting network. The
+ * elements are copied into a buffer, whose size is the next power of 2, and
+ * padded with the biggest value. Networks of up to 64 elements are merged
+ * by the same bitonic merge stages. With AVX-512 or AVX2, the stages
+ * compare 8 or 4 elements at once, otherwise every compare-exchange is done
+ * without branches
+ *
+ * @param data First element
+ * @param count Number of elements, at most SMALL_SORT_MAX
+ */
+void small_sort(unsigned long* data, size_t count);
+
+/**
+ * Reads the sequential cutoff from the environment variable
+ * DBENCH_SORT_CUTOFF. Ranges below the cutoff are sorted sequentially
+ *
+ * @param default_cutoff Cutoff, if the variable isn't set or invalid
+ * @return The cutoff, at least 2
+ */
+size_t small_sort_cutoff(size_t default_cutoff);
+
+#endif
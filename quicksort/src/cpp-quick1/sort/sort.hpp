@@ -3,8 +3,14 @@
 
 #include <vector>
 
+#include <ttracker.h>
+
 #include "../taskpool/taskpool.hpp"
 
+/* Defines for sorting */
+#define SORT_DEFAULT_CUTOFF   2    ///< Complete recursion
+#define SORT_UNBALANCED_RATIO 8    ///< Unbalanced, if a side exceeds 7/8
+
 /**
  * Exception for parsing errors
  */
@@ -14,15 +20,32 @@ public:
     const char* what() const noexcept override;
 };
 
+/**
+ * Exception for errors while reading the array file
+ */
+class sort_file_exception : public std::exception
+{
+public:
+    const char* what() const noexcept override;
+};
+
 /**
  * Sorts the vector using
  * Introsort, if threadCount <= 1
  * Quicksort, if threadCount >  1
  *
+ * Ranges below the cutoff (DBENCH_SORT_CUTOFF, SORT_DEFAULT_CUTOFF by
+ * default) are sorted sequentially, with small_sort up to SMALL_SORT_MAX
+ * elements. A linear scan detects vectors, which are sorted already or in
+ * descending order, before the taskpool is started
+ *
  * @param vector The vector to be sorted
  * @param thread_count Thread count
+ * @param ttracker Tracker for the per-thread sort times
+ * @param ttracker_tid Event index of the sort phase
  */
-void sort(std::vector<unsigned long>& vector, const unsigned int thread_count);
+void sort(std::vector<unsigned long>& vector, const unsigned int thread_count,
+    ttracker_t* ttracker, unsigned int ttracker_tid);
 
 /**
  * Sorts a range between to iterators using parallel quicksort
@@ -30,11 +53,17 @@ void sort(std::vector<unsigned long>& vector, const unsigned int thread_count);
  * This function is inspired from the example at
  * https://en.cppreference.com/w/cpp/algorithm/partition
  *
+ * The pivot is the ninther of the range. After an unbalanced partition,
+ * elements of both sides are shuffled deterministically, and ranges beyond
+ * the depth limit are sorted with heapsort
+ *
  * @param first First iterator
  * @param last Last iterator
  * @param tasks Taskpool
+ * @param depth_limit Partition steps left
  */
 void sort_parallel(std::vector<unsigned long>::iterator first,
-    std::vector<unsigned long>::iterator last, taskpool& tasks);
+    std::vector<unsigned long>::iterator last, taskpool& tasks,
+    unsigned int depth_limit);
 
 #endif
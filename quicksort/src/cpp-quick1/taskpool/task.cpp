@@ -0,0 +1,30 @@
+#include "task.hpp"
+
+#include <memory>
+#include <vector>
+
+task* task_arena::allocate()
+{
+    if (free_list_ == nullptr)
+    {
+        blocks_.push_back(std::make_unique<task[]>(TASK_ARENA_BLOCK));
+        task* block = blocks_.back().get();
+
+        for (unsigned int i = 0; i < TASK_ARENA_BLOCK; ++i)
+        {
+            block[i].next = free_list_;
+            free_list_ = &block[i];
+        }
+    }
+
+    task* free_task = free_list_;
+    free_list_ = free_task->next;
+
+    return free_task;
+}
+
+void task_arena::free(task* finished_task)
+{
+    finished_task->next = free_list_;
+    free_list_ = finished_task;
+}
@@ -0,0 +1,107 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/* Defines for tasks */
+#define TASK_STORAGE     48  ///< Bytes for the captures of a task
+#define TASK_ARENA_BLOCK 256 ///< Tasks allocated at once by an arena
+#define TASK_ARENA_LINE  64  ///< Bytes of a cache line
+
+/**
+ * This class represents a task, which stores its function inline instead
+ * of on the heap. The function must be trivially copyable and destructible
+ * (e.g. a lambda, that captures iterators and references) and fit into
+ * TASK_STORAGE bytes
+ */
+class task
+{
+public:
+    /**
+     * Stores a function in the task
+     *
+     * @param func Function to store
+     */
+    template<typename F>
+    void assign(const F& func)
+    {
+        static_assert(sizeof(F) <= TASK_STORAGE,
+            "Captures of the task are too large");
+        static_assert(alignof(F) <= alignof(std::max_align_t),
+            "Captures of the task are overaligned");
+        static_assert(std::is_trivially_copyable_v<F>
+            && std::is_trivially_destructible_v<F>,
+            "Captures of the task must be trivially copyable");
+
+        ::new (static_cast<void*>(storage_)) F(func);
+        invoke_ = [](void* storage)
+        {
+            (*std::launder(static_cast<F*>(storage)))();
+        };
+    }
+
+    /**
+     * Executes the stored function
+     */
+    void operator()()
+    {
+        invoke_(storage_);
+    }
+
+    /**
+     * Next free task, while the task is in the free list of an arena
+     */
+    task* next = nullptr;
+
+private:
+    /**
+     * Storage of the function
+     */
+    alignas(std::max_align_t) unsigned char storage_[TASK_STORAGE];
+
+    /**
+     * Calls the function in the storage
+     */
+    void (*invoke_)(void*) = nullptr;
+};
+
+/**
+ * This class represents the tasks of one thread. Freed tasks are kept in a
+ * free list and reused, new tasks are allocated in blocks. Only its thread
+ * may use the arena, but tasks may be freed into another arena than the one
+ * they were allocated from. The memory is released with the arena
+ */
+class alignas(TASK_ARENA_LINE) task_arena
+{
+public:
+    /**
+     * Returns a free task
+     *
+     * @return The task
+     */
+    task* allocate();
+
+    /**
+     * Puts a task into the free list
+     *
+     * @param finished_task Task, which isn't used anymore
+     */
+    void free(task* finished_task);
+
+private:
+    /**
+     * First free task
+     */
+    task* free_list_ = nullptr;
+
+    /**
+     * Blocks of allocated tasks
+     */
+    std::vector<std::unique_ptr<task[]>> blocks_;
+};
+
+#endif
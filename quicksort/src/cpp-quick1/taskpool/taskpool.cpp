@@ -1,36 +1,76 @@
 #include "taskpool.hpp"
 
+#include <atomic>
 #include <mutex>
-#include <queue>
 #include <memory>
 #include <thread>
 #include <vector>
-#include <functional>
 #include <condition_variable>
 
-taskpool::taskpool(unsigned int thread_count)
-    : thread_count_(thread_count), working_threads_(thread_count)
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "task.hpp"
+#include "work_deque.hpp"
+
+/**
+ * Taskpool and deque index of the current thread
+ */
+static thread_local const taskpool* current_taskpool = nullptr;
+static thread_local unsigned int current_index = 0;
+
+/**
+ * Tells the CPU, that the thread spins
+ */
+static inline void spin_pause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+/**
+ * Returns the next number of a xorshift64 generator
+ *
+ * @param state State of the generator, not 0
+ * @return The next number
+ */
+static inline unsigned long long next_random(unsigned long long& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+taskpool::taskpool(unsigned int thread_count, ttracker_t* ttracker,
+    unsigned int ttracker_tid)
+    : thread_count_(thread_count), pending_tasks_(0), sleeping_threads_(0),
+        should_terminate_(false), should_finish_(false),
+        ttracker_(ttracker), ttracker_tid_(ttracker_tid)
 {
     threads_.resize(thread_count_);
+
+    for (unsigned int i = 0; i <= thread_count_; ++i)
+    {
+        deques_.push_back(std::make_unique<work_deque>());
+        arenas_.push_back(std::make_unique<task_arena>());
+    }
 }
 
 void taskpool::start()
 {
     for (unsigned int i = 0; i < thread_count_; ++i)
     {
-        threads_[i] = std::thread(&taskpool::worker_thread, this);
+        threads_[i] = std::thread(&taskpool::worker_thread, this, i + 1);
     }
 }
 
 void taskpool::stop()
 {
-    /* Scope for locking and unlocking mutex */
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        should_terminate_ = true;
-    }
-
-    condition_.notify_all();
+    should_terminate_.store(true);
+    wake_all();
 
     for (std::thread& thread : threads_)
     {
@@ -42,13 +82,8 @@ void taskpool::stop()
 
 void taskpool::wait_until_finished()
 {
-    /* Scope for locking and unlocking mutex */
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        should_finish_ = true;
-    }
-
-    condition_.notify_all();
+    should_finish_.store(true);
+    wake_all();
 
     for (std::thread& thread : threads_)
     {
@@ -60,16 +95,10 @@ void taskpool::wait_until_finished()
 
 void taskpool::work_until_finished()
 {
-    /* Scope for locking and unlocking mutex */
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        ++working_threads_;
-        should_finish_ = true;
-    }
-
-    condition_.notify_all();
+    should_finish_.store(true);
+    wake_all();
 
-    worker_thread(); // Caller also works
+    worker_thread(0); // Caller also works
 
     for (std::thread& thread : threads_)
     {
@@ -79,64 +108,173 @@ void taskpool::work_until_finished()
     threads_.clear();
 }
 
-void taskpool::put(const std::function<void()>& func)
+unsigned int taskpool::current_thread_index() const
 {
-    /* Scope for locking and unlocking mutex */
+    return current_taskpool == this ? current_index : 0;
+}
+
+void taskpool::push(unsigned int index, task* new_task)
+{
+    pending_tasks_.fetch_add(1, std::memory_order_relaxed);
+    deques_[index]->push(new_task);
+
+    // Pairs with the fence in wait_for_task, so no wakeup is lost
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (sleeping_threads_.load(std::memory_order_relaxed) > 0)
     {
-        std::unique_lock<std::mutex> lock(mutex_);
-        tasks_.push(func);
+        /* Scope for locking and unlocking mutex */
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+        }
+
+        condition_.notify_one();
     }
-    
-    condition_.notify_one();
 }
 
-bool taskpool::should_do_something() const
+bool taskpool::should_exit() const
 {
-    return !tasks_.empty() || should_terminate_
-        || (should_finish_ && working_threads_ == 0);
+    return should_terminate_.load()
+        || (should_finish_.load() && pending_tasks_.load() == 0);
 }
 
-bool taskpool::should_finish_work() const
+bool taskpool::has_tasks() const
 {
-    return should_finish_ && working_threads_ == 0 && tasks_.empty();
+    for (const auto& deque : deques_)
+    {
+        if (deque->has_tasks())
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-void taskpool::worker_thread()
+task* taskpool::find_task(unsigned int thread_index,
+    unsigned long long& random)
 {
-    while (true)
+    task* found = deques_[thread_index]->take();
+
+    if (found != nullptr)
     {
-        std::function<void()> task;
+        return found;
+    }
 
-        /* Scope for locking and unlocking mutex */
+    unsigned int deque_count = deques_.size();
+    unsigned int victim = next_random(random) % deque_count;
+
+    for (unsigned int i = 0; i < deque_count; ++i, ++victim)
+    {
+        if (victim == deque_count)
         {
-            std::unique_lock<std::mutex> lock(mutex_);
-            --working_threads_;
+            victim = 0;
+        }
 
-            if (should_finish_work())
+        if (victim != thread_index)
+        {
+            found = deques_[victim]->steal();
+
+            if (found != nullptr)
             {
-                // Other threads can terminate
-                should_terminate_ = true;
+                return found;
+            }
+        }
+    }
+
+    return nullptr;
+}
 
-                lock.unlock();
+task* taskpool::wait_for_task(unsigned int thread_index,
+    unsigned long long& random)
+{
+    unsigned int rounds = 0;
 
-                // Notify threads, that might wait for last thread
-                condition_.notify_all();
+    while (!should_exit())
+    {
+        task* found = find_task(thread_index, random);
 
-                return;
-            }
+        if (found != nullptr)
+        {
+            return found;
+        }
 
-            condition_.wait(lock, [this]{return should_do_something();});
+        if (rounds < TASKPOOL_SPIN_ROUNDS)
+        {
+            spin_pause();
+        }
+        else if (rounds < TASKPOOL_SPIN_ROUNDS + TASKPOOL_YIELD_ROUNDS)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_threads_.fetch_add(1, std::memory_order_relaxed);
 
-            if (should_terminate_)
-            {
-                return;
-            }
+            // Pairs with the fence in push, so no wakeup is lost
+            std::atomic_thread_fence(std::memory_order_seq_cst);
 
-            task = tasks_.front();
-            tasks_.pop();
-            ++working_threads_;
+            condition_.wait(lock, [this]{
+                return has_tasks() || should_exit();
+            });
+
+            sleeping_threads_.fetch_sub(1, std::memory_order_relaxed);
+            rounds = 0;
+            continue;
         }
 
-        task();
+        ++rounds;
     }
+
+    return nullptr;
+}
+
+void taskpool::wake_all()
+{
+    /* Scope for locking and unlocking mutex */
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+    }
+
+    condition_.notify_all();
+}
+
+void taskpool::worker_thread(unsigned int thread_index)
+{
+    ttracker_pin_thread(thread_index);
+
+    current_taskpool = this;
+    current_index = thread_index;
+    unsigned long long random = 0x9E3779B97F4A7C15ULL * (thread_index + 1);
+
+    while (true)
+    {
+        ttracker_wait_begin(ttracker_, thread_index, ttracker_tid_);
+        task* next_task = wait_for_task(thread_index, random);
+        ttracker_wait_end(ttracker_, thread_index, ttracker_tid_);
+
+        if (next_task == nullptr)
+        {
+            break;
+        }
+
+        ttracker_thread_start(ttracker_, thread_index, ttracker_tid_);
+        ttracker_span_begin(ttracker_, "task", -1);
+        (*next_task)();
+        ttracker_span_end(ttracker_);
+        ttracker_thread_stop(ttracker_, thread_index, ttracker_tid_);
+
+        // The task might come from another arena, it is reused by this one
+        arenas_[thread_index]->free(next_task);
+
+        if (pending_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1
+            && should_finish_.load())
+        {
+            // Last task, the other threads can exit
+            wake_all();
+        }
+    }
+
+    current_taskpool = nullptr;
 }
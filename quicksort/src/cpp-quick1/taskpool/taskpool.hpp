@@ -1,16 +1,30 @@
 #ifndef TASKPOOL_HPP
 #define TASKPOOL_HPP
 
+#include <atomic>
 #include <mutex>
-#include <queue>
 #include <memory>
 #include <thread>
 #include <vector>
-#include <functional>
 #include <condition_variable>
 
+#include <ttracker.h>
+
+#include "task.hpp"
+#include "work_deque.hpp"
+
+/* Defines for idle threads */
+#define TASKPOOL_SPIN_ROUNDS  64 ///< Steal attempts with a pause in between
+#define TASKPOOL_YIELD_ROUNDS 16 ///< Steal attempts with a yield in between
+
 /**
- * This class represents a simple taskpool
+ * This class represents a work-stealing taskpool. Every thread has its own
+ * deque: new tasks are pushed onto the deque of the thread, which takes
+ * them back newest first. Idle threads steal the oldest tasks from the
+ * deques of randomly chosen threads. If there is nothing to steal, they
+ * spin, then yield and finally sleep until new tasks are put. Tasks are
+ * stored inline and recycled by per-thread arenas, so putting a task
+ * doesn't allocate memory after the first blocks of tasks
  */
 class taskpool
 {
@@ -18,8 +32,11 @@ public:
     /**
      * Initializes the taskpool with the number of worker threads
      * @param thread_count The thread count
+     * @param ttracker Tracker for the per-thread busy times (optional)
+     * @param ttracker_tid Event index of the busy times
      */
-    taskpool(unsigned int thread_count);
+    taskpool(unsigned int thread_count, ttracker_t* ttracker = nullptr,
+        unsigned int ttracker_tid = 0);
 
     /**
      * Starts the taskpool. Worker threads are waiting for new tasks
@@ -42,12 +59,21 @@ public:
     void work_until_finished();
 
     /**
-     * Inserts a new task into the task queue
+     * Inserts a new task into the deque of the calling thread. Threads
+     * outside the taskpool use the deque of index 0, so only the thread,
+     * that calls work_until_finished or wait_until_finished, may put tasks
+     * from outside
      *
-     * @param func Function to insert into queue
-     * @param args Arguments of the function
+     * @param func Function to insert into queue, see task::assign
      */
-    void put(const std::function<void()>& func);
+    template<typename F>
+    void put(const F& func)
+    {
+        unsigned int index = current_thread_index();
+        task* new_task = arenas_[index]->allocate();
+        new_task->assign(func);
+        push(index, new_task);
+    }
 
 private:
     /**
@@ -56,27 +82,42 @@ private:
     const unsigned int thread_count_;
 
     /**
-     * Number of currently working threads
+     * Number of tasks, that were put, but are not finished yet
      */
-    unsigned int working_threads_;
+    std::atomic<unsigned long long> pending_tasks_;
+
+    /**
+     * Number of threads, that sleep or are about to
+     */
+    std::atomic<unsigned int> sleeping_threads_;
 
     /**
      * Threads should terminate
      */
-    bool should_terminate_ = false;
+    std::atomic<bool> should_terminate_;
+
+    /**
+     * Threads should finish the work (deques), then terminate
+     */
+    std::atomic<bool> should_finish_;
 
     /**
-     * Threads should finish the work (queue), then terminate
+     * Tracker for the per-thread busy times
      */
-    bool should_finish_ = false;
+    ttracker_t* ttracker_;
 
     /**
-     * Mutex for the queue
+     * Event index of the busy times
+     */
+    const unsigned int ttracker_tid_;
+
+    /**
+     * Mutex for sleeping threads
      */
     std::mutex mutex_;
 
     /**
-     * Conditonal variable for the mutex
+     * Conditonal variable for sleeping threads
      */
     std::condition_variable condition_;
 
@@ -86,28 +127,77 @@ private:
     std::vector<std::thread> threads_;
 
     /**
-     * Queue of tasks for the worker threads
+     * Deques of the threads. The caller has index 0
      */
-    std::queue<std::function<void()>> tasks_;
+    std::vector<std::unique_ptr<work_deque>> deques_;
 
     /**
-     * Checks, if a thread should do something
-     * Assumes, that mutex_ is locked by caller
+     * Task arenas of the threads. The caller has index 0
      */
-    bool should_do_something() const;
+    std::vector<std::unique_ptr<task_arena>> arenas_;
 
     /**
-     * Checks, if the thread should exit when should_finish_ is true
-     * Assumes, that mutex_ is locked by caller
+     * Returns the index of the calling thread. Threads outside the taskpool
+     * get index 0
+     *
+     * @return The index
      */
-    bool should_finish_work() const;
+    unsigned int current_thread_index() const;
 
     /**
-     * Waits for new tasks and executes them.
+     * Pushes a task onto the deque of the calling thread and wakes a
+     * sleeping thread
+     *
+     * @param index Index of the calling thread
+     * @param new_task Task to push
+     */
+    void push(unsigned int index, task* new_task);
+
+    /**
+     * Checks, if a thread should exit
+     */
+    bool should_exit() const;
+
+    /**
+     * Checks, if a deque seems to contain tasks
+     */
+    bool has_tasks() const;
+
+    /**
+     * Takes a task from the own deque or steals one from another deque,
+     * starting at a random one
+     *
+     * @param thread_index Index of the thread
+     * @param random State of the random generator of the thread
+     * @return The task or nullptr
+     */
+    task* find_task(unsigned int thread_index,
+        unsigned long long& random);
+
+    /**
+     * Waits for a task and takes it. Spins and yields before the thread
+     * sleeps on condition_
+     *
+     * @param thread_index Index of the thread
+     * @param random State of the random generator of the thread
+     * @return The task or nullptr, if the thread should exit
+     */
+    task* wait_for_task(unsigned int thread_index,
+        unsigned long long& random);
+
+    /**
+     * Wakes all sleeping threads
+     */
+    void wake_all();
+
+    /**
+     * Executes tasks, until the thread should exit.
      * Exits, if should_terminate_ is true.
      * Finishes the work and exits, if should_finish_ is true
+     *
+     * @param thread_index Index of the thread. The caller has index 0
      */
-    void worker_thread();
+    void worker_thread(unsigned int thread_index);
 };
 
 #endif
@@ -1,58 +1,458 @@
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <ttracker.h>
 
 #include "file_utils.h"
 
-char* read_file(const char* filename)
+/**
+ * Reads the file into the free buffers of the ring, until the end of the
+ * file is reached or the stream is stopped
+ *
+ * @param thread_args The stream
+ * @return NULL
+ */
+static void* file_stream_reader_thread(void* thread_args)
+{
+    file_stream_t* stream = (file_stream_t*) thread_args;
+
+    /* Don't share the CPU of the pinned thread, which parses the buffers */
+    ttracker_unpin_thread();
+
+    pthread_mutex_lock(&stream->mutex);
+
+    while (!stream->finished && !stream->stopped)
+    {
+        if (stream->filled_count == FILE_STREAM_BUFFER_COUNT)
+        {
+            pthread_cond_wait(&stream->cond, &stream->mutex);
+            continue;
+        }
+
+        unsigned int index = stream->read_index;
+        pthread_mutex_unlock(&stream->mutex);
+
+        /* Fill the whole buffer, unless the file ends before */
+        char* buffer = stream->buffers[index] + FILE_STREAM_CARRY_SIZE;
+        size_t length = 0;
+        int error = FILE_SUCCESS;
+
+        while (length < stream->buffer_size)
+        {
+            ssize_t count = read(stream->fd, buffer + length,
+                stream->buffer_size - length);
+
+            if (count == -1 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (count <= 0)
+            {
+                error = count == 0 ? FILE_SUCCESS : FILE_FAILURE;
+                break;
+            }
+
+            length += count;
+        }
+
+        pthread_mutex_lock(&stream->mutex);
+
+        if (length > 0)
+        {
+            stream->lengths[index] = length;
+            stream->read_index = (index + 1) % FILE_STREAM_BUFFER_COUNT;
+            ++stream->filled_count;
+        }
+
+        stream->error = error;
+        stream->finished = length < stream->buffer_size;
+        pthread_cond_broadcast(&stream->cond);
+    }
+
+    pthread_mutex_unlock(&stream->mutex);
+
+    return NULL;
+}
+
+/**
+ * Gives the buffer of the current segment back to the reader thread
+ *
+ * @param stream The stream
+ */
+static void file_stream_release(file_stream_t* stream)
+{
+    if (!stream->holding)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&stream->mutex);
+    --stream->filled_count;
+    stream->parse_index = (stream->parse_index + 1) % FILE_STREAM_BUFFER_COUNT;
+    stream->holding = 0;
+    pthread_cond_broadcast(&stream->cond);
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+/**
+ * Grows the carry of a stream
+ *
+ * @param stream The stream
+ * @param capacity Needed capacity in bytes
+ * @return FILE_SUCCESS, if successful
+ */
+static int file_stream_reserve(file_stream_t* stream, size_t capacity)
+{
+    if (capacity <= stream->carry_capacity)
+    {
+        return FILE_SUCCESS;
+    }
+
+    char* carry = (char*) realloc(stream->carry, capacity);
+
+    if (carry == NULL)
+    {
+        return FILE_FAILURE;
+    }
+
+    stream->carry = carry;
+    stream->carry_capacity = capacity;
+
+    return FILE_SUCCESS;
+}
+
+/**
+ * Copies the incomplete rest of a segment into the carry
+ *
+ * @param stream The stream
+ * @param start First char of the rest, may be inside the carry
+ * @param end End of the rest
+ * @return FILE_SUCCESS, if successful
+ */
+static int file_stream_carry(file_stream_t* stream, const char* start,
+    const char* end)
+{
+    size_t length = end - start;
+
+    /* A rest inside the carry always fits, so it is never reallocated */
+    if (file_stream_reserve(stream, length))
+    {
+        return FILE_FAILURE;
+    }
+
+    if (length > 0)
+    {
+        memmove(stream->carry, start, length);
+    }
+
+    stream->carry_length = length;
+
+    return FILE_SUCCESS;
+}
+
+/**
+ * Frees the buffers of a stream and closes its file
+ *
+ * @param stream The stream
+ */
+static void file_stream_free(file_stream_t* stream)
+{
+    for (unsigned int i = 0; i < FILE_STREAM_BUFFER_COUNT; ++i)
+    {
+        free(stream->buffers[i]);
+        stream->buffers[i] = NULL;
+    }
+
+    free(stream->carry);
+    stream->carry = NULL;
+    close(stream->fd);
+}
+
+int open_file_stream(const char* filename, file_stream_t* stream)
+{
+    stream->fd = open(filename, O_RDONLY);
+
+    if (stream->fd == -1)
+    {
+        return FILE_FAILURE;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(stream->fd, &file_stat) == -1)
+    {
+        close(stream->fd);
+        return FILE_FAILURE;
+    }
+
+    stream->file_size = file_stat.st_size > 0 ? file_stat.st_size : 0;
+
+    /* Small files don't need full buffers, empty ones get a page */
+    size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    stream->buffer_size = FILE_STREAM_BUFFER_SIZE;
+
+    if (stream->file_size < stream->buffer_size)
+    {
+        stream->buffer_size = stream->file_size > page_size
+            ? stream->file_size : page_size;
+    }
+
+    /* The file is read once from start to end */
+    posix_fadvise(stream->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    stream->filled_count = 0;
+    stream->read_index = 0;
+    stream->parse_index = 0;
+    stream->holding = 0;
+    stream->finished = 0;
+    stream->stopped = 0;
+    stream->error = FILE_SUCCESS;
+    stream->carry = (char*) malloc(FILE_STREAM_CARRY_SIZE);
+    stream->carry_length = 0;
+    stream->carry_capacity = FILE_STREAM_CARRY_SIZE;
+    stream->rest = NULL;
+    stream->rest_end = NULL;
+    int error = stream->carry == NULL;
+
+    for (unsigned int i = 0; i < FILE_STREAM_BUFFER_COUNT; ++i)
+    {
+        stream->buffers[i] = (char*) malloc(
+            FILE_STREAM_CARRY_SIZE + stream->buffer_size);
+        error |= stream->buffers[i] == NULL;
+    }
+
+    if (error)
+    {
+        file_stream_free(stream);
+        return FILE_FAILURE;
+    }
+
+    pthread_mutex_init(&stream->mutex, NULL);
+    pthread_cond_init(&stream->cond, NULL);
+
+    if (pthread_create(&stream->reader, NULL, file_stream_reader_thread,
+        (void*) stream))
+    {
+        pthread_cond_destroy(&stream->cond);
+        pthread_mutex_destroy(&stream->mutex);
+        file_stream_free(stream);
+        return FILE_FAILURE;
+    }
+
+    return FILE_SUCCESS;
+}
+
+int next_file_segment(file_stream_t* stream, file_split_t split,
+    const char** segment, size_t* length)
+{
+    /* The rest of the previous segment is carried over */
+    if (file_stream_carry(stream, stream->rest, stream->rest_end))
+    {
+        return FILE_FAILURE;
+    }
+
+    file_stream_release(stream);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&stream->mutex);
+
+        while (stream->filled_count == 0 && !stream->finished)
+        {
+            pthread_cond_wait(&stream->cond, &stream->mutex);
+        }
+
+        int filled = stream->filled_count > 0;
+        int error = stream->error;
+        pthread_mutex_unlock(&stream->mutex);
+
+        if (error)
+        {
+            return FILE_FAILURE;
+        }
+
+        if (!filled)
+        {
+            /* The end of the file completes the carry */
+            *segment = stream->carry;
+            *length = stream->carry_length;
+            stream->rest = stream->carry + stream->carry_length;
+            stream->rest_end = stream->rest;
+
+            return FILE_SUCCESS;
+        }
+
+        char* data = stream->buffers[stream->parse_index]
+            + FILE_STREAM_CARRY_SIZE;
+        size_t data_length = stream->lengths[stream->parse_index];
+        size_t carry_length = stream->carry_length;
+        char* start;
+        stream->holding = 1;
+
+        if (carry_length <= FILE_STREAM_CARRY_SIZE)
+        {
+            /* Short carries are put directly in front of the data */
+            start = data - carry_length;
+            memcpy(start, stream->carry, carry_length);
+        }
+        else
+        {
+            /* Long carries are extended by the data instead */
+            if (file_stream_reserve(stream, carry_length + data_length))
+            {
+                return FILE_FAILURE;
+            }
+
+            memcpy(stream->carry + carry_length, data, data_length);
+            file_stream_release(stream);
+            start = stream->carry;
+        }
+
+        const char* end = start + carry_length + data_length;
+        const char* rest = split(start, end);
+
+        if (rest > start)
+        {
+            *segment = start;
+            *length = rest - start;
+            stream->rest = rest;
+            stream->rest_end = end;
+
+            return FILE_SUCCESS;
+        }
+
+        /* Nothing is complete yet, so all of it is carried over */
+        if (file_stream_carry(stream, start, end))
+        {
+            return FILE_FAILURE;
+        }
+
+        file_stream_release(stream);
+    }
+}
+
+void close_file_stream(file_stream_t* stream)
 {
-    /* Open a file */
+    pthread_mutex_lock(&stream->mutex);
+    stream->stopped = 1;
+    pthread_cond_broadcast(&stream->cond);
+    pthread_mutex_unlock(&stream->mutex);
+
+    pthread_join(stream->reader, NULL);
+    pthread_cond_destroy(&stream->cond);
+    pthread_mutex_destroy(&stream->mutex);
+    file_stream_free(stream);
+}
+
+int is_array_file(const char* filename)
+{
+    char magic[ARRAY_FILE_MAGIC_SIZE];
     FILE* fp = fopen(filename, "r");
 
     if (fp == NULL)
     {
-        return NULL;
+        return 0;
     }
 
-    /* Check file size */
-    if (fseek(fp, 0L, SEEK_END))
+    size_t read = fread(magic, 1, ARRAY_FILE_MAGIC_SIZE, fp);
+    fclose(fp);
+
+    return read == ARRAY_FILE_MAGIC_SIZE
+        && memcmp(magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE) == 0;
+}
+
+int map_array_file(const char* filename, array_file_t* file)
+{
+    file->mapping = NULL;
+    file->mapping_size = 0;
+
+    int fd = open(filename, O_RDONLY);
+
+    if (fd == -1)
     {
-        fclose(fp);
-        return NULL;
+        return FILE_FAILURE;
     }
 
-    long int file_size = ftell(fp);
+    struct stat file_stat;
 
-    if (file_size == -1L)
+    if (fstat(fd, &file_stat) == -1
+        || (size_t) file_stat.st_size < sizeof(array_file_header_t))
     {
-        fclose(fp);
-        return NULL;
+        close(fd);
+        return FILE_FAILURE;
     }
 
-    if (fseek(fp, 0L, SEEK_SET))
+    /* Private & writable: Sorting in place doesn't change the file */
+    void* mapping = mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
     {
-        fclose(fp);
-        return NULL;
+        return FILE_FAILURE;
     }
 
-    /* Read file into memory */
-    char* str = (char*) malloc(sizeof(char) * (file_size + 1));
+    const array_file_header_t* header = (const array_file_header_t*) mapping;
+    size_t data_size = file_stat.st_size - ARRAY_FILE_HEADER_SIZE;
 
-    if (str == NULL)
+    if (memcmp(header->magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE) != 0
+        || (header->element_size != 4 && header->element_size != 8)
+        || header->count > data_size / header->element_size)
     {
-        fclose(fp);
-        return NULL;
+        munmap(mapping, file_stat.st_size);
+        return FILE_FAILURE;
     }
 
-    if(!fread(str, file_size, 1, fp))
+    /* The elements are read once from start to end */
+    madvise(mapping, file_stat.st_size, MADV_SEQUENTIAL);
+
+    file->mapping = mapping;
+    file->mapping_size = file_stat.st_size;
+    file->data = (char*) mapping + ARRAY_FILE_HEADER_SIZE;
+    file->element_size = header->element_size;
+    file->count = header->count;
+    file->max_value = header->max_value;
+
+    return FILE_SUCCESS;
+}
+
+int write_array_cache(const char* filename, const unsigned long* array,
+    unsigned long long length)
+{
+    array_file_header_t header = {0};
+    memcpy(header.magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE);
+    header.element_size = sizeof(unsigned long);
+    header.count = length;
+
+    for (unsigned long long i = 0; i < length; ++i)
     {
-        fclose(fp);
-        free(str);
-        return NULL;
+        header.max_value = array[i] > header.max_value
+            ? array[i] : header.max_value;
     }
 
-    fclose(fp);
+    input_cache_part_t part = { array, length * sizeof(unsigned long) };
+
+    return input_cache_write(filename, ARRAY_CACHE_SUFFIX, &header, &part, 1)
+        ? FILE_FAILURE : FILE_SUCCESS;
+}
 
-    str[file_size] = 0; // String terminator
+void unmap_array_file(array_file_t* file)
+{
+    if (file->mapping != NULL)
+    {
+        munmap(file->mapping, file->mapping_size);
+    }
 
-    return str;
+    file->mapping = NULL;
+    file->mapping_size = 0;
+    file->data = NULL;
+    file->count = 0;
 }
@@ -4,39 +4,196 @@
 #include <iterator>
 
 #include "../taskpool/taskpool.hpp"
+#include "small_sort.hpp"
+
+/**
+ * Ranges below the cutoff are sorted sequentially
+ */
+static size_t sort_cutoff = SORT_DEFAULT_CUTOFF;
 
 const char* sort_parser_exception::what() const noexcept
 {
     return "Could not parse numbers array!";
 }
 
-void sort(std::vector<unsigned long>& vector, const unsigned int thread_count)
+const char* sort_file_exception::what() const noexcept
+{
+    return "Could not read array_file!";
+}
+
+/**
+ * Returns the median of three elements
+ */
+static unsigned long median_of_three(unsigned long a, unsigned long b,
+    unsigned long c)
+{
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+/**
+ * Selects the pivot of a range as the median of the medians of three
+ * samples each from its start, middle and end (ninther)
+ *
+ * @param data First element of the range
+ * @param count Number of elements (at least 1)
+ * @return The pivot
+ */
+static unsigned long select_pivot(const unsigned long* data, size_t count)
+{
+    auto step = count / 8;
+    auto middle = count / 2;
+    auto last = count - 1;
+
+    if (step == 0)
+    {
+        return median_of_three(data[0], data[middle], data[last]);
+    }
+
+    return median_of_three(
+        median_of_three(data[0], data[step], data[2 * step]),
+        median_of_three(data[middle - step], data[middle], data[middle + step]),
+        median_of_three(data[last - 2 * step], data[last - step], data[last])
+    );
+}
+
+/**
+ * Swaps the samples of select_pivot with other elements of the range. The
+ * positions are taken from a xorshift generator seeded with the size of
+ * the range, so the shuffle is deterministic
+ *
+ * @param first First element
+ * @param last End of the range
+ */
+static void break_patterns(std::vector<unsigned long>::iterator first,
+    std::vector<unsigned long>::iterator last)
+{
+    size_t count = std::distance(first, last);
+
+    if (count < 2)
+    {
+        return;
+    }
+
+    auto step = count / 8;
+    auto middle = count / 2;
+    size_t samples[] = {
+        0, step, 2 * step,
+        middle - step, middle, middle + step,
+        count - 1 - 2 * step, count - 1 - step, count - 1
+    };
+    unsigned long long state = count;
+
+    for (auto sample : samples)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::iter_swap(first + sample, first + state % count);
+    }
+}
+
+/**
+ * Checks with a linear scan, whether the vector is sorted already. A
+ * vector sorted in descending order is reversed
+ *
+ * @param vector The vector to check
+ * @return The vector is sorted now
+ */
+static bool sort_presorted(std::vector<unsigned long>& vector)
+{
+    if (std::is_sorted(vector.begin(), vector.end()))
+    {
+        return true;
+    }
+
+    if (std::is_sorted(vector.rbegin(), vector.rend()))
+    {
+        std::reverse(vector.begin(), vector.end());
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Computes the depth limit of a vector, 2 * log2(n) partition steps
+ *
+ * @param size Elements of the vector
+ * @return The depth limit
+ */
+static unsigned int sort_depth_limit(size_t size)
+{
+    unsigned int depth_limit = 0;
+
+    while (size > 0)
+    {
+        size >>= 1;
+        depth_limit += 2;
+    }
+
+    return depth_limit;
+}
+
+void sort(std::vector<unsigned long>& vector, const unsigned int thread_count,
+    ttracker_t* ttracker, unsigned int ttracker_tid)
 {
     if (thread_count <= 1)
     {
+        ttracker_thread_start(ttracker, 0, ttracker_tid);
+        ttracker_span_begin(ttracker, "sort", -1);
         std::sort(vector.begin(), vector.end());
+        ttracker_span_end(ttracker);
+        ttracker_thread_stop(ttracker, 0, ttracker_tid);
     }
     else
     {
-        taskpool tasks(thread_count - 1);
+        ttracker_thread_start(ttracker, 0, ttracker_tid);
+        bool sorted = sort_presorted(vector);
+        ttracker_thread_stop(ttracker, 0, ttracker_tid);
+
+        if (sorted)
+        {
+            return;
+        }
+
+        sort_cutoff = small_sort_cutoff(SORT_DEFAULT_CUTOFF);
+        taskpool tasks(thread_count - 1, ttracker, ttracker_tid);
         tasks.start();
-        sort_parallel(vector.begin(), vector.end(), tasks);
+        sort_parallel(vector.begin(), vector.end(), tasks,
+            sort_depth_limit(vector.size()));
         tasks.work_until_finished();
     }
 }
 
 void sort_parallel(std::vector<unsigned long>::iterator first,
-    std::vector<unsigned long>::iterator last, taskpool& tasks)
+    std::vector<unsigned long>::iterator last, taskpool& tasks,
+    unsigned int depth_limit)
 {
     auto distance = std::distance(first, last);
 
-    if (distance < 100)
+    if (static_cast<size_t>(distance) < sort_cutoff)
     {
-        std::sort(first, last);
+        if (distance > SMALL_SORT_MAX)
+        {
+            std::sort(first, last);
+        }
+        else if (distance > 1)
+        {
+            small_sort(&*first, distance);
+        }
+
         return;
     }
 
-    auto pivot = *std::next(first, distance / 2);
+    if (depth_limit == 0)
+    {
+        // Heapsort keeps the worst case at O(n log n)
+        std::make_heap(first, last);
+        std::sort_heap(first, last);
+        return;
+    }
+
+    auto pivot = select_pivot(&*first, distance);
 
     auto middle1 = std::partition(first, last, [pivot](const auto& em)
     {
@@ -48,11 +205,24 @@ void sort_parallel(std::vector<unsigned long>::iterator first,
         return !(pivot < em);
     });
 
+    // An unbalanced partition hints at a pattern in the input, which is
+    // broken up before the next pivots are selected
+    auto larger = std::max(std::distance(first, middle1),
+        std::distance(middle2, last));
+
+    if (larger > distance - distance / SORT_UNBALANCED_RATIO)
+    {
+        break_patterns(first, middle1);
+        break_patterns(middle2, last);
+    }
+
+    --depth_limit;
+
     // Put right side in taskpool
-    tasks.put([middle2, last, &tasks]() {
-        sort_parallel(middle2, last, tasks);
+    tasks.put([middle2, last, &tasks, depth_limit]() {
+        sort_parallel(middle2, last, tasks, depth_limit);
     });
 
     // Work on left side
-    sort_parallel(first, middle1, tasks);
+    sort_parallel(first, middle1, tasks, depth_limit);
 }
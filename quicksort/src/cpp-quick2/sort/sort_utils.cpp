@@ -1,82 +1,309 @@
 #include "sort_utils.hpp"
 
+#include <climits>
+#include <functional>
 #include <memory>
-#include <cstdlib>
-#include <cstring>
+#include <thread>
+
+#ifdef __SSE4_1__
+#include <immintrin.h>
+#endif
+
+#include <ttracker.h>
 
 #include "sort.hpp"
+#include "../file/file_utils.h"
 
-unsigned long long sort_check_and_parse_length(
-    const std::shared_ptr<char> array_string)
+/**
+ * Parses a number and the following ',' or '\n' digit by digit
+ *
+ * @param position First char of the number
+ * @param end End of the string
+ * @param number The parsed number
+ * @return Position after the delimiter or nullptr, if the string is invalid
+ */
+static const char* sort_parse_number_scalar(const char* position,
+    const char* end, unsigned long& number)
 {
-    const char* string = array_string.get();
+    const char* start = position;
+    unsigned long value = 0;
 
-    char token;
-    char expected_token = TOKEN_NUMBER;
-    unsigned long long length = 0;
+    while (position < end && *position >= '0' && *position <= '9')
+    {
+        unsigned long digit = *position - '0';
 
-    while ((token = *(string++)))
+        if (value > (ULONG_MAX - digit) / 10)
+        {
+            return nullptr; // Overflow
+        }
+
+        value = value * 10 + digit;
+        ++position;
+    }
+
+    if (position == start)
+    {
+        return nullptr;
+    }
+
+    // The last number doesn't need a delimiter
+    if (position < end)
     {
-        switch (token)
+        if (*position != ',' && *position != '\n')
         {
-        case ',': case '\n':
-            if (!(expected_token & TOKEN_BREAK))
+            return nullptr;
+        }
+
+        ++position;
+    }
+
+    number = value;
+    return position;
+}
+
+/**
+ * Parses a number and the following ',' or '\n'. Numbers with less than
+ * 16 digits are found with a vector compare and converted with
+ * multiply-adds, if at least 16 chars are left
+ *
+ * @param position First char of the number
+ * @param end End of the string
+ * @param number The parsed number
+ * @return Position after the delimiter or nullptr, if the string is invalid
+ */
+static inline const char* sort_parse_number(const char* position,
+    const char* end, unsigned long& number)
+{
+#ifdef __SSE4_1__
+    if (end - position >= SORT_SIMD_WIDTH)
+    {
+        __m128i chars = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(position));
+        __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+
+        // Digits are the bytes in [0; 9] after subtracting '0'
+        __m128i is_digit = _mm_cmpeq_epi8(
+            _mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+        unsigned int non_digits = ~_mm_movemask_epi8(is_digit) & 0xFFFF;
+
+        if (non_digits != 0)
+        {
+            int count = __builtin_ctz(non_digits);
+            char delimiter = position[count];
+
+            if (count == 0 || (delimiter != ',' && delimiter != '\n'))
             {
-                throw sort_parser_exception();
+                return nullptr;
             }
 
-            ++length;
-            expected_token = TOKEN_NUMBER;
-            break;
+            // Move the digits to the end, the other bytes become 0
+            __m128i shuffle = _mm_add_epi8(
+                _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                    8, 9, 10, 11, 12, 13, 14, 15),
+                _mm_set1_epi8(count - SORT_SIMD_WIDTH));
+            digits = _mm_shuffle_epi8(digits, shuffle);
+
+            // Combine 2, 4 and 8 digits
+            __m128i pairs = _mm_maddubs_epi16(digits,
+                _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                    10, 1, 10, 1, 10, 1, 10, 1));
+            __m128i quads = _mm_madd_epi16(pairs,
+                _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+            quads = _mm_packus_epi32(quads, quads);
+            __m128i octets = _mm_madd_epi16(quads,
+                _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+            number = static_cast<unsigned long>(_mm_cvtsi128_si32(octets))
+                * 100000000UL
+                + static_cast<unsigned long>(_mm_extract_epi32(octets, 1));
+
+            return position + count + 1;
+        }
+    }
+#endif
+
+    return sort_parse_number_scalar(position, end, number);
+}
+
+/**
+ * Checks whether a char separates two numbers
+ *
+ * @param token Char to check
+ * @return true, if the char is a delimiter
+ */
+static inline bool sort_is_delimiter(char token)
+{
+    return token == ',' || token == '\n';
+}
+
+/**
+ * Runs the worker function for every thread index. The main thread works
+ * as thread 0
+ *
+ * @param thread_count Number of threads
+ * @param worker Worker function, which gets the thread index
+ */
+static void sort_run_parse_threads(unsigned int thread_count,
+    const std::function<void(unsigned int)>& worker)
+{
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 1; i < thread_count; ++i)
+    {
+        threads.emplace_back([&worker, i]()
+        {
+            ttracker_pin_thread(i);
+            worker(i);
+        });
+    }
+
+    ttracker_pin_thread(0);
+    worker(0);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+const char* sort_split_segment(const char* start, const char* end)
+{
+    while (end > start && !sort_is_delimiter(end[-1]))
+    {
+        --end;
+    }
+
+    return end;
+}
+
+void sort_parse_numbers(const char* segment, size_t length,
+    std::vector<unsigned long>& vector, unsigned int thread_count)
+{
+    const char* end = segment + length;
+
+    // Split the segment into chunks, which start after a delimiter
+    std::vector<const char*> chunks(thread_count + 1, end);
+
+    for (unsigned int i = 1; i < thread_count; ++i)
+    {
+        const char* start = segment + length * i / thread_count;
+
+        while (start < end
+            && (start == segment || !sort_is_delimiter(start[-1])))
+        {
+            ++start;
+        }
+
+        chunks[i] = start;
+    }
+
+    chunks[0] = segment;
+
+    // Count the numbers of every chunk by its delimiters
+    std::vector<unsigned long long> offsets(thread_count + 1, 0);
+
+    sort_run_parse_threads(thread_count, [&](unsigned int i)
+    {
+        unsigned long long count = 0;
+
+        for (const char* position = chunks[i]; position < chunks[i + 1];
+            ++position)
+        {
+            count += sort_is_delimiter(*position);
+        }
+
+        // The last number doesn't need a delimiter
+        if (chunks[i + 1] > chunks[i] && !sort_is_delimiter(chunks[i + 1][-1]))
+        {
+            ++count;
+        }
+
+        offsets[i + 1] = count;
+    });
+
+    offsets[0] = vector.size();
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+
+    vector.resize(offsets[thread_count]);
+    std::vector<char> valid(thread_count, false);
+
+    // Each thread parses into the slice after the previous chunks
+    sort_run_parse_threads(thread_count, [&](unsigned int i)
+    {
+        const char* position = chunks[i];
+        unsigned long long index = offsets[i];
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            if (!(expected_token & TOKEN_NUMBER))
+        while (position < chunks[i + 1] && index < offsets[i + 1])
+        {
+            position = sort_parse_number(position, chunks[i + 1],
+                vector[index]);
+
+            if (position == nullptr)
             {
-                throw sort_parser_exception();
+                return;
             }
 
-            expected_token = TOKEN_NUMBER | TOKEN_BREAK;
-            break;
+            ++index;
+        }
+
+        valid[i] = position == chunks[i + 1] && index == offsets[i + 1];
+    });
 
-        default:
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        if (!valid[i])
+        {
             throw sort_parser_exception();
         }
     }
-
-    return length;
 }
 
-std::vector<unsigned long> sort_parse_numbers(unsigned long long vector_size,
-    const std::shared_ptr<char> array_string)
+std::vector<unsigned long> sort_read_numbers(const char* filename,
+    unsigned int thread_count)
 {
-    const char* string = array_string.get();
+    file_stream_t stream;
 
-    std::vector<unsigned long> vector;
-    vector.resize(vector_size);
+    if (open_file_stream(filename, &stream))
+    {
+        throw sort_file_exception();
+    }
+
+    // The stream is closed on errors as well
+    auto stream_guard = std::unique_ptr<file_stream_t,
+        void (*)(file_stream_t*)>(&stream, close_file_stream);
 
-    unsigned long long vector_index = 0;
-    int buffer_index = 0;
-    char num_buffer[SORT_BUFF_SIZE] = {0};
-    char token;
+    std::vector<unsigned long> vector;
+    unsigned long long parsed_length = 0;
+    const char* segment;
+    size_t length;
 
-    while ((token = *(string++)))
+    for (;;)
     {
-        switch (token)
+        if (next_file_segment(&stream, sort_split_segment, &segment, &length))
         {
-        case ',': case '\n':
-            vector[vector_index] = strtoul(num_buffer, NULL, SORT_PARSE_BASE);
-            memset(num_buffer, 0, buffer_index + 1);
-            buffer_index = 0;
-            ++vector_index;
-            break;
+            throw sort_file_exception();
+        }
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            num_buffer[buffer_index] = token;
-            ++buffer_index;
+        if (length == 0)
+        {
             break;
         }
+
+        sort_parse_numbers(segment, length, vector, thread_count);
+        parsed_length += length;
+
+        // Growing the vector copies it, so the final size is extrapolated
+        auto expected = static_cast<unsigned long long>(1.0625
+            * vector.size() * stream.file_size / parsed_length);
+
+        if (expected > vector.capacity())
+        {
+            vector.reserve(expected);
+        }
     }
 
     return vector;
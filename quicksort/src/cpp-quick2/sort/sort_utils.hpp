@@ -1,35 +1,48 @@
 #ifndef SORT_UTILS_HPP
 #define SORT_UTILS_HPP
 
-#include <memory>
+#include <cstddef>
 #include <vector>
 
 /* Defines for parsing */
-#define TOKEN_BREAK     0x01 ///< ',' or ' ' or '\n' is expected
-#define TOKEN_NUMBER    0x02 ///< A number is expected
-#define SORT_PARSE_BASE 0x0A ///< Use base 10 for converting numbers
+#define SORT_SIMD_WIDTH 16 ///< Bytes of a SIMD register for parsing
 
-/* Defines for sizes */
-#define SORT_BUFF_SIZE  0x20 ///< Buffer size for converting chars to nums
+/**
+ * Finds the end of the last complete number of a segment of the array file
+ *
+ * @param start First char of the segment
+ * @param end End of the segment
+ * @return Position after the last delimiter, start if there is none
+ */
+const char* sort_split_segment(const char* start, const char* end);
 
 /**
- * Checks the array_string and returns the array length
+ * Parses a segment of the array file and appends its numbers to the
+ * vector. The segment is split into one chunk per thread. The threads count
+ * the numbers of their chunks first and then parse them into their slices
+ * behind the numbers of the previous segments
  *
- * @param array_string Array as string
- * @throws sort_parser_exception, if the string couldn't be parsed
- * @return array length
+ * @param segment First char of the segment
+ * @param length Length of the segment
+ * @param vector The numbers vector
+ * @param thread_count Number of threads
+ * @throws sort_parser_exception, if the segment couldn't be parsed
  */
-unsigned long long sort_check_and_parse_length(
-    const std::shared_ptr<char> array_string);
+void sort_parse_numbers(const char* segment, size_t length,
+    std::vector<unsigned long>& vector, unsigned int thread_count);
 
 /**
- * Parses the array_string and creates a numbers vector
+ * Reads the array file with a file stream and parses each segment, while
+ * the next ones are read. Only the vector and the buffers of the stream are
+ * in memory, not the whole file
  *
- * @param vector_size The size of the created vector
- * @param array_string Array as string
+ * @param filename Name of the array file
+ * @param thread_count Number of threads
+ * @throws sort_file_exception, if the file couldn't be read
+ * @throws sort_parser_exception, if the file couldn't be parsed
  * @return Numbers vector
  */
-std::vector<unsigned long> sort_parse_numbers(unsigned long long vector_size,
-    const std::shared_ptr<char> array_string);
+std::vector<unsigned long> sort_read_numbers(const char* filename,
+    unsigned int thread_count);
 
 #endif
@@ -0,0 +1,122 @@
+#include "work_deque.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ * The memory orders follow "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013)
+ */
+
+work_deque::ring::ring(long long capacity)
+    : capacity(capacity), slots(new std::atomic<task_t*>[capacity])
+{
+}
+
+work_deque::task_t* work_deque::ring::get(long long index) const
+{
+    return slots[index & (capacity - 1)].load(std::memory_order_relaxed);
+}
+
+void work_deque::ring::put(long long index, task_t* new_task)
+{
+    slots[index & (capacity - 1)].store(new_task, std::memory_order_relaxed);
+}
+
+work_deque::work_deque()
+    : top_(0), bottom_(0)
+{
+    rings_.push_back(std::make_unique<ring>(WORK_DEQUE_CAPACITY));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+}
+
+void work_deque::push(task_t* new_task)
+{
+    long long bottom = bottom_.load(std::memory_order_relaxed);
+    long long top = top_.load(std::memory_order_acquire);
+    ring* current = ring_.load(std::memory_order_relaxed);
+
+    if (bottom - top > current->capacity - 1)
+    {
+        current = grow(current, top, bottom);
+    }
+
+    current->put(bottom, new_task);
+    bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+work_deque::task_t* work_deque::take()
+{
+    long long bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    ring* current = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // Deque is empty
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    task_t* found = current->get(bottom);
+
+    if (top == bottom)
+    {
+        // Last task, thieves might take it as well
+        if (!top_.compare_exchange_strong(top, top + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            found = nullptr;
+        }
+
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return found;
+}
+
+work_deque::task_t* work_deque::steal()
+{
+    long long top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long bottom = bottom_.load(std::memory_order_acquire);
+
+    if (top >= bottom)
+    {
+        return nullptr;
+    }
+
+    task_t* found = ring_.load(std::memory_order_acquire)->get(top);
+
+    if (!top_.compare_exchange_strong(top, top + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    return found;
+}
+
+bool work_deque::has_tasks() const
+{
+    return top_.load(std::memory_order_seq_cst)
+        < bottom_.load(std::memory_order_seq_cst);
+}
+
+work_deque::ring* work_deque::grow(ring* old, long long top, long long bottom)
+{
+    rings_.push_back(std::make_unique<ring>(old->capacity * 2));
+    ring* current = rings_.back().get();
+
+    for (long long i = top; i < bottom; ++i)
+    {
+        current->put(i, old->get(i));
+    }
+
+    ring_.store(current, std::memory_order_release);
+
+    return current;
+}
@@ -0,0 +1,113 @@
+#ifndef WORK_DEQUE_HPP
+#define WORK_DEQUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "task.hpp"
+
+/* Defines for the deque */
+#define WORK_DEQUE_CAPACITY 256 ///< Initial capacity, a power of 2
+#define WORK_DEQUE_LINE     64  ///< Bytes of a cache line
+
+/**
+ * This class represents a Chase-Lev work-stealing deque of tasks. Its owner
+ * pushes and takes tasks at the bottom (LIFO), other threads steal them at
+ * the top (FIFO). The array grows, if it is full. Old arrays are kept until
+ * the deque is destroyed, because thieves might still read them
+ */
+class work_deque
+{
+public:
+    using task_t = task;
+
+    work_deque();
+
+    work_deque(const work_deque&) = delete;
+    work_deque& operator=(const work_deque&) = delete;
+
+    /**
+     * Pushes a task at the bottom. Only called by the owner
+     *
+     * @param new_task Task to push
+     */
+    void push(task_t* new_task);
+
+    /**
+     * Takes the newest task from the bottom. Only called by the owner
+     *
+     * @return The task or nullptr
+     */
+    task_t* take();
+
+    /**
+     * Steals the oldest task from the top. Called by any thread
+     *
+     * @return The task or nullptr, if the deque is empty or another thread
+     *         got the task first
+     */
+    task_t* steal();
+
+    /**
+     * Checks, if the deque seems to contain tasks
+     *
+     * @return true, if it isn't empty
+     */
+    bool has_tasks() const;
+
+private:
+    /**
+     * Circular array of tasks
+     */
+    struct ring
+    {
+        explicit ring(long long capacity);
+
+        /**
+         * Number of slots, a power of 2
+         */
+        const long long capacity;
+
+        /**
+         * Slots of the tasks
+         */
+        std::unique_ptr<std::atomic<task_t*>[]> slots;
+
+        task_t* get(long long index) const;
+
+        void put(long long index, task_t* new_task);
+    };
+
+    /**
+     * Index of the oldest task, incremented by thieves
+     */
+    alignas(WORK_DEQUE_LINE) std::atomic<long long> top_;
+
+    /**
+     * Index after the newest task, changed by the owner
+     */
+    alignas(WORK_DEQUE_LINE) std::atomic<long long> bottom_;
+
+    /**
+     * Current array
+     */
+    std::atomic<ring*> ring_;
+
+    /**
+     * All arrays, the current one included. Only changed by the owner
+     */
+    std::vector<std::unique_ptr<ring>> rings_;
+
+    /**
+     * Replaces the array with one of twice the capacity
+     *
+     * @param old Current array
+     * @param top Index of the oldest task
+     * @param bottom Index after the newest task
+     * @return The new array
+     */
+    ring* grow(ring* old, long long top, long long bottom);
+};
+
+#endif
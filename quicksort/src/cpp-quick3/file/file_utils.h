@@ -1,13 +1,163 @@
 #ifndef FILE_UTILS_H
 #define FILE_UTILS_H
 
+#include <pthread.h>
+#include <stddef.h>
+
+#include "../../cache/input_cache.h"
+
+/* Defines for file return codes */
+#define FILE_SUCCESS 0x0 ///< Success
+#define FILE_FAILURE 0x1 ///< Failure
+
+/* Defines for file streams */
+#define FILE_STREAM_BUFFER_COUNT 3                  ///< Buffers of a stream
+#define FILE_STREAM_BUFFER_SIZE  (64 * 1024 * 1024) ///< Max bytes per read
+#define FILE_STREAM_CARRY_SIZE   4096               ///< Room for a carry
+
+/* Defines for binary array files */
+#define ARRAY_FILE_MAGIC       "DBARRAY1" ///< First bytes of the file
+#define ARRAY_FILE_MAGIC_SIZE  8          ///< Size of the magic in bytes
+#define ARRAY_FILE_HEADER_SIZE 64         ///< Offset of the first element
+#define ARRAY_CACHE_SUFFIX     ".dbin"    ///< Suffix of the sidecar files
+
+/**
+ * Header of a binary array file. The elements follow the header directly
+ * as little-endian unsigned integers of element_size bytes
+ */
+typedef struct _array_file_header_t
+{
+    char magic[ARRAY_FILE_MAGIC_SIZE]; ///< ARRAY_FILE_MAGIC
+    unsigned int element_size;         ///< Element size in bytes (4 or 8)
+    unsigned int flags;                ///< Reserved, always 0
+    unsigned long long count;          ///< Number of elements
+    unsigned long long max_value;      ///< Biggest element, 0 if unknown
+    unsigned long long reserved[4];    ///< Sidecar key or 0, pads to 64 bytes
+} array_file_header_t;
+
+/**
+ * A binary array file mapped into memory
+ */
+typedef struct _array_file_t
+{
+    void* mapping;                ///< Start of the mapped file
+    size_t mapping_size;          ///< Size of the mapping in bytes
+    void* data;                   ///< First element
+    unsigned int element_size;    ///< Element size in bytes (4 or 8)
+    unsigned long long count;     ///< Number of elements
+    unsigned long long max_value; ///< Biggest element, 0 if unknown
+} array_file_t;
+
+/**
+ * Finds the end of the complete part of a segment, e.g. after its last
+ * delimiter. The rest is incomplete and carried over to the next segment
+ *
+ * @param start First char of the segment
+ * @param end End of the segment
+ * @return End of the complete part, start if nothing is complete
+ */
+typedef const char* (*file_split_t)(const char* start, const char* end);
+
+/**
+ * A file, which is read by a reader thread into a ring of buffers, while
+ * the parser consumes the segments of the previous buffers. Every buffer has
+ * room for a carry in front, so a number split across two buffers becomes
+ * contiguous without copying the buffer
+ */
+typedef struct _file_stream_t
+{
+    int fd;                                   ///< Descriptor of the file
+    size_t file_size;                         ///< File size, 0 if unknown
+    size_t buffer_size;                       ///< Bytes per read
+    char* buffers[FILE_STREAM_BUFFER_COUNT];  ///< Ring of buffers
+    size_t lengths[FILE_STREAM_BUFFER_COUNT]; ///< Bytes read per buffer
+    unsigned int filled_count;                ///< Buffers not yet released
+    unsigned int read_index;                  ///< Next buffer to read into
+    unsigned int parse_index;                 ///< Next buffer to parse
+    int holding;                              ///< 1, if a buffer is parsed
+    int finished;                             ///< 1, if the file is read
+    int stopped;                              ///< 1, if the reader must stop
+    int error;                                ///< FILE_FAILURE on errors
+    char* carry;                              ///< Incomplete segment rest
+    size_t carry_length;                      ///< Length of the carry
+    size_t carry_capacity;                    ///< Capacity of the carry
+    const char* rest;                         ///< Rest of the segment
+    const char* rest_end;                     ///< End of the current segment
+    pthread_t reader;                         ///< Reader thread
+    pthread_mutex_t mutex;                    ///< Guards the ring state
+    pthread_cond_t cond;                      ///< Signals ring changes
+} file_stream_t;
+
+/**
+ * Opens a file stream and starts its reader thread. At most
+ * FILE_STREAM_BUFFER_COUNT buffers of up to FILE_STREAM_BUFFER_SIZE bytes
+ * are in memory, independent of the file size
+ *
+ * @param filename Name of the file
+ * @param stream The stream to open
+ * @return FILE_SUCCESS, if successful
+ */
+int open_file_stream(const char* filename, file_stream_t* stream);
+
+/**
+ * Returns the next segment of a file stream, which consists of the carry
+ * of the previous segment and the next buffer up to the end found by split.
+ * The segment is valid until the next call. The last segment is the final
+ * carry, which is not split
+ *
+ * @param stream The stream
+ * @param split Finds the end of the complete part of a segment
+ * @param segment First char of the segment
+ * @param length Length of the segment, 0 at the end of the file
+ * @return FILE_SUCCESS, if successful
+ */
+int next_file_segment(file_stream_t* stream, file_split_t split,
+    const char** segment, size_t* length);
+
+/**
+ * Stops the reader thread of a file stream and closes it
+ *
+ * @param stream The stream to close
+ */
+void close_file_stream(file_stream_t* stream);
+
+/**
+ * Checks whether a file starts with the magic of a binary array file
+ *
+ * @param filename Name of the file
+ * @return 1, if the file is a binary array file, else 0
+ */
+int is_array_file(const char* filename);
+
 /**
- * Reads a whole file into memory
+ * Maps a binary array file into memory. The mapping is private, so the
+ * elements can be sorted in place without changing the file
  *
  * @param filename Name of the file
- * @return On success: Pointer to a char array representing the file
- *         contents. On error: NULL
+ * @param file The mapped file
+ * @return FILE_SUCCESS, if successful
+ */
+int map_array_file(const char* filename, array_file_t* file);
+
+/**
+ * Writes the parsed elements of a text array file into its sidecar (see
+ * cache/input_cache.h), so that later runs map the sidecar instead of
+ * parsing the text. The elements are written directly, so this must be
+ * done before they are sorted
+ *
+ * @param filename Name of the text array file
+ * @param array The elements
+ * @param length Number of elements
+ * @return FILE_SUCCESS, if successful
+ */
+int write_array_cache(const char* filename, const unsigned long* array,
+    unsigned long long length);
+
+/**
+ * Unmaps a mapped binary array file
+ *
+ * @param file The mapped file
  */
-char* read_file(const char* filename);
+void unmap_array_file(array_file_t* file);
 
 #endif
@@ -0,0 +1,316 @@
+#include "small_sort.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512F__) && defined(__GNUC__) && !defined(__clang__)
+// GCC 12 warns about _mm512_undefined_epi32 in the intrinsics (PR 105593)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/*
+ * Every ISA provides a vector type of `width` elements with loads, stores,
+ * unsigned min and max. Vectors with more than one element also swap the
+ * elements at distance j (permute_xor) and blend the minimums and maximums
+ * with a lane mask (1 = maximum)
+ */
+
+#if defined(__AVX512F__)
+
+struct network_ops
+{
+    using vec = __m512i;
+    using mask = __mmask8;
+    static constexpr size_t width = 8;
+
+    static vec load(const unsigned long* data)
+    {
+        return _mm512_load_si512(data);
+    }
+
+    static void store(unsigned long* data, vec v)
+    {
+        _mm512_store_si512(data, v);
+    }
+
+    static vec min(vec a, vec b)
+    {
+        return _mm512_min_epu64(a, b);
+    }
+
+    static vec max(vec a, vec b)
+    {
+        return _mm512_max_epu64(a, b);
+    }
+
+    static vec permute_xor(vec v, size_t j)
+    {
+        switch (j)
+        {
+        case 1:
+            return _mm512_permutexvar_epi64(
+                _mm512_set_epi64(6, 7, 4, 5, 2, 3, 0, 1), v);
+        case 2:
+            return _mm512_permutexvar_epi64(
+                _mm512_set_epi64(5, 4, 7, 6, 1, 0, 3, 2), v);
+        default:
+            return _mm512_permutexvar_epi64(
+                _mm512_set_epi64(3, 2, 1, 0, 7, 6, 5, 4), v);
+        }
+    }
+
+    static mask make_mask(unsigned int bits)
+    {
+        return static_cast<mask>(bits);
+    }
+
+    static vec blend(mask take_max, vec minimum, vec maximum)
+    {
+        return _mm512_mask_blend_epi64(take_max, minimum, maximum);
+    }
+};
+
+#elif defined(__AVX2__)
+
+struct network_ops
+{
+    using vec = __m256i;
+    using mask = __m256i;
+    static constexpr size_t width = 4;
+
+    static vec load(const unsigned long* data)
+    {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(data));
+    }
+
+    static void store(unsigned long* data, vec v)
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(data), v);
+    }
+
+    /**
+     * AVX2 only compares signed 64-bit integers, so the sign bits are
+     * flipped before
+     */
+    static vec greater(vec a, vec b)
+    {
+        const vec sign = _mm256_set1_epi64x(LLONG_MIN);
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign),
+            _mm256_xor_si256(b, sign));
+    }
+
+    static vec min(vec a, vec b)
+    {
+        return _mm256_blendv_epi8(a, b, greater(a, b));
+    }
+
+    static vec max(vec a, vec b)
+    {
+        return _mm256_blendv_epi8(b, a, greater(a, b));
+    }
+
+    static vec permute_xor(vec v, size_t j)
+    {
+        return j == 1
+            ? _mm256_permute4x64_epi64(v, 0xB1)
+            : _mm256_permute4x64_epi64(v, 0x4E);
+    }
+
+    static mask make_mask(unsigned int bits)
+    {
+        return _mm256_set_epi64x(
+            bits & 8 ? -1 : 0, bits & 4 ? -1 : 0,
+            bits & 2 ? -1 : 0, bits & 1 ? -1 : 0);
+    }
+
+    static vec blend(mask take_max, vec minimum, vec maximum)
+    {
+        return _mm256_blendv_epi8(minimum, maximum, take_max);
+    }
+};
+
+#else
+
+struct network_ops
+{
+    using vec = unsigned long;
+    using mask = unsigned int;
+    static constexpr size_t width = 1;
+
+    static vec load(const unsigned long* data)
+    {
+        return *data;
+    }
+
+    static void store(unsigned long* data, vec v)
+    {
+        *data = v;
+    }
+
+    static vec min(vec a, vec b)
+    {
+        return a < b ? a : b;
+    }
+
+    static vec max(vec a, vec b)
+    {
+        return a < b ? b : a;
+    }
+
+    static vec permute_xor(vec v, size_t)
+    {
+        return v;
+    }
+
+    static mask make_mask(unsigned int bits)
+    {
+        return bits;
+    }
+
+    static vec blend(mask, vec minimum, vec)
+    {
+        return minimum;
+    }
+};
+
+#endif
+
+/**
+ * Computes the lanes of a vector, which take the maximum in a stage of
+ * the bitonic network. Lanes take the maximum, if they are the upper
+ * element of their pair in an ascending block or the lower one in a
+ * descending block
+ *
+ * @param first Index of the first lane
+ * @param j Distance of the pairs
+ * @param k Size of the blocks
+ * @return Bit mask of the lanes
+ */
+static unsigned int max_lanes(size_t first, size_t j, size_t k)
+{
+    unsigned int bits = 0;
+
+    for (size_t lane = 0; lane < network_ops::width; ++lane)
+    {
+        bool upper = (lane & j) != 0;
+        bool ascending = ((first + lane) & k) == 0;
+
+        if (upper == ascending)
+        {
+            bits |= 1u << lane;
+        }
+    }
+
+    return bits;
+}
+
+/**
+ * Sorts a buffer with a bitonic network. Blocks of size k are sorted
+ * ascending and descending in turn and merged with pairs of distance j
+ *
+ * @param buffer Buffer aligned to 64 bytes
+ * @param size Size of the buffer, a power of 2 and at least the width
+ */
+static void bitonic_sort(unsigned long* buffer, size_t size)
+{
+    using ops = network_ops;
+
+    for (size_t k = 2; k <= size; k <<= 1)
+    {
+        for (size_t j = k >> 1; j > 0; j >>= 1)
+        {
+            if (j >= ops::width)
+            {
+                // Pairs are in different vectors
+                for (size_t base = 0; base < size; base += 2 * j)
+                {
+                    bool ascending = (base & k) == 0;
+
+                    for (size_t i = base; i < base + j; i += ops::width)
+                    {
+                        auto a = ops::load(buffer + i);
+                        auto b = ops::load(buffer + i + j);
+                        auto minimum = ops::min(a, b);
+                        auto maximum = ops::max(a, b);
+
+                        ops::store(buffer + i,
+                            ascending ? minimum : maximum);
+                        ops::store(buffer + i + j,
+                            ascending ? maximum : minimum);
+                    }
+                }
+            }
+            else if constexpr (ops::width > 1)
+            {
+                // Pairs are in the same vector. Below the width, the lanes
+                // are the same for all vectors, otherwise they alternate
+                // with the direction of the blocks
+                auto ascending_mask = ops::make_mask(max_lanes(0, j, k));
+                auto descending_mask = ops::make_mask(
+                    max_lanes(k < ops::width ? 0 : k, j, k));
+
+                for (size_t i = 0; i < size; i += ops::width)
+                {
+                    auto v = ops::load(buffer + i);
+                    auto partner = ops::permute_xor(v, j);
+                    auto minimum = ops::min(v, partner);
+                    auto maximum = ops::max(v, partner);
+                    bool ascending = k < ops::width || (i & k) == 0;
+
+                    ops::store(buffer + i, ops::blend(
+                        ascending ? ascending_mask : descending_mask,
+                        minimum, maximum));
+                }
+            }
+        }
+    }
+}
+
+void small_sort(unsigned long* data, size_t count)
+{
+    if (count <= 1)
+    {
+        return;
+    }
+
+    alignas(64) unsigned long buffer[SMALL_SORT_MAX];
+    size_t size = network_ops::width;
+
+    while (size < count)
+    {
+        size <<= 1;
+    }
+
+    std::copy(data, data + count, buffer);
+    std::fill(buffer + count, buffer + size, ULONG_MAX);
+
+    bitonic_sort(buffer, size);
+
+    std::copy(buffer, buffer + count, data);
+}
+
+size_t small_sort_cutoff(size_t default_cutoff)
+{
+    const char* value = std::getenv(SMALL_SORT_CUTOFF_ENV);
+
+    if (value == nullptr)
+    {
+        return default_cutoff;
+    }
+
+    char* end;
+    unsigned long long cutoff = std::strtoull(value, &end, 10);
+
+    if (end == value || *end != '\0' || cutoff < 2)
+    {
+        return default_cutoff;
+    }
+
+    return cutoff;
+}
@@ -1,183 +1,354 @@
 #include "sort.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <iterator>
-#include <memory>
 
 #include "../taskpool/taskpool.hpp"
 #include "../taskpool/qs_task.hpp"
+#include "small_sort.hpp"
+
+/**
+ * Ranges below the cutoff are sorted with small_sort
+ */
+static size_t sort_cutoff = SORT_DEFAULT_CUTOFF;
 
 const char* sort_parser_exception::what() const noexcept
 {
     return "Could not parse numbers array!";
 }
 
-void sort(std::vector<unsigned long>& vector, const unsigned int thread_count)
+const char* sort_file_exception::what() const noexcept
 {
-    std::vector<unsigned long> temp;
-    temp.resize(vector.size());
-    taskpool tasks(thread_count - 1);
-    tasks.start();
-    tasks.put_and_work_until_finished(std::make_shared<qs_task>(
-        vector, 0, vector.size(), temp, thread_count
-    ));
+    return "Could not read array_file!";
 }
 
-void sort_parallel(taskpool* taskpool, qs_task* task, unsigned int tid)
+/**
+ * Returns the median of three elements
+ */
+static unsigned long median_of_three(unsigned long a, unsigned long b,
+    unsigned long c)
 {
-    auto element_count = task->last_index - task->first_index;
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+/**
+ * Selects the pivot of a range as the median of the medians of three
+ * samples each from its start, middle and end (ninther)
+ *
+ * @param data First element of the range
+ * @param count Number of elements (at least 1)
+ * @return The pivot
+ */
+static unsigned long select_pivot(const unsigned long* data,
+    unsigned long long count)
+{
+    auto step = count / 8;
+    auto middle = count / 2;
+    auto last = count - 1;
 
-    if (element_count <= 1)
+    if (step == 0)
     {
-        return;
+        return median_of_three(data[0], data[middle], data[last]);
     }
 
-    unsigned int elements_per_thread = element_count / task->assigned_threads;
-    unsigned int remaining_elements = element_count % task->assigned_threads;
-    unsigned long long start_index;
-    unsigned long long end_index;
+    return median_of_three(
+        median_of_three(data[0], data[step], data[2 * step]),
+        median_of_three(data[middle - step], data[middle], data[middle + step]),
+        median_of_three(data[last - 2 * step], data[last - step], data[last])
+    );
+}
+
+/**
+ * Computes the team size of a range, which is proportional to its share of
+ * the vector. Every thread of the team gets at least SORT_TEAM_ELEMENTS
+ *
+ * @param element_count Elements of the range
+ * @param vector_size Elements of the vector
+ * @param thread_count Threads of the taskpool
+ * @return The team size, at least 1
+ */
+static unsigned int team_size(unsigned long long element_count,
+    unsigned long long vector_size, unsigned int thread_count)
+{
+    auto proportional = static_cast<unsigned long long>(
+        static_cast<double>(thread_count) * element_count / vector_size + 0.5
+    );
 
-    /* First thread also computes remaining elements */
-    if (tid == 0)
-    {
-        start_index = task->first_index + tid * elements_per_thread;
-        
-        end_index = task->first_index
-            + (tid + 1) * elements_per_thread + remaining_elements;
+    auto team = std::min(proportional, element_count / SORT_TEAM_ELEMENTS);
+    team = std::min(team, static_cast<unsigned long long>(thread_count));
 
-        task->pivot = 
-            task->vector_to_sort[task->first_index + (element_count / 2) - 1];
-    }
-    else
+    return std::max(team, 1ULL);
+}
+
+/**
+ * Sorts a range with one thread and without new tasks. Ranges below the
+ * cutoff are sorted with small_sort, ranges beyond the depth limit with
+ * std::sort
+ *
+ * @param first First element
+ * @param last End of the range
+ * @param depth_limit Partition steps left
+ */
+static void sort_range(std::vector<unsigned long>::iterator first,
+    std::vector<unsigned long>::iterator last, unsigned int depth_limit)
+{
+    while (static_cast<size_t>(std::distance(first, last)) >= sort_cutoff)
     {
-        start_index = task->first_index
-            + tid * elements_per_thread + remaining_elements;
+        if (depth_limit == 0)
+        {
+            std::sort(first, last);
+            return;
+        }
+
+        auto pivot = select_pivot(&*first, std::distance(first, last));
 
-        end_index = task->first_index
-            + (tid + 1) * elements_per_thread + remaining_elements;
+        auto middle1 = std::partition(first, last, [pivot](const auto& em)
+        {
+            return em < pivot;
+        });
+
+        auto middle2 = std::partition(middle1, last, [pivot](const auto& em)
+        {
+            return !(pivot < em);
+        });
+
+        --depth_limit;
+        sort_range(middle2, last, depth_limit);
+        last = middle1;
     }
 
-    task->barrier.arrive_and_wait();
+    auto distance = std::distance(first, last);
 
-    auto first_it = task->vector_to_sort.begin() + start_index;
-    auto last_it = task->vector_to_sort.begin() + end_index;
+    if (distance > SMALL_SORT_MAX)
+    {
+        std::sort(first, last);
+    }
+    else if (distance > 1)
+    {
+        small_sort(&*first, distance);
+    }
+}
 
-    /* Move smaller elements to the left */
-    auto smaller_it = std::partition(first_it, last_it, [=](const auto& em)
+/**
+ * Sorts the range of a task with one thread. Ranges of at least
+ * SORT_SEQUENTIAL_CUTOFF elements are partitioned and their larger parts
+ * are put into the taskpool, until the depth limit is reached
+ *
+ * @param taskpool The Taskpool to insert new tasks
+ * @param task Current task
+ * @param thread_index Index of the thread in the taskpool
+ */
+static void sort_sequential(taskpool* taskpool, qs_task* task,
+    unsigned int thread_index)
+{
+    auto first = task->vector_to_sort.begin() + task->first_index;
+    auto last = task->vector_to_sort.begin() + task->last_index;
+    unsigned int depth_limit = task->depth_limit;
+
+    if (task->in_temp)
     {
-        return em < task->pivot;
-    });
+        std::copy(task->temp.begin() + task->first_index,
+            task->temp.begin() + task->last_index, first);
+    }
 
-    /* Move larger elements to the right */
-    auto larger_it = std::partition(smaller_it, last_it, [=](const auto& em)
+    while (std::distance(first, last) >= SORT_SEQUENTIAL_CUTOFF
+        && depth_limit > 0)
     {
-       return !(task->pivot < em);
-    });
+        auto pivot = select_pivot(&*first, std::distance(first, last));
 
-    auto smaller_elements_count = std::distance(first_it, smaller_it);
-    auto pivot_elements_count = std::distance(smaller_it, larger_it);
-    auto larger_elements_count = std::distance(larger_it, last_it);
+        auto middle1 = std::partition(first, last, [pivot](const auto& em)
+        {
+            return em < pivot;
+        });
 
-    task->smaller_partition_size[tid] = smaller_elements_count;
-    task->pivot_elements[tid] = pivot_elements_count;
-    task->larger_partition_size[tid] = larger_elements_count;
-    
-    task->barrier.arrive_and_wait();
+        auto middle2 = std::partition(middle1, last, [pivot](const auto& em)
+        {
+            return !(pivot < em);
+        });
 
-    /* Calculate offset for smaller elements */
-    auto smaller_elements_offset = task->first_index;
-    for (unsigned int i = 0; i < tid; ++i)
-    {
-        smaller_elements_offset += task->smaller_partition_size[i];
+        --depth_limit;
+
+        // Put larger elements in taskpool
+        if (std::distance(middle2, last) >= SORT_SEQUENTIAL_CUTOFF)
+        {
+            taskpool->put(taskpool->create_task(thread_index,
+                task->vector_to_sort,
+                std::distance(task->vector_to_sort.begin(), middle2),
+                std::distance(task->vector_to_sort.begin(), last),
+                task->temp, 1, false, depth_limit
+            ));
+        }
+        else
+        {
+            sort_range(middle2, last, depth_limit);
+        }
+
+        // Work on smaller elements
+        last = middle1;
     }
 
-    /* Write smaller elements to temp vector */
-    for (unsigned int i = 0; i < smaller_elements_count; ++i)
+    sort_range(first, last, depth_limit);
+}
+
+void sort(std::vector<unsigned long>& vector, const unsigned int thread_count,
+    ttracker_t* ttracker, unsigned int ttracker_tid)
+{
+    if (thread_count <= 1)
     {
-        task->temp[smaller_elements_offset + i] = *(first_it + i);
+        ttracker_thread_start(ttracker, 0, ttracker_tid);
+        ttracker_span_begin(ttracker, "sort", -1);
+        std::sort(vector.begin(), vector.end());
+        ttracker_span_end(ttracker);
+        ttracker_thread_stop(ttracker, 0, ttracker_tid);
+        return;
     }
 
-    /* Calculate offset for pivot elements */
-    auto pivot_elements_offset = task->first_index;
-    for (unsigned int i = 0; i < task->necessary_threads; ++i)
+    sort_cutoff = small_sort_cutoff(SORT_DEFAULT_CUTOFF);
+
+    // Quicksort is limited to 2 * log2(n) partition steps, like Introsort
+    auto depth_limit = 2 * static_cast<unsigned int>(
+        std::bit_width(vector.size()));
+
+    std::vector<unsigned long> temp;
+    temp.resize(vector.size());
+    taskpool tasks(thread_count - 1, ttracker, ttracker_tid);
+    tasks.start();
+    tasks.put_and_work_until_finished(tasks.create_task(0,
+        vector, 0, vector.size(), temp,
+        team_size(vector.size(), vector.size(), thread_count),
+        false, depth_limit
+    ));
+}
+
+void sort_parallel(taskpool* taskpool, qs_task* task, unsigned int tid,
+    unsigned int thread_index)
+{
+    if (task->necessary_threads == 1)
     {
-        pivot_elements_offset += task->smaller_partition_size[i];
+        sort_sequential(taskpool, task, thread_index);
+        return;
     }
-    for (unsigned int i = 0; i < tid; ++i)
+
+    auto element_count = task->last_index - task->first_index;
+    auto& source = task->in_temp ? task->temp : task->vector_to_sort;
+    auto& target = task->in_temp ? task->vector_to_sort : task->temp;
+
+    /* The first threads also compute one of the remaining elements */
+    auto elements_per_thread = element_count / task->necessary_threads;
+    auto remaining_elements = element_count % task->necessary_threads;
+    auto start_index = task->first_index + tid * elements_per_thread
+        + std::min<unsigned long long>(tid, remaining_elements);
+    auto end_index = start_index + elements_per_thread
+        + (tid < remaining_elements ? 1 : 0);
+
+    if (tid == 0)
     {
-        pivot_elements_offset += task->pivot_elements[i];
+        task->pivot =
+            select_pivot(source.data() + task->first_index, element_count);
     }
 
-    /* Write pivot elements to temp vector */
-    for (auto i = 0; i < pivot_elements_count; ++i)
+    taskpool->barrier_wait(task, thread_index);
+
+    auto pivot = task->pivot;
+    auto first_it = source.begin() + start_index;
+    auto last_it = source.begin() + end_index;
+
+    /* Move smaller elements to the left */
+    auto smaller_it = std::partition(first_it, last_it, [pivot](const auto& em)
     {
-        task->temp[pivot_elements_offset + i] = *(smaller_it + i);
-    }
+        return em < pivot;
+    });
 
-    /* Calculate offset for larger elements */
-    auto larger_elements_offset = task->last_index;
-    for (auto i = tid; i < task->necessary_threads; ++i)
+    /* Move larger elements to the right */
+    auto larger_it = std::partition(smaller_it, last_it, [pivot](const auto& em)
     {
-        larger_elements_offset -= task->larger_partition_size[i];
-    }
+        return !(pivot < em);
+    });
+
+    task->smaller_partition_size[tid] = std::distance(first_it, smaller_it);
+    task->pivot_elements[tid] = std::distance(smaller_it, larger_it);
+    task->larger_partition_size[tid] = std::distance(larger_it, last_it);
+
+    taskpool->barrier_wait(task, thread_index);
 
-    /* Write larger elements to temp vector */
-    for (auto i = 0; i < larger_elements_count; ++i)
+    /* Calculate offsets of the parts of this thread in the target */
+    unsigned long long smaller_elements_count = 0;
+    unsigned long long pivot_elements_count = 0;
+    unsigned long long smaller_elements_offset = task->first_index;
+    unsigned long long pivot_elements_offset = 0;
+    unsigned long long larger_elements_offset = 0;
+
+    for (unsigned int i = 0; i < task->necessary_threads; ++i)
     {
-        task->temp[larger_elements_offset + i] = *(larger_it + i);
+        if (i < tid)
+        {
+            smaller_elements_offset += task->smaller_partition_size[i];
+            pivot_elements_offset += task->pivot_elements[i];
+            larger_elements_offset += task->larger_partition_size[i];
+        }
+
+        smaller_elements_count += task->smaller_partition_size[i];
+        pivot_elements_count += task->pivot_elements[i];
     }
 
-    task->barrier.arrive_and_wait();
+    auto pivot_start_index = task->first_index + smaller_elements_count;
+    auto larger_start_index = pivot_start_index + pivot_elements_count;
+    pivot_elements_offset += pivot_start_index;
+    larger_elements_offset += larger_start_index;
+
+    /* Copy the parts to the target */
+    std::copy(first_it, smaller_it, target.begin() + smaller_elements_offset);
+    std::copy(smaller_it, larger_it, target.begin() + pivot_elements_offset);
+    std::copy(larger_it, last_it, target.begin() + larger_elements_offset);
 
-    /* Write back elements */
-    for (unsigned long i = start_index; i < end_index; ++i)
+    taskpool->barrier_wait(task, thread_index);
+
+    /* Pivot elements are sorted, so they are copied back from temp */
+    if (!task->in_temp)
     {
-        task->vector_to_sort[i] = task->temp[i];
+        auto pivot_per_thread = pivot_elements_count / task->necessary_threads;
+        auto copy_start = pivot_start_index + tid * pivot_per_thread;
+        auto copy_end = tid + 1 == task->necessary_threads
+            ? larger_start_index : copy_start + pivot_per_thread;
+
+        std::copy(task->temp.begin() + copy_start,
+            task->temp.begin() + copy_end,
+            task->vector_to_sort.begin() + copy_start);
     }
 
-    /* Create new task, if first thread */
+    /* Create new tasks in the target, if first thread */
     if (tid == 0)
     {
-        unsigned long smaller_elements_count = 0;
-        for (unsigned long i = 0; i < task->necessary_threads; ++i)
+        auto vector_size = task->vector_to_sort.size();
+        auto thread_count = taskpool->thread_count();
+        auto depth_limit = task->depth_limit - 1;
+
+        if (smaller_elements_count > 0)
         {
-            smaller_elements_count += task->smaller_partition_size[i];
+            auto smaller_necessary_threads = depth_limit > 0
+                ? team_size(smaller_elements_count, vector_size, thread_count)
+                : 1;
+
+            taskpool->put(taskpool->create_task(thread_index,
+                task->vector_to_sort, task->first_index, pivot_start_index,
+                task->temp, smaller_necessary_threads, !task->in_temp,
+                depth_limit
+            ));
         }
-        unsigned long smaller_end_index = task->first_index
-            + smaller_elements_count;
 
-        unsigned long larger_elements_count = 0;
-        for (unsigned long i = 0; i < task->necessary_threads; ++i)
+        if (larger_start_index < task->last_index)
         {
-            larger_elements_count += task->larger_partition_size[i];
+            auto larger_necessary_threads = depth_limit > 0
+                ? team_size(task->last_index - larger_start_index,
+                    vector_size, thread_count)
+                : 1;
+
+            taskpool->put(taskpool->create_task(thread_index,
+                task->vector_to_sort, larger_start_index, task->last_index,
+                task->temp, larger_necessary_threads, !task->in_temp,
+                depth_limit
+            ));
         }
-        unsigned long larger_start_index = task->last_index
-            - larger_elements_count;
-
-        auto smaller_necessary_threads = static_cast<unsigned int>(
-            smaller_elements_count *
-            (taskpool->thread_count() / task->vector_to_sort.size()) + 0.5
-        );
-
-        auto larger_necessary_threads = static_cast<unsigned int>(
-            larger_elements_count *
-            (taskpool->thread_count() / task->vector_to_sort.size()) + 0.5
-        );
-
-        smaller_necessary_threads =
-            std::max(smaller_necessary_threads, static_cast<unsigned int>(1));
-        
-        larger_necessary_threads =
-            std::max(larger_necessary_threads, static_cast<unsigned int>(1));
-
-        taskpool->put(std::make_shared<qs_task>(
-            task->vector_to_sort, task->first_index, smaller_end_index,
-            task->temp, smaller_necessary_threads
-        ));
-
-        taskpool->put(std::make_shared<qs_task>(
-            task->vector_to_sort, larger_start_index, task->last_index,
-            task->temp, larger_necessary_threads
-        ));
     }
 }
@@ -3,9 +3,16 @@
 
 #include <vector>
 
+#include <ttracker.h>
+
 #include "../taskpool/taskpool.hpp"
 #include "../taskpool/qs_task.hpp"
 
+/* Defines for sorting */
+#define SORT_SEQUENTIAL_CUTOFF 16384 ///< Ranges sorted without new tasks
+#define SORT_TEAM_ELEMENTS     65536 ///< Min. elements per thread of a team
+#define SORT_DEFAULT_CUTOFF    100   ///< Ranges sorted with small_sort
+
 /**
  * Exception for parsing errors
  */
@@ -16,20 +23,47 @@ public:
 };
 
 /**
- * Sorts the vector using Quicksort
+ * Exception for errors while reading the array file
+ */
+class sort_file_exception : public std::exception
+{
+public:
+    const char* what() const noexcept override;
+};
+
+/**
+ * Sorts the vector using
+ * Introsort, if threadCount <= 1
+ * Quicksort, if threadCount >  1
+ *
+ * Large ranges are partitioned by teams of threads, whose size is
+ * proportional to the size of the range. Ranges with a team of one thread
+ * are partitioned sequentially and ranges below SORT_SEQUENTIAL_CUTOFF
+ * without new tasks. Ranges below the cutoff (DBENCH_SORT_CUTOFF,
+ * SORT_DEFAULT_CUTOFF by default) are sorted with small_sort up to
+ * SMALL_SORT_MAX elements
  *
  * @param vector The vector to be sorted
  * @param thread_count Thread count
+ * @param ttracker Tracker for the per-thread sort times
+ * @param ttracker_tid Event index of the sort phase
  */
-void sort(std::vector<unsigned long>& vector, const unsigned int thread_count);
+void sort(std::vector<unsigned long>& vector, const unsigned int thread_count,
+    ttracker_t* ttracker, unsigned int ttracker_tid);
 
 /**
- * Sorts a range between to iterators using parallel Quicksort
+ * Executes a quicksort task. A team of threads partitions the range of the
+ * task cooperatively: every thread partitions a chunk and copies its parts
+ * to their positions in the other vector (vector_to_sort or temp). The
+ * smaller and the larger parts become new tasks, which continue in that
+ * vector. A task with one thread partitions its range sequentially
  *
  * @param taskpool The Taskpool to insert new tasks
  * @param task Current task
  * @param tid Thread ID
+ * @param thread_index Index of the thread in the taskpool
  */
-void sort_parallel(taskpool* taskpool, qs_task* task, unsigned int tid);
+void sort_parallel(taskpool* taskpool, qs_task* task, unsigned int tid,
+    unsigned int thread_index);
 
 #endif
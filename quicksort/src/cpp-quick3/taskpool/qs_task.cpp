@@ -1,20 +1,105 @@
 #include "qs_task.hpp"
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+team_barrier::team_barrier()
+    : thread_count_(1), arrived_(0), generation_(0)
+{
+}
+
+void team_barrier::reset(unsigned int thread_count) noexcept
+{
+    thread_count_ = thread_count;
+    arrived_.store(0, std::memory_order_relaxed);
+}
+
+void team_barrier::arrive_and_wait() noexcept
+{
+    unsigned int generation = generation_.load(std::memory_order_acquire);
+
+    if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == thread_count_)
+    {
+        // Last thread, the others are released
+        arrived_.store(0, std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+        generation_.notify_all();
+        return;
+    }
+
+    for (unsigned int i = 0; i < QS_BARRIER_SPIN_ROUNDS; ++i)
+    {
+        if (generation_.load(std::memory_order_acquire) != generation)
+        {
+            return;
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    while (generation_.load(std::memory_order_acquire) == generation)
+    {
+        generation_.wait(generation, std::memory_order_acquire);
+    }
+}
+
 qs_task::qs_task(std::vector<unsigned long>& vector_to_sort,
-    unsigned long long first_index, unsigned long long last_index,
-    std::vector<unsigned long>& temp, unsigned int necessary_threads)
-    : necessary_threads(necessary_threads), assigned_threads(0),
-        first_index(first_index), last_index(last_index), vector_to_sort(vector_to_sort),
-        temp(temp), barrier(necessary_threads)
+    std::vector<unsigned long>& temp, unsigned int max_threads)
+    : necessary_threads(0), assigned_threads(0), references(0),
+        first_index(0), last_index(0), in_temp(false), depth_limit(0),
+        vector_to_sort(vector_to_sort), temp(temp), next(nullptr)
+{
+    smaller_partition_size.resize(max_threads);
+    larger_partition_size.resize(max_threads);
+    pivot_elements.resize(max_threads);
+}
+
+void qs_task::init(unsigned long long first_index,
+    unsigned long long last_index, unsigned int necessary_threads,
+    bool in_temp, unsigned int depth_limit)
 {
-    smaller_partition_size.resize(necessary_threads);
-    larger_partition_size.resize(necessary_threads);
-    pivot_elements.resize(necessary_threads);
+    this->necessary_threads = necessary_threads;
+    this->assigned_threads = 0;
+    this->references.store(necessary_threads, std::memory_order_relaxed);
+    this->first_index = first_index;
+    this->last_index = last_index;
+    this->in_temp = in_temp;
+    this->depth_limit = depth_limit;
+    this->next = nullptr;
+    barrier.reset(necessary_threads);
 }
 
 bool qs_task::ready() noexcept
 {
     return assigned_threads == necessary_threads;
 }
+
+qs_task* qs_task_arena::allocate(std::vector<unsigned long>& vector_to_sort,
+    std::vector<unsigned long>& temp, unsigned int max_threads)
+{
+    if (free_list_ == nullptr)
+    {
+        tasks_.push_back(
+            std::make_unique<qs_task>(vector_to_sort, temp, max_threads));
+
+        return tasks_.back().get();
+    }
+
+    qs_task* task = free_list_;
+    free_list_ = task->next;
+
+    return task;
+}
+
+void qs_task_arena::free(qs_task* task)
+{
+    task->next = free_list_;
+    free_list_ = task;
+}
@@ -1,23 +1,87 @@
 #ifndef QS_TASK_HPP
 #define QS_TASK_HPP
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
-#include <barrier>
 #include <condition_variable>
 
+/* Defines for the team barrier */
+#define QS_BARRIER_SPIN_ROUNDS 1024 ///< Checks of the barrier before waiting
+
+/**
+ * This class represents a reusable barrier for a team of threads, whose
+ * size can be changed while no thread waits. Threads spin for a while and
+ * then wait on the generation counter
+ */
+class team_barrier
+{
+public:
+    team_barrier();
+
+    /**
+     * Sets the number of threads. No thread may wait at the barrier
+     *
+     * @param thread_count Threads of the team
+     */
+    void reset(unsigned int thread_count) noexcept;
+
+    /**
+     * Waits, until all threads of the team arrived
+     */
+    void arrive_and_wait() noexcept;
+
+private:
+    /**
+     * Threads of the team
+     */
+    unsigned int thread_count_;
+
+    /**
+     * Threads, which arrived in the current generation
+     */
+    std::atomic<unsigned int> arrived_;
+
+    /**
+     * Incremented by the last thread of each generation
+     */
+    std::atomic<unsigned int> generation_;
+};
+
 /**
- * This class represents quicksort task
+ * This class represents quicksort task. Tasks are recycled by the
+ * qs_task_arena of a thread, so all tasks of an arena sort the same vector
  */
 struct qs_task
 {
+    /**
+     * Creates an empty task
+     *
+     * @param vector_to_sort Vector to sort
+     * @param temp Auxiliary vector
+     * @param max_threads Maximum team size
+     */
     qs_task(std::vector<unsigned long>& vector_to_sort,
-        unsigned long long first_index, unsigned long long last_index,
-        std::vector<unsigned long>& temp, unsigned int necessary_threads);
+        std::vector<unsigned long>& temp, unsigned int max_threads);
+
+    /**
+     * Prepares the task for a range. No thread may use the task
+     *
+     * @param first_index First element to sort
+     * @param last_index Last element to sort
+     * @param necessary_threads Team size
+     * @param in_temp The elements of the range are in temp
+     * @param depth_limit Partition steps left
+     */
+    void init(unsigned long long first_index, unsigned long long last_index,
+        unsigned int necessary_threads, bool in_temp,
+        unsigned int depth_limit);
+
     /**
      * How many threads are needed for computation
      */
-    const unsigned int necessary_threads;
+    unsigned int necessary_threads;
 
     /**
      * The pivot element
@@ -29,6 +93,11 @@ struct qs_task
      */
     unsigned int assigned_threads;
 
+    /**
+     * Threads, which didn't finish the task yet. The last one frees it
+     */
+    std::atomic<unsigned int> references;
+
     /**
      * First element to sort
      */
@@ -39,6 +108,16 @@ struct qs_task
      */
     unsigned long long last_index;
 
+    /**
+     * The elements of the range are in temp, not in vector_to_sort
+     */
+    bool in_temp;
+
+    /**
+     * Partition steps left, before the range is sorted with std::sort
+     */
+    unsigned int depth_limit;
+
     /**
      * Vector to sort
      */
@@ -64,6 +143,11 @@ struct qs_task
      */
     std::vector<unsigned long> pivot_elements;
 
+    /**
+     * Next task in the queue of the taskpool or the free list of an arena
+     */
+    qs_task* next;
+
     /**
      * Mutex for adding new threads
      */
@@ -77,13 +161,52 @@ struct qs_task
     /**
      * Barrier for synchronisation
      */
-    std::barrier<> barrier;
+    team_barrier barrier;
 
     /**
      * Task is ready
-     */ 
+     */
     bool ready() noexcept;
 
 };
 
+/**
+ * This class represents the tasks of one thread. Finished tasks are kept in
+ * a free list and reused, so no memory is allocated after the first tasks.
+ * Only its thread may use the arena, but tasks may be freed into another
+ * arena than the one they were allocated from
+ */
+class qs_task_arena
+{
+public:
+    /**
+     * Returns a free task, which must be initialized
+     *
+     * @param vector_to_sort Vector to sort, the same for all tasks
+     * @param temp Auxiliary vector, the same for all tasks
+     * @param max_threads Maximum team size
+     * @return The task
+     */
+    qs_task* allocate(std::vector<unsigned long>& vector_to_sort,
+        std::vector<unsigned long>& temp, unsigned int max_threads);
+
+    /**
+     * Puts a task into the free list
+     *
+     * @param task Task, which isn't used anymore
+     */
+    void free(qs_task* task);
+
+private:
+    /**
+     * First free task
+     */
+    qs_task* free_list_ = nullptr;
+
+    /**
+     * All tasks of the arena
+     */
+    std::vector<std::unique_ptr<qs_task>> tasks_;
+};
+
 #endif
@@ -1,7 +1,6 @@
 #include "taskpool.hpp"
 
 #include <mutex>
-#include <queue>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -10,17 +9,24 @@
 #include "../sort/sort.hpp"
 #include "qs_task.hpp"
 
-taskpool::taskpool(unsigned int thread_count)
-    : thread_count_(thread_count), working_threads_(thread_count)
+taskpool::taskpool(unsigned int thread_count, ttracker_t* ttracker,
+    unsigned int ttracker_tid)
+    : thread_count_(thread_count), working_threads_(thread_count),
+        ttracker_(ttracker), ttracker_tid_(ttracker_tid)
 {
     threads_.resize(thread_count_);
+
+    for (unsigned int i = 0; i <= thread_count_; ++i)
+    {
+        arenas_.push_back(std::make_unique<qs_task_arena>());
+    }
 }
 
 void taskpool::start()
 {
     for (unsigned int i = 0; i < thread_count_; ++i)
     {
-        threads_[i] = std::thread(&taskpool::worker_thread, this);
+        threads_[i] = std::thread(&taskpool::worker_thread, this, i + 1);
     }
 }
 
@@ -72,7 +78,7 @@ void taskpool::work_until_finished()
 
     condition_.notify_all();
 
-    worker_thread(); // Caller also works
+    worker_thread(0); // Caller also works
 
     for (std::thread& thread : threads_)
     {
@@ -82,18 +88,18 @@ void taskpool::work_until_finished()
     threads_.clear();
 }
 
-void taskpool::put(const std::shared_ptr<qs_task> task)
+void taskpool::put(qs_task* task)
 {
     /* Scope for locking and unlocking mutex */
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        tasks_.push(task);
+        push_task(task);
     }
     
     condition_.notify_one();
 }
 
-void taskpool::put_and_work_until_finished(const std::shared_ptr<qs_task> task)
+void taskpool::put_and_work_until_finished(qs_task* task)
 {
     /* Scope for locking and unlocking mutex */
     {
@@ -101,12 +107,12 @@ void taskpool::put_and_work_until_finished(const std::shared_ptr<qs_task> task)
         ++thread_count_;
         ++working_threads_;
         should_finish_ = true;
-        tasks_.push(task);
+        push_task(task);
     }
 
     condition_.notify_all();
 
-    worker_thread();
+    worker_thread(0); // Caller also works
 
     for (std::thread& thread : threads_)
     {
@@ -116,6 +122,29 @@ void taskpool::put_and_work_until_finished(const std::shared_ptr<qs_task> task)
     threads_.clear();
 }
 
+qs_task* taskpool::create_task(unsigned int thread_index,
+    std::vector<unsigned long>& vector_to_sort,
+    unsigned long long first_index, unsigned long long last_index,
+    std::vector<unsigned long>& temp, unsigned int necessary_threads,
+    bool in_temp, unsigned int depth_limit)
+{
+    // Teams have at most all threads, the caller included
+    qs_task* task = arenas_[thread_index]->allocate(vector_to_sort, temp,
+        arenas_.size());
+
+    task->init(first_index, last_index, necessary_threads, in_temp,
+        depth_limit);
+
+    return task;
+}
+
+void taskpool::barrier_wait(qs_task* task, unsigned int thread_index)
+{
+    ttracker_wait_begin(ttracker_, thread_index, ttracker_tid_);
+    task->barrier.arrive_and_wait();
+    ttracker_wait_end(ttracker_, thread_index, ttracker_tid_);
+}
+
 const unsigned int& taskpool::thread_count() noexcept
 {
     return thread_count_;
@@ -123,22 +152,42 @@ const unsigned int& taskpool::thread_count() noexcept
 
 bool taskpool::should_do_something() const
 {
-    return !tasks_.empty() || should_terminate_
+    return tasks_head_ != nullptr || should_terminate_
         || (should_finish_ && working_threads_ == 0);
 }
 
 bool taskpool::should_finish_work() const
 {
-    return should_finish_ && working_threads_ == 0 && tasks_.empty();
+    return should_finish_ && working_threads_ == 0 && tasks_head_ == nullptr;
+}
+
+void taskpool::push_task(qs_task* task)
+{
+    task->next = nullptr;
+
+    if (tasks_tail_ == nullptr)
+    {
+        tasks_head_ = task;
+    }
+    else
+    {
+        tasks_tail_->next = task;
+    }
+
+    tasks_tail_ = task;
 }
 
-void taskpool::worker_thread()
+void taskpool::worker_thread(unsigned int thread_index)
 {
+    ttracker_pin_thread(thread_index);
+
     while (true)
     {
-        std::shared_ptr<qs_task> task;
+        qs_task* task;
         unsigned int tid;
 
+        ttracker_wait_begin(ttracker_, thread_index, ttracker_tid_);
+
         /* Scope for locking and unlocking mutex */
         {
             std::unique_lock<std::mutex> lock(mutex_);
@@ -154,6 +203,7 @@ void taskpool::worker_thread()
                 // Notify threads, that might wait for last thread
                 condition_.notify_all();
 
+                ttracker_wait_end(ttracker_, thread_index, ttracker_tid_);
                 return;
             }
 
@@ -161,12 +211,14 @@ void taskpool::worker_thread()
 
             if (should_terminate_)
             {
+                lock.unlock();
+                ttracker_wait_end(ttracker_, thread_index, ttracker_tid_);
                 return;
             }
 
             ++working_threads_;
 
-            task = tasks_.front();
+            task = tasks_head_;
 
             std::unique_lock<std::mutex> task_lock(task->mutex);
 
@@ -175,7 +227,13 @@ void taskpool::worker_thread()
 
             if (task->assigned_threads == task->necessary_threads)
             {
-                tasks_.pop();
+                tasks_head_ = task->next;
+
+                if (tasks_head_ == nullptr)
+                {
+                    tasks_tail_ = nullptr;
+                }
+
                 lock.unlock();
                 condition_.notify_one(); // There might be more work available
                 task_lock.unlock();
@@ -189,6 +247,17 @@ void taskpool::worker_thread()
             }
         }
 
-        sort_parallel(this, task.get(), tid);
+        ttracker_wait_end(ttracker_, thread_index, ttracker_tid_);
+        ttracker_thread_start(ttracker_, thread_index, ttracker_tid_);
+        ttracker_span_begin(ttracker_, "task", -1);
+        sort_parallel(this, task, tid, thread_index);
+        ttracker_span_end(ttracker_);
+        ttracker_thread_stop(ttracker_, thread_index, ttracker_tid_);
+
+        // The last thread of the team reuses the task in its arena
+        if (task->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            arenas_[thread_index]->free(task);
+        }
     }
 }
@@ -2,16 +2,19 @@
 #define TASKPOOL_HPP
 
 #include <mutex>
-#include <queue>
 #include <memory>
 #include <thread>
 #include <vector>
 #include <condition_variable>
 
+#include <ttracker.h>
+
 #include "qs_task.hpp"
 
 /**
- * This class represents a simple taskpool
+ * This class represents a simple taskpool. Tasks are recycled by arenas of
+ * the threads and queued in an intrusive list, so the taskpool doesn't
+ * allocate memory after the first tasks
  */
 class taskpool
 {
@@ -19,8 +22,11 @@ public:
     /**
      * Initializes the taskpool with the number of worker threads
      * @param thread_count The thread count
+     * @param ttracker Tracker for the per-thread busy times (optional)
+     * @param ttracker_tid Event index of the busy times
      */
-    taskpool(unsigned int thread_count);
+    taskpool(unsigned int thread_count, ttracker_t* ttracker = nullptr,
+        unsigned int ttracker_tid = 0);
 
     /**
      * Starts the taskpool. Worker threads are waiting for new tasks
@@ -47,14 +53,42 @@ public:
      *
      * @param task Task to insert into queue
      */
-    void put(const std::shared_ptr<qs_task> task);
+    void put(qs_task* task);
 
     /**
      * Inserts a new task into the task queue and works until finished
      *
      * @param task Task to insert into queue
      */
-    void put_and_work_until_finished(const std::shared_ptr<qs_task> task);
+    void put_and_work_until_finished(qs_task* task);
+
+    /**
+     * Returns a task from the arena of a thread
+     *
+     * @param thread_index Index of the calling thread
+     * @param vector_to_sort Vector to sort
+     * @param first_index First element to sort
+     * @param last_index Last element to sort
+     * @param temp Auxiliary vector
+     * @param necessary_threads Team size
+     * @param in_temp The elements of the range are in temp
+     * @param depth_limit Partition steps left
+     * @return The task
+     */
+    qs_task* create_task(unsigned int thread_index,
+        std::vector<unsigned long>& vector_to_sort,
+        unsigned long long first_index, unsigned long long last_index,
+        std::vector<unsigned long>& temp, unsigned int necessary_threads,
+        bool in_temp, unsigned int depth_limit);
+
+    /**
+     * Waits at the barrier of a task. The wait is added to the wait
+     * histogram of the thread
+     *
+     * @param task Task, whose threads are synchronized
+     * @param thread_index Index of the calling thread
+     */
+    void barrier_wait(qs_task* task, unsigned int thread_index);
 
     /**
      * Returns the number of threads
@@ -83,6 +117,16 @@ private:
      */
     bool should_finish_ = false;
 
+    /**
+     * Tracker for the per-thread busy times
+     */
+    ttracker_t* ttracker_;
+
+    /**
+     * Event index of the busy times
+     */
+    const unsigned int ttracker_tid_;
+
     /**
      * Mutex for the queue
      */
@@ -99,9 +143,25 @@ private:
     std::vector<std::thread> threads_;
 
     /**
-     * Queue of tasks for the worker threads
+     * First task of the queue for the worker threads
      */
-    std::queue<std::shared_ptr<qs_task>> tasks_;
+    qs_task* tasks_head_ = nullptr;
+
+    /**
+     * Last task of the queue for the worker threads
+     */
+    qs_task* tasks_tail_ = nullptr;
+
+    /**
+     * Task arenas of the threads. The caller has index 0
+     */
+    std::vector<std::unique_ptr<qs_task_arena>> arenas_;
+
+    /**
+     * Appends a task to the queue
+     * Assumes, that mutex_ is locked by caller
+     */
+    void push_task(qs_task* task);
 
     /**
      * Checks, if a thread should do something
@@ -119,8 +179,10 @@ private:
      * Waits for new tasks and executes them.
      * Exits, if should_terminate_ is true.
      * Finishes the work and exits, if should_finish_ is true
+     *
+     * @param thread_index Index of the thread. The caller has index 0
      */
-    void worker_thread();
+    void worker_thread(unsigned int thread_index);
 };
 
 #endif
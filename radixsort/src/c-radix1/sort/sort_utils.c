@@ -1,86 +1,366 @@
 #include "sort_utils.h"
 
+#include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE4_1__
+#include <immintrin.h>
+#endif
+
 #include "sort.h"
 
-int sort_check_and_parse_length(const char* array_string, sort_memory_t* memory)
+/**
+ * Parses a number and the following ',' or '\n' digit by digit
+ *
+ * @param position First char of the number
+ * @param end End of the string
+ * @param number The parsed number
+ * @return Position after the delimiter or NULL, if the string is invalid
+ */
+static const char* sort_parse_number_scalar(const char* position,
+    const char* end, unsigned long* number)
 {
-    char token;
-    char expected_token = TOKEN_NUMBER;
-    unsigned long long length = 0;
+    const char* start = position;
+    unsigned long value = 0;
 
-    while ((token = *(array_string++)))
+    while (position < end && *position >= '0' && *position <= '9')
     {
-        switch (token)
+        unsigned long digit = *position - '0';
+
+        if (value > (ULONG_MAX - digit) / 10)
         {
-        case ',': case '\n':
-            if (!(expected_token & TOKEN_BREAK))
-            {
-                return SORT_FAILURE;
-            }
+            return NULL; // Overflow
+        }
 
-            ++length;
-            expected_token = TOKEN_NUMBER;
-            break;
+        value = value * 10 + digit;
+        ++position;
+    }
+
+    if (position == start)
+    {
+        return NULL;
+    }
+
+    /* The last number doesn't need a delimiter */
+    if (position < end)
+    {
+        if (*position != ',' && *position != '\n')
+        {
+            return NULL;
+        }
+
+        ++position;
+    }
+
+    *number = value;
+    return position;
+}
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            if (!(expected_token & TOKEN_NUMBER))
+/**
+ * Parses a number and the following ',' or '\n'. Numbers with less than
+ * 16 digits are found with a vector compare and converted with
+ * multiply-adds, if at least 16 chars are left
+ *
+ * @param position First char of the number
+ * @param end End of the string
+ * @param number The parsed number
+ * @return Position after the delimiter or NULL, if the string is invalid
+ */
+static inline const char* sort_parse_number(const char* position,
+    const char* end, unsigned long* number)
+{
+#ifdef __SSE4_1__
+    if (end - position >= SORT_SIMD_WIDTH)
+    {
+        __m128i chars = _mm_loadu_si128((const __m128i*) position);
+        __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+
+        /* Digits are the bytes in [0; 9] after subtracting '0' */
+        __m128i is_digit = _mm_cmpeq_epi8(
+            _mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+        unsigned int non_digits = ~_mm_movemask_epi8(is_digit) & 0xFFFF;
+
+        if (non_digits != 0)
+        {
+            int count = __builtin_ctz(non_digits);
+            char delimiter = position[count];
+
+            if (count == 0 || (delimiter != ',' && delimiter != '\n'))
             {
-                return SORT_FAILURE;
+                return NULL;
             }
 
-            expected_token = TOKEN_NUMBER | TOKEN_BREAK;
-            break;
+            /* Move the digits to the end, the other bytes become 0 */
+            __m128i shuffle = _mm_add_epi8(
+                _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                    8, 9, 10, 11, 12, 13, 14, 15),
+                _mm_set1_epi8(count - SORT_SIMD_WIDTH));
+            digits = _mm_shuffle_epi8(digits, shuffle);
 
-        default:
-            return SORT_FAILURE;
+            /* Combine 2, 4 and 8 digits */
+            __m128i pairs = _mm_maddubs_epi16(digits,
+                _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                    10, 1, 10, 1, 10, 1, 10, 1));
+            __m128i quads = _mm_madd_epi16(pairs,
+                _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+            quads = _mm_packus_epi32(quads, quads);
+            __m128i octets = _mm_madd_epi16(quads,
+                _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+            *number = (unsigned long) _mm_cvtsi128_si32(octets) * 100000000UL
+                + (unsigned long) _mm_extract_epi32(octets, 1);
+
+            return position + count + 1;
         }
     }
+#endif
 
-    memory->length = length;
-    return SORT_SUCCESS;
+    return sort_parse_number_scalar(position, end, number);
+}
+
+/**
+ * Checks whether a char separates two numbers
+ *
+ * @param token Char to check
+ * @return 1, if the char is a delimiter, else 0
+ */
+static inline int sort_is_delimiter(char token)
+{
+    return token == ',' || token == '\n';
 }
 
-void sort_parse_numbers(const char* array_string, sort_memory_t* memory)
+/**
+ * Runs the worker function for every chunk. The main thread parses the
+ * first chunk
+ *
+ * @param worker Worker function
+ * @param args Parser arguments for every thread
+ * @param thread_count Number of threads
+ */
+static void sort_run_parse_threads(void* (*worker)(void*),
+    sort_parse_args_t* args, unsigned int thread_count)
 {
-    int buffer_index = 0;
-    unsigned long long array_index = 0;
-    char num_buffer[SORT_BUFF_SIZE] = {0};
+    unsigned int spawned_count = thread_count - 1; // Excludes main thread
+    pthread_t threads[thread_count];
+
+    for (unsigned int i = 0; i < spawned_count; ++i)
+    {
+        pthread_create(&threads[i], NULL, worker, (void*) &args[i + 1]);
+    }
+
+    worker((void*) &args[0]);
+
+    for (unsigned int i = 0; i < spawned_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void* sort_count_worker_thread(void* thread_args)
+{
+    sort_parse_args_t* args = (sort_parse_args_t*) thread_args;
+    ttracker_pin_thread(args->thread_index);
+
+    unsigned long long count = 0;
+
+    for (const char* position = args->start; position < args->end; ++position)
+    {
+        count += sort_is_delimiter(*position);
+    }
+
+    /* The last number doesn't need a delimiter */
+    if (args->end > args->start && !sort_is_delimiter(args->end[-1]))
+    {
+        ++count;
+    }
+
+    args->count = count;
+
+    return NULL;
+}
+
+void* sort_parse_worker_thread(void* thread_args)
+{
+    sort_parse_args_t* args = (sort_parse_args_t*) thread_args;
+    ttracker_pin_thread(args->thread_index);
+
+    const char* position = args->start;
+    unsigned long long index = 0;
     unsigned long max_number = 0;
-    char token;
 
-    while ((token = *(array_string++)))
+    while (position < args->end && index < args->count)
     {
-        switch (token)
+        position = sort_parse_number(position, args->end, &args->array[index]);
+
+        if (position == NULL)
         {
-        case ',': case '\n':
-            memory->array[array_index] = strtoul(num_buffer, NULL,
-                SORT_PARSE_BASE);
+            args->error = SORT_FAILURE;
+            return NULL;
+        }
 
-            if (memory->array[array_index] > max_number)
-            {
-                max_number = memory->array[array_index];
-            }
+        if (args->array[index] > max_number)
+        {
+            max_number = args->array[index];
+        }
 
-            memset(num_buffer, 0, buffer_index + 1);
-            buffer_index = 0;
-            ++array_index;
-            break;
+        ++index;
+    }
+
+    args->max_number = max_number;
+    args->error = position == args->end && index == args->count
+        ? SORT_SUCCESS : SORT_FAILURE;
+
+    return NULL;
+}
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            num_buffer[buffer_index] = token;
-            ++buffer_index;
+const char* sort_split_segment(const char* start, const char* end)
+{
+    while (end > start && !sort_is_delimiter(end[-1]))
+    {
+        --end;
+    }
+
+    return end;
+}
+
+int sort_parse_numbers(const char* segment, size_t length,
+    sort_memory_t* memory, unsigned long long* capacity,
+    unsigned long* max_number)
+{
+    unsigned int thread_count = memory->thread_count;
+    const char* end = segment + length;
+    sort_parse_args_t args[thread_count];
+
+    /* Split the segment into chunks, which start after a delimiter */
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        const char* start = segment + length * i / thread_count;
+
+        while (i > 0 && start < end
+            && (start == segment || !sort_is_delimiter(start[-1])))
+        {
+            ++start;
+        }
+
+        args[i].start = start;
+        args[i].thread_index = i;
+
+        if (i > 0)
+        {
+            args[i - 1].end = start;
+        }
+    }
+
+    args[thread_count - 1].end = end;
+
+    sort_run_parse_threads(sort_count_worker_thread, args, thread_count);
+
+    /* Each thread parses into the slice after the previous chunks */
+    unsigned long long count = 0;
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        count += args[i].count;
+    }
+
+    if (memory->length + count > *capacity)
+    {
+        unsigned long long new_capacity = *capacity * 2;
+
+        if (new_capacity < memory->length + count)
+        {
+            new_capacity = memory->length + count;
+        }
+
+        unsigned long* array = (unsigned long*) realloc(memory->array,
+            new_capacity * sizeof(unsigned long));
+
+        if (array == NULL)
+        {
+            return SORT_FAILURE;
+        }
+
+        memory->array = array;
+        *capacity = new_capacity;
+    }
+
+    for (unsigned long long offset = memory->length, i = 0; i < thread_count;
+        ++i)
+    {
+        args[i].array = memory->array + offset;
+        offset += args[i].count;
+    }
+
+    sort_run_parse_threads(sort_parse_worker_thread, args, thread_count);
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        if (args[i].error)
+        {
+            return SORT_FAILURE;
+        }
+
+        if (args[i].max_number > *max_number)
+        {
+            *max_number = args[i].max_number;
+        }
+    }
+
+    memory->length += count;
+
+    return SORT_SUCCESS;
+}
+
+int sort_read_numbers(const char* filename, sort_memory_t* memory)
+{
+    file_stream_t stream;
+
+    if (open_file_stream(filename, &stream))
+    {
+        return SORT_FAILURE;
+    }
+
+    unsigned long long capacity = 0;
+    unsigned long max_number = 0;
+    const char* segment;
+    size_t length;
+    int error;
+
+    memory->array = NULL;
+    memory->length = 0;
+
+    while (!(error = next_file_segment(&stream, sort_split_segment, &segment,
+        &length)) && length > 0)
+    {
+        if ((error = sort_parse_numbers(segment, length, memory, &capacity,
+            &max_number)))
+        {
             break;
         }
     }
 
+    close_file_stream(&stream);
+
+    /* Keep at least one element, so the array is never NULL */
+    unsigned long* array = (unsigned long*) realloc(memory->array,
+        (memory->length > 0 ? memory->length : 1) * sizeof(unsigned long));
+
+    if (error || array == NULL)
+    {
+        free(array != NULL ? array : memory->array);
+        memory->array = NULL;
+        return SORT_FAILURE;
+    }
+
+    memory->array = array;
+
     /* Determine the max number of bits to sort */
     for (; max_number > 0; max_number >>= 1)
     {
         ++memory->max_bits;
     }
+
+    return SORT_SUCCESS;
 }
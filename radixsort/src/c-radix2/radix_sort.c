@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <ttracker.h>
 
@@ -14,7 +15,10 @@
 #define TTRACKER_TOTAL   4 ///< Total events tracked
 
 /**
- * Reads a number list from argv and sorts the list using radix sort
+ * Reads a number list from argv and sorts the list using radix sort. With
+ * --repeat N and --warmup K, the list is sorted K + N times and the last N
+ * sorts are measured. A parsed text file is cached in a binary sidecar,
+ * which later runs map instead (see DBENCH_INPUT_CACHE)
  *
  * @param argc Argument count
  * @param argv Argument strings
@@ -27,9 +31,14 @@ int main(int argc, char* argv[])
     ttracker_init(&ttracker, ttracker_events, TTRACKER_TOTAL);
     ttracker_start(&ttracker, TTRACKER_MAIN);
 
-    if (argc < 2 || argc > 3)
+    unsigned int repeat;
+    unsigned int warmup;
+
+    if (ttracker_parse_repeat(&argc, argv, &repeat, &warmup)
+        || argc < 2 || argc > 3)
     {
-        printf("Usage: %s array_file [thread_count=1]\n", argv[0]);
+        printf("Usage: %s [--repeat N] [--warmup K] array_file "
+            "[thread_count=1]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
@@ -46,44 +55,120 @@ int main(int argc, char* argv[])
         }
     }
 
-    ttracker_start(&ttracker, TTRACKER_PARSE);
-    char* array_string = read_file(argv[1]);
-
-    if (array_string == NULL)
+    if (ttracker_init_threads(&ttracker, thread_count)
+        || ttracker_init_samples(&ttracker, repeat))
     {
-        printf("Could not read array_file!\n");
+        printf("Could not initialize time tracker!\n");
         return EXIT_FAILURE;
     }
 
+    ttracker_start(&ttracker, TTRACKER_PARSE);
     sort_memory_t memory;
+    array_file_t array_file = {0};
+    int write_cache = 0;
+    char* sidecar = NULL;
+    int binary = is_array_file(argv[1]);
 
-    if (sort_init_memory(array_string, &memory, thread_count))
+    if (!binary && input_cache_enabled())
     {
-        printf("Could not initialize sort memory!\n");
-        free(array_string);
-        return EXIT_FAILURE;
+        sidecar = input_cache_find(argv[1], ARRAY_CACHE_SUFFIX);
     }
 
-    free(array_string);
+    if (binary || sidecar != NULL)
+    {
+        /* Binary array files and their sidecars are mapped, not parsed */
+        int error = map_array_file(binary ? argv[1] : sidecar, &array_file);
+        free(sidecar);
+
+        if (error)
+        {
+            printf("Could not map array_file!\n");
+            return EXIT_FAILURE;
+        }
+
+        if (sort_init_memory_mapped(&array_file, &memory, thread_count))
+        {
+            printf("Could not initialize sort memory!\n");
+            unmap_array_file(&array_file);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        /* Text array files are read and parsed at the same time */
+        if (sort_init_memory(argv[1], &memory, thread_count))
+        {
+            printf("Could not read array_file!\n");
+            return EXIT_FAILURE;
+        }
+
+        write_cache = input_cache_enabled();
+    }
     ttracker_stop(&ttracker,TTRACKER_PARSE);
 
-    ttracker_start(&ttracker, TTRACKER_SORT);
-    sort(&memory);
-    ttracker_stop(&ttracker, TTRACKER_SORT);
+    /* The sidecar is written before sorting and outside of the events */
+    if (write_cache)
+    {
+        write_array_cache(argv[1], memory.array, memory.length);
+    }
+
+    /* Untouched copy of the array for repetitions */
+    unsigned long* original = NULL;
+
+    if (warmup + repeat > 1)
+    {
+        original = (unsigned long*) malloc(
+            memory.length * sizeof(unsigned long));
+
+        if (original == NULL)
+        {
+            printf("Could not copy array!\n");
+            sort_cleanup_memory(&memory);
+            unmap_array_file(&array_file);
+            return EXIT_FAILURE;
+        }
+
+        memcpy(original, memory.array, memory.length * sizeof(unsigned long));
+    }
+
+    for (unsigned int i = 0; i < warmup + repeat; ++i)
+    {
+        if (i > 0)
+        {
+            memcpy(memory.array, original,
+                memory.length * sizeof(unsigned long));
+        }
+
+        ttracker_reset_threads(&ttracker);
+        ttracker_start(&ttracker, TTRACKER_SORT);
+        sort(&memory, &ttracker, TTRACKER_SORT);
+        ttracker_stop(&ttracker, TTRACKER_SORT);
+
+        if (i >= warmup)
+        {
+            ttracker_add_sample(&ttracker, TTRACKER_SORT);
+        }
+    }
+
+    free(original);
 
     ttracker_start(&ttracker, TTRACKER_VERIFY);
     if (sort_verify_sorted(&memory))
     {
         printf("Could not sort array!\n");
         sort_cleanup_memory(&memory);
+        unmap_array_file(&array_file);
         return EXIT_FAILURE;
     }
     ttracker_stop(&ttracker, TTRACKER_VERIFY);
 
     sort_cleanup_memory(&memory);
+    unmap_array_file(&array_file);
 
     ttracker_stop(&ttracker, TTRACKER_MAIN);
+    ttracker_merge_threads(&ttracker);
     ttracker_print_sec(&ttracker);
+    ttracker_cleanup(&ttracker);
 
     return EXIT_SUCCESS;
 }
@@ -5,21 +5,61 @@
 
 #include "sort_utils.h"
 
-int sort_init_memory(const char* array_string, sort_memory_t* memory,
+int sort_init_memory(const char* filename, sort_memory_t* memory,
     unsigned int thread_count)
 {
     memory->thread_count = thread_count;
     memory->length = 0;
     memory->max_bits = 0;
+    memory->mapped = NULL;
+    memory->temp = NULL;
+    memory->zero_count = NULL;
+    memory->one_count = NULL;
 
-    if (sort_check_and_parse_length(array_string, memory))
+    if (sort_read_numbers(filename, memory))
     {
         return SORT_FAILURE;
     }
 
-    memory->array = (unsigned long*) malloc (
+    memory->temp = (unsigned long*) malloc (
         memory->length * sizeof(unsigned long));
 
+    memory->zero_count = (sort_count_t*) malloc (
+        thread_count * sizeof(sort_count_t));
+
+    memory->one_count = (sort_count_t*) malloc (
+        thread_count * sizeof(sort_count_t));
+
+    if (memory->array == NULL || memory->temp == NULL
+        || memory->zero_count == NULL || memory->one_count == NULL)
+    {
+        sort_cleanup_memory(memory);
+        return SORT_FAILURE;
+    }
+
+    return SORT_SUCCESS;
+}
+
+int sort_init_memory_mapped(const array_file_t* file, sort_memory_t* memory,
+    unsigned int thread_count)
+{
+    memory->thread_count = thread_count;
+    memory->length = file->count;
+    memory->max_bits = 0;
+    memory->mapped = NULL;
+    memory->array = NULL;
+
+    if (file->element_size == sizeof(unsigned long))
+    {
+        memory->mapped = (unsigned long*) file->data;
+        memory->array = memory->mapped;
+    }
+    else
+    {
+        memory->array = (unsigned long*) malloc (
+            memory->length * sizeof(unsigned long));
+    }
+
     memory->temp = (unsigned long*) malloc (
         memory->length * sizeof(unsigned long));
 
@@ -36,20 +76,58 @@ int sort_init_memory(const char* array_string, sort_memory_t* memory,
         return SORT_FAILURE;
     }
 
-    sort_parse_numbers(array_string, memory);
+    unsigned long max_number = file->max_value;
+
+    if (memory->mapped == NULL)
+    {
+        const unsigned int* data = (const unsigned int*) file->data;
+
+        for (unsigned long long i = 0; i < memory->length; ++i)
+        {
+            memory->array[i] = data[i];
+        }
+    }
+
+    /* Scan for the biggest number, if the header doesn't contain it */
+    if (max_number == 0)
+    {
+        for (unsigned long long i = 0; i < memory->length; ++i)
+        {
+            if (memory->array[i] > max_number)
+            {
+                max_number = memory->array[i];
+            }
+        }
+    }
+
+    /* Determine the max number of bits to sort */
+    for (; max_number > 0; max_number >>= 1)
+    {
+        ++memory->max_bits;
+    }
 
     return SORT_SUCCESS;
 }
 
 void sort_cleanup_memory(sort_memory_t* memory)
 {
-    free(memory->array);
-    free(memory->temp);
+    /* The mapped array may be in temp after sorting */
+    if (memory->array != memory->mapped)
+    {
+        free(memory->array);
+    }
+
+    if (memory->temp != memory->mapped)
+    {
+        free(memory->temp);
+    }
+
     free(memory->zero_count);
     free(memory->one_count);
     
     memory->array = NULL;
     memory->temp = NULL;
+    memory->mapped = NULL;
     memory->zero_count = NULL;
     memory->one_count = NULL;
 
@@ -58,7 +136,8 @@ void sort_cleanup_memory(sort_memory_t* memory)
     memory->max_bits = 0;
 }
 
-void sort(sort_memory_t* memory)
+void sort(sort_memory_t* memory, ttracker_t* ttracker,
+    unsigned int ttracker_tid)
 {
     /* Create threads & args for every thread */
     unsigned int spawned_count = memory->thread_count - 1; // -main thread
@@ -82,6 +161,8 @@ void sort(sort_memory_t* memory)
         args[i].thread_index = i;
         args[i].memory = memory;
         args[i].barrier = &barrier;
+        args[i].ttracker = ttracker;
+        args[i].ttracker_tid = ttracker_tid;
 
         if (remaining_indizes != 0)
         {
@@ -131,13 +212,21 @@ void* sort_worker_thread(void* thread_args)
     unsigned long long zero_index;
     unsigned long long one_index;
 
+    ttracker_pin_thread(args->thread_index);
+    ttracker_thread_start(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+    ttracker_span_begin(args->ttracker, "sort", -1);
+
     /* Iterate through each bit */
     for (bit = 0; bit < memory->max_bits; ++bit)
     {
+        ttracker_span_begin(args->ttracker, "bit", bit);
         memory->zero_count[args->thread_index].count = 0;
         memory->one_count[args->thread_index].count = 0;
 
         /* Count zeroes and ones */
+        ttracker_span_begin(args->ttracker, "count", -1);
+
         for (i = args->start_index; i < args->end_index; ++i)
         {
             if (((src_array[i] >> bit) & 1) == 0)
@@ -150,12 +239,15 @@ void* sort_worker_thread(void* thread_args)
             }
         }
 
-        pthread_barrier_wait(args->barrier);
+        ttracker_span_end(args->ttracker);
+        sort_barrier_wait(args);
 
         zero_index = 0;
         one_index = 0;
 
         /* Calculate index offset */
+        ttracker_span_begin(args->ttracker, "offset", -1);
+
         for (i = 0; i < args->thread_index; ++i)
         {
             zero_index += memory->zero_count[i].count;
@@ -169,9 +261,12 @@ void* sort_worker_thread(void* thread_args)
             one_index += memory->zero_count[i].count;
         }
 
-        pthread_barrier_wait(args->barrier);
+        ttracker_span_end(args->ttracker);
+        sort_barrier_wait(args);
 
         /* Write back new order */
+        ttracker_span_begin(args->ttracker, "scatter", -1);
+
         for (i = args->start_index; i < args->end_index; ++i)
         {
             if (((src_array[i] >> bit) & 1) == 0)
@@ -186,7 +281,9 @@ void* sort_worker_thread(void* thread_args)
             }
         }
 
-        pthread_barrier_wait(args->barrier);
+        ttracker_span_end(args->ttracker);
+        sort_barrier_wait(args);
+        ttracker_span_end(args->ttracker);
 
         /* Swap arrays */
         temp = src_array;
@@ -194,9 +291,21 @@ void* sort_worker_thread(void* thread_args)
         dest_array = temp;
     }
 
+    ttracker_span_end(args->ttracker);
+    ttracker_thread_stop(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+
     return NULL;
 }
 
+void sort_barrier_wait(const sort_args_t* args)
+{
+    ttracker_wait_begin(args->ttracker, args->thread_index,
+        args->ttracker_tid);
+    pthread_barrier_wait(args->barrier);
+    ttracker_wait_end(args->ttracker, args->thread_index, args->ttracker_tid);
+}
+
 int sort_verify_sorted(const sort_memory_t* memory)
 {
     if (memory->length <= 1)
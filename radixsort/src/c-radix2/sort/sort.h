@@ -3,6 +3,10 @@
 
 #include <pthread.h>
 
+#include <ttracker.h>
+
+#include "../file/file_utils.h"
+
 /* Defines for sort return codes */
 #define SORT_SUCCESS 0x0 ///< Success
 #define SORT_FAILURE 0x1 ///< Failure
@@ -23,6 +27,7 @@ typedef struct _sort_memory_t
 {
     unsigned long* array;       ///< Array to be sorted
     unsigned long* temp;        ///< Temporary swapping array
+    unsigned long* mapped;      ///< Mapped array (not freed) or NULL
     sort_count_t* zero_count;   ///< Zero count array
     sort_count_t* one_count;    ///< One count array
     unsigned int thread_count;  ///< Number of threads
@@ -40,17 +45,33 @@ typedef struct _sort_args_t
     unsigned int thread_index;      ///< Index of the thread
     sort_memory_t* memory;          ///< Memory of radix sort
     pthread_barrier_t* barrier;     ///< Barrier for synchronization
+    ttracker_t* ttracker;           ///< Tracker for per-thread times
+    unsigned int ttracker_tid;      ///< Event index of the sort phase
 } sort_args_t;
 
 /**
- * Initializes the radix sort memory
+ * Initializes the radix sort memory with a text array file, which is read
+ * and parsed at the same time
+ *
+ * @param filename Name of the array file
+ * @param memory Memory to be initialized
+ * @param thread_count Threads to use for sorting
+ * @return SORT_SUCCESS, if successful
+ */
+int sort_init_memory(const char* filename, sort_memory_t* memory,
+    unsigned int thread_count);
+
+/**
+ * Initializes the radix sort memory with a mapped binary array file. If the
+ * file has 8-byte elements, they are sorted in place in the mapping.
+ * Otherwise they are widened into a new array
  *
- * @param array_string Array as string
+ * @param file Mapped binary array file
  * @param memory Memory to be initialized
  * @param thread_count Threads to use for sorting
  * @return SORT_SUCCESS, if successful
  */
-int sort_init_memory(const char* array_string, sort_memory_t* memory,
+int sort_init_memory_mapped(const array_file_t* file, sort_memory_t* memory,
     unsigned int thread_count);
 
 /**
@@ -64,8 +85,11 @@ void sort_cleanup_memory(sort_memory_t* memory);
  * Sorts the array in the memory using radix sort
  *
  * @param memory Memory for sorting
+ * @param ttracker Tracker for the per-thread sort times
+ * @param ttracker_tid Event index of the sort phase
  */
-void sort(sort_memory_t* memory);
+void sort(sort_memory_t* memory, ttracker_t* ttracker,
+    unsigned int ttracker_tid);
 
 /**
  * Represents a worker unit for sorting
@@ -75,6 +99,14 @@ void sort(sort_memory_t* memory);
  */
 void* sort_worker_thread(void* thread_args);
 
+/**
+ * Waits at the barrier of the worker threads. The wait is added to the
+ * wait histogram of the thread
+ *
+ * @param args Sorting arguments of the calling thread
+ */
+void sort_barrier_wait(const sort_args_t* args);
+
 /**
  * Verifies that the array is sorted
  *
@@ -4,30 +4,75 @@
 #include "sort.h"
 
 /* Defines for parsing */
-#define TOKEN_BREAK     0x01 ///< ',' or ' ' or '\n' is expected
-#define TOKEN_NUMBER    0x02 ///< A number is expected
-#define SORT_PARSE_BASE 0x0A ///< Use base 10 for converting numbers
+#define SORT_SIMD_WIDTH       16 ///< Bytes of a SIMD register for parsing
 
-/* Defines for sizes */
-#define SORT_BUFF_SIZE  0x20 ///< Buffer size for converting chars to nums
+/**
+ * Arguments for a parser thread. The chunk of the array string starts after
+ * a ',' or '\n', so it contains whole numbers only
+ */
+typedef struct _sort_parse_args_t
+{
+    const char* start;         ///< First char of the chunk
+    const char* end;           ///< End of the chunk
+    unsigned long* array;      ///< Slice of the array for the chunk
+    unsigned long long count;  ///< Number count of the chunk
+    unsigned long max_number;  ///< Biggest number of the chunk
+    unsigned int thread_index; ///< Index of the thread
+    int error;                 ///< SORT_SUCCESS, if the chunk is valid
+} sort_parse_args_t;
+
+/**
+ * Counts the numbers of a chunk by its delimiters
+ *
+ * @param thread_args Parser arguments
+ * @return NULL
+ */
+void* sort_count_worker_thread(void* thread_args);
+
+/**
+ * Parses and validates the numbers of a chunk into its slice of the array
+ *
+ * @param thread_args Parser arguments
+ * @return NULL
+ */
+void* sort_parse_worker_thread(void* thread_args);
+
+/**
+ * Finds the end of the last complete number of a segment of the array file
+ *
+ * @param start First char of the segment
+ * @param end End of the segment
+ * @return Position after the last delimiter, start if there is none
+ */
+const char* sort_split_segment(const char* start, const char* end);
 
 /**
- * Checks the array_string and sets the memory length
+ * Parses a segment of the array file and appends its numbers to the array.
+ * The segment is split into one chunk per thread. The threads count the
+ * numbers of their chunks first and then parse them into their slices
+ * behind the numbers of the previous segments. The array grows by doubling
  *
- * @param array_string Array as string
- * @param memory The memory to set the length
+ * @param segment First char of the segment
+ * @param length Length of the segment
+ * @param memory The memory for the numbers array
+ * @param capacity Capacity of the array in numbers
+ * @param max_number Biggest number parsed so far
  * @return SORT_SUCCESS, if successful
  */
-int sort_check_and_parse_length(const char* array_string,
-    sort_memory_t* memory);
+int sort_parse_numbers(const char* segment, size_t length,
+    sort_memory_t* memory, unsigned long long* capacity,
+    unsigned long* max_number);
 
 /**
- * Parses the array_string and fills the numbers array. Needs
- * the memory length parameter and a malloc'd array.
+ * Reads the array file with a file stream and parses each segment, while
+ * the next ones are read. Only the array and the buffers of the stream are
+ * in memory, not the whole file. Allocates the array and sets the length
+ * and the max bits of the memory
  *
- * @param array_string Array as string
+ * @param filename Name of the array file
  * @param memory The memory for the numbers array
+ * @return SORT_SUCCESS, if successful
  */
-void sort_parse_numbers(const char* array_string, sort_memory_t* memory);
+int sort_read_numbers(const char* filename, sort_memory_t* memory);
 
 #endif
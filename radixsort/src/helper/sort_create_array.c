@@ -1,39 +1,541 @@
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <sys/random.h>
 
-#define BYTE_COUNT 4
-#define BUFF_SIZE 32
+#define BUFF_SIZE   (4 << 20) ///< Output buffer of every thread in bytes
+#define NUMBER_SIZE 32        ///< Longest formatted number with separator
+
+/* Defines for the Philox4x32-10 generator */
+#define PHILOX_ROUNDS 10          ///< Rounds per counter
+#define PHILOX_M0     0xD2511F53U ///< Multiplier of the first word
+#define PHILOX_M1     0xCD9E8D57U ///< Multiplier of the third word
+#define PHILOX_W0     0x9E3779B9U ///< Key increment of the first word
+#define PHILOX_W1     0xBB67AE85U ///< Key increment of the second word
+
+/* Defines for the distributions of the elements */
+#define DIST_UNIFORM        0  ///< Random in [0; 2^32 - 1]
+#define DIST_SORTED         1  ///< Ascending
+#define DIST_REVERSE        2  ///< Descending
+#define DIST_ORGAN_PIPE     3  ///< Ascending, then descending
+#define DIST_SAWTOOTH       4  ///< SAWTOOTH_TEETH ascending runs
+#define DIST_FEW_UNIQUE     5  ///< Random out of FEW_UNIQUE_VALUES values
+#define DIST_ALL_EQUAL      6  ///< One value
+#define DIST_ZIPF           7  ///< Zipf distributed with exponent 1
+#define DIST_MEDIAN3_KILLER 8  ///< Musser's median-of-3 killer sequence
+#define DIST_FULL64         9  ///< Random in [0; 2^64 - 1]
+#define DIST_SMALL_RANGE    10 ///< Random in [0; 2^SMALL_RANGE_BITS - 1]
+#define DIST_COUNT          11 ///< Number of distributions
+
+#define SAWTOOTH_TEETH      16 ///< Runs of the sawtooth distribution
+#define FEW_UNIQUE_VALUES   16 ///< Values of the few-unique distribution
+#define SMALL_RANGE_BITS    8  ///< Bits of the small-range distribution
+#define ZIPF_BITS           32 ///< Zipf ranks are in [1; 2^ZIPF_BITS]
+
+/**
+ * Names of the distributions for --distribution, indexed by DIST_*
+ */
+static const char* const distribution_names[DIST_COUNT] = {
+    "uniform", "sorted", "reverse", "organ-pipe", "sawtooth", "few-unique",
+    "all-equal", "zipf", "median3-killer", "full64", "small-range"
+};
+
+/* Defines for binary array files, see file/file_utils.h of the programs */
+#define ARRAY_FILE_MAGIC       "DBARRAY1" ///< First bytes of the file
+#define ARRAY_FILE_MAGIC_SIZE  8          ///< Size of the magic in bytes
+
+/**
+ * Header of a binary array file. The elements follow the header directly
+ * as little-endian unsigned integers of element_size bytes
+ */
+typedef struct _array_file_header_t
+{
+    char magic[ARRAY_FILE_MAGIC_SIZE]; ///< ARRAY_FILE_MAGIC
+    unsigned int element_size;         ///< Element size in bytes (4 or 8)
+    unsigned int flags;                ///< Reserved, always 0
+    unsigned long long count;          ///< Number of elements
+    unsigned long long max_value;      ///< Biggest element, 0 if unknown
+    unsigned long long reserved[4];    ///< Pads the header to 64 bytes
+} array_file_header_t;
+
+/**
+ * Is used for creating the array in parallel. Every thread creates a block
+ * of elements and writes it at the offset of the block
+ */
+typedef struct _create_args_t
+{
+    unsigned long long start;     ///< First element of the block
+    unsigned long long end;       ///< End of the block
+    unsigned long long count;     ///< Elements of the array
+    unsigned long long seed;      ///< Seed of the generator
+    unsigned int distribution;    ///< DIST_* of the elements
+    unsigned int element_size;    ///< Element size in bytes, 0 for text
+    int fd;                       ///< Descriptor of the file
+    off_t offset;                 ///< Offset of the block in the file
+    unsigned long long length;    ///< Length of the block in bytes
+    unsigned long long max_value; ///< Biggest element of the block
+    int error;                    ///< EXIT_SUCCESS, if the block is written
+} create_args_t;
+
+/**
+ * Generates the random number with the given index (Philox4x32-10). The
+ * number only depends on the seed and the index, so every thread can
+ * generate any part of the array
+ *
+ * @param seed Seed of the generator
+ * @param index Index of the number
+ * @return A random number in [0; 2^64 - 1]
+ */
+static inline uint64_t random_number(uint64_t seed, uint64_t index)
+{
+    uint32_t counter[4] = { (uint32_t) index, (uint32_t) (index >> 32), 0, 0 };
+    uint32_t key[2] = { (uint32_t) seed, (uint32_t) (seed >> 32) };
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        uint64_t product0 = (uint64_t) PHILOX_M0 * counter[0];
+        uint64_t product1 = (uint64_t) PHILOX_M1 * counter[2];
+
+        counter[0] = (uint32_t) (product1 >> 32) ^ counter[1] ^ key[0];
+        counter[1] = (uint32_t) product1;
+        counter[2] = (uint32_t) (product0 >> 32) ^ counter[3] ^ key[1];
+        counter[3] = (uint32_t) product0;
+
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+
+    return ((uint64_t) counter[1] << 32) | counter[0];
+}
+
+/**
+ * Spreads a position of a sequence evenly over [0; 2^32 - 1], keeping the
+ * order of the positions
+ *
+ * @param position Position in the sequence
+ * @param length Length of the sequence
+ * @return The spread position
+ */
+static inline uint64_t spread(uint64_t position, uint64_t length)
+{
+    return (uint64_t) (((unsigned __int128) position << 32) / length);
+}
+
+/**
+ * Generates an element of Musser's median-of-3 killer sequence, which is a
+ * permutation of [1; count] for counts divisible by 4. Quicksorts taking
+ * the median of the first, middle and last element as pivot split off only
+ * two elements per partitioning step. An odd count ends with the biggest
+ * element
+ *
+ * @param index Index of the element
+ * @param count Elements of the array
+ * @return The element in [1; count]
+ */
+static inline uint64_t median3_killer(uint64_t index, uint64_t count)
+{
+    const uint64_t half = count / 2;
+
+    if (index >= 2 * half)
+    {
+        return count;
+    }
+
+    if (index >= half)
+    {
+        return 2 * (index - half + 1);
+    }
+
+    return index % 2 == 0 ? index + 1 : half + index;
+}
+
+/**
+ * Generates a Zipf distributed rank with exponent 1, so P(rank) ~ 1/rank,
+ * by rejection-inversion (Hoermann and Derflinger). A point is drawn by
+ * inverting the integral H(x) = log(x) of 1/x and its rounded rank is
+ * rejected, if the point falls outside the area of the rank. Further
+ * attempts use the seeds seed + 1, seed + 2, ..., so the rank still only
+ * depends on the seed and the index
+ *
+ * @param seed Seed of the generator
+ * @param index Index of the element
+ * @return The rank in [1; 2^ZIPF_BITS]
+ */
+static inline uint64_t zipf_rank(uint64_t seed, uint64_t index)
+{
+    const double ranks = ldexp(1.0, ZIPF_BITS);
+    const double area_first = log(1.5) - 1.0;     // H(1.5) - 1/1
+    const double area_last = log(ranks + 0.5);    // H(ranks + 0.5)
+    const double squeeze = 2.0 - exp(log(2.5) - 0.5);
+
+    for (uint64_t attempt = 0;; ++attempt)
+    {
+        double uniform = (random_number(seed + attempt, index) >> 11)
+            * 0x1.0p-53;
+        double area = area_last + uniform * (area_first - area_last);
+        double point = exp(area);
+        double rank = floor(point + 0.5);
+
+        if (rank < 1.0)
+        {
+            rank = 1.0;
+        }
+        else if (rank > ranks)
+        {
+            rank = ranks;
+        }
+
+        if (rank - point <= squeeze || area >= log(rank + 0.5) - 1.0 / rank)
+        {
+            return (uint64_t) rank;
+        }
+    }
+}
+
+/**
+ * Generates the element with the given index of the distribution. Every
+ * element only depends on the seed, the index and the count, so every
+ * thread can generate any part of the array
+ *
+ * @param args Creator arguments
+ * @param index Index of the element
+ * @return The element
+ */
+static inline uint64_t element(const create_args_t* args, uint64_t index)
+{
+    const uint64_t count = args->count;
+
+    switch (args->distribution)
+    {
+    case DIST_SORTED:
+        return spread(index, count);
+    case DIST_REVERSE:
+        return spread(count - 1 - index, count);
+    case DIST_ORGAN_PIPE:
+    {
+        uint64_t position = index < count - 1 - index
+            ? index : count - 1 - index;
+        return spread(position, (count + 1) / 2);
+    }
+    case DIST_SAWTOOTH:
+    {
+        uint64_t period = (count + SAWTOOTH_TEETH - 1) / SAWTOOTH_TEETH;
+        return spread(index % period, period);
+    }
+    case DIST_FEW_UNIQUE:
+        return (uint32_t) random_number(~args->seed,
+            random_number(args->seed, index) % FEW_UNIQUE_VALUES);
+    case DIST_ALL_EQUAL:
+        return (uint32_t) random_number(~args->seed, 0);
+    case DIST_ZIPF:
+        return zipf_rank(args->seed, index) - 1;
+    case DIST_MEDIAN3_KILLER:
+        return spread(median3_killer(index, count) - 1, count);
+    case DIST_FULL64:
+        return random_number(args->seed, index);
+    case DIST_SMALL_RANGE:
+        return random_number(args->seed, index)
+            & ((1U << SMALL_RANGE_BITS) - 1);
+    default:
+        return (uint32_t) random_number(args->seed, index);
+    }
+}
+
+/**
+ * Two digit strings for the numbers 0 to 99
+ */
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+/**
+ * Counts the decimal digits of a number
+ *
+ * @param number The number
+ * @return Number of digits
+ */
+static inline int count_digits(unsigned long long number)
+{
+    int digits = 1;
+
+    for (unsigned long long limit = 10; digits < 20 && number >= limit;
+        limit *= 10)
+    {
+        ++digits;
+    }
+
+    return digits;
+}
+
+/**
+ * Formats the digits of a number with two digits per division, from the
+ * last to the first
+ *
+ * @param number The number
+ * @param digits Number of digits, see count_digits
+ * @param buffer Target with room for the digits
+ */
+static inline void format_digits(unsigned long long number, int digits,
+    char* buffer)
+{
+    char* position = buffer + digits;
+
+    while (number >= 100)
+    {
+        position -= 2;
+        memcpy(position, digit_pairs + number % 100 * 2, 2);
+        number /= 100;
+    }
+
+    if (number >= 10)
+    {
+        memcpy(position - 2, digit_pairs + number * 2, 2);
+    }
+    else
+    {
+        position[-1] = '0' + number;
+    }
+}
 
 /**
- * Generates a random number in [0; 4,294,967,295]
+ * Formats an element and its separator, a ',' or the final '\n'
  *
- * @param min Minimum number
- * @param max Maximum number
- * @return A random number
+ * @param args Creator arguments
+ * @param index Index of the element
+ * @param buffer Target with room for NUMBER_SIZE chars
+ * @return Number of chars written
  */
-static inline unsigned long random_number()
+static inline int format_element(const create_args_t* args,
+    unsigned long long index, char* buffer)
 {
-    unsigned char bytes[BYTE_COUNT];
-    getrandom(&bytes, BYTE_COUNT, 0);
-    unsigned long num = 0;
+    unsigned long long number = element(args, index);
+    int length = count_digits(number);
+
+    format_digits(number, length, buffer);
+    buffer[length] = index != args->count - 1 ? ',' : '\n';
+
+    return length + 1;
+}
 
-    for (int i = 0; i < BYTE_COUNT; ++i)
+/**
+ * Writes a buffer completely at an offset
+ *
+ * @param fd Descriptor of the file
+ * @param buffer The buffer
+ * @param length Length of the buffer
+ * @param offset Offset in the file
+ * @return EXIT_SUCCESS, if successful
+ */
+static int write_at(int fd, const char* buffer, size_t length, off_t offset)
+{
+    while (length > 0)
     {
-        num |= bytes[i];
+        ssize_t written = pwrite(fd, buffer, length, offset);
 
-        if (i < BYTE_COUNT - 1)
+        if (written <= 0)
         {
-            num <<= 8;
+            return EXIT_FAILURE;
         }
+
+        buffer += written;
+        length -= written;
+        offset += written;
     }
 
-    return num;
+    return EXIT_SUCCESS;
 }
 
 /**
- * Reads parameters from argv and creates a matrix file
+ * Counts the text length of a block without writing it
+ *
+ * @param thread_args Creator arguments
+ * @return NULL
+ */
+static void* count_worker_thread(void* thread_args)
+{
+    create_args_t* args = (create_args_t*) thread_args;
+    unsigned long long length = 0;
+
+    for (unsigned long long i = args->start; i < args->end; ++i)
+    {
+        length += count_digits(element(args, i)) + 1;
+    }
+
+    args->length = length;
+
+    return NULL;
+}
+
+/**
+ * Creates a block as text or binary and writes it at its offset
+ *
+ * @param thread_args Creator arguments
+ * @return NULL
+ */
+static void* write_worker_thread(void* thread_args)
+{
+    create_args_t* args = (create_args_t*) thread_args;
+    char* buffer = (char*) malloc(BUFF_SIZE);
+    size_t length = 0;
+    off_t offset = args->offset;
+    unsigned long long max_value = 0;
+
+    args->error = EXIT_FAILURE;
+
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+
+    for (unsigned long long i = args->start; i < args->end; ++i)
+    {
+        if (length + NUMBER_SIZE > BUFF_SIZE)
+        {
+            if (write_at(args->fd, buffer, length, offset))
+            {
+                free(buffer);
+                return NULL;
+            }
+
+            offset += length;
+            length = 0;
+        }
+
+        if (args->element_size == 0)
+        {
+            length += format_element(args, i, buffer + length);
+            continue;
+        }
+
+        unsigned long long number = element(args, i);
+        max_value = number > max_value ? number : max_value;
+
+        /* The elements are little-endian like the CPU */
+        memcpy(buffer + length, &number, args->element_size);
+        length += args->element_size;
+    }
+
+    if (write_at(args->fd, buffer, length, offset) == EXIT_SUCCESS)
+    {
+        args->error = EXIT_SUCCESS;
+    }
+
+    args->max_value = max_value;
+    free(buffer);
+
+    return NULL;
+}
+
+/**
+ * Runs the worker function for every block. The main thread works on the
+ * first one
+ *
+ * @param worker Worker function
+ * @param args Creator arguments for every thread
+ * @param thread_count Number of threads
+ */
+static void run_threads(void* (*worker)(void*), create_args_t* args,
+    unsigned int thread_count)
+{
+    pthread_t threads[thread_count];
+
+    for (unsigned int i = 1; i < thread_count; ++i)
+    {
+        pthread_create(&threads[i], NULL, worker, &args[i]);
+    }
+
+    worker(&args[0]);
+
+    for (unsigned int i = 1; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/**
+ * Creates the array in parallel. Text is created in two passes: the
+ * threads count the length of their blocks first, so that every block can
+ * be written at its offset in the second pass. Binary blocks have a fixed
+ * size. The header of a binary file is written in the end
+ *
+ * @param fd Descriptor of the file
+ * @param count Number of elements
+ * @param seed Seed of the generator
+ * @param distribution DIST_* of the elements
+ * @param element_size Element size in bytes (4 or 8), 0 for text
+ * @param thread_count Number of threads
+ * @return EXIT_SUCCESS, if successful
+ */
+static int create_array(int fd, unsigned long long count,
+    unsigned long long seed, unsigned int distribution,
+    unsigned int element_size, unsigned int thread_count)
+{
+    create_args_t args[thread_count];
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        args[i].start = count * i / thread_count;
+        args[i].end = count * (i + 1) / thread_count;
+        args[i].count = count;
+        args[i].seed = seed;
+        args[i].distribution = distribution;
+        args[i].element_size = element_size;
+        args[i].fd = fd;
+        args[i].offset = sizeof(array_file_header_t)
+            + args[i].start * element_size;
+    }
+
+    if (element_size == 0)
+    {
+        run_threads(count_worker_thread, args, thread_count);
+        args[0].offset = 0;
+
+        for (unsigned int i = 1; i < thread_count; ++i)
+        {
+            args[i].offset = args[i - 1].offset + args[i - 1].length;
+        }
+    }
+
+    run_threads(write_worker_thread, args, thread_count);
+
+    array_file_header_t header = {0};
+    memcpy(header.magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE);
+    header.element_size = element_size;
+    header.count = count;
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        if (args[i].error)
+        {
+            return EXIT_FAILURE;
+        }
+
+        if (args[i].max_value > header.max_value)
+        {
+            header.max_value = args[i].max_value;
+        }
+    }
+
+    if (element_size == 0)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    return write_at(fd, (const char*) &header, sizeof(header), 0);
+}
+
+/**
+ * Reads parameters from argv and creates an array file. With --binary
+ * WIDTH, a binary array file with WIDTH-byte elements is created, which
+ * the sort programs map instead of parsing it. --distribution NAME selects
+ * the distribution of the elements (see distribution_names). The same
+ * --seed always creates the same elements, independent of --threads
  *
  * @param argc Argument count
  * @param argv Argument strings
@@ -41,31 +543,125 @@ static inline unsigned long random_number()
  */
 int main(int argc, char *argv[])
 {
-    if (argc != 3)
+    unsigned int element_size = 0; // 0 = text file
+    unsigned int distribution = DIST_UNIFORM;
+    unsigned long long seed;
+    int seeded = 0;
+    long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int arg = 1;
+
+    /* Options come before the length */
+    while (arg + 1 < argc && strncmp(argv[arg], "--", 2) == 0)
     {
-        printf("Usage: %s length filename\n", argv[0]);
+        if (strcmp(argv[arg], "--binary") == 0)
+        {
+            element_size = atoi(argv[arg + 1]);
+
+            if (element_size != 4 && element_size != 8)
+            {
+                printf("Invalid width. Use 4 or 8!\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[arg], "--distribution") == 0)
+        {
+            distribution = 0;
+
+            while (distribution < DIST_COUNT && strcmp(argv[arg + 1],
+                distribution_names[distribution]) != 0)
+            {
+                ++distribution;
+            }
+
+            if (distribution == DIST_COUNT)
+            {
+                printf("Invalid distribution. Use one of:");
+
+                for (unsigned int i = 0; i < DIST_COUNT; ++i)
+                {
+                    printf(" %s", distribution_names[i]);
+                }
+
+                printf("\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[arg], "--seed") == 0)
+        {
+            seed = strtoull(argv[arg + 1], NULL, 0);
+            seeded = 1;
+        }
+        else if (strcmp(argv[arg], "--threads") == 0)
+        {
+            thread_count = atol(argv[arg + 1]);
+
+            if (thread_count <= 0)
+            {
+                printf("Invalid thread count. Use at least 1!\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        arg += 2;
+    }
+
+    if (argc - arg != 2)
+    {
+        printf("Usage: %s [--binary 4|8] [--distribution NAME] [--seed S] "
+            "[--threads N] length filename\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (distribution == DIST_FULL64 && element_size == 4)
+    {
+        printf("The distribution full64 requires a width of 8!\n");
         return EXIT_FAILURE;
     }
 
-    const unsigned long long length = strtoull(argv[1], NULL, 10);
-    const char* filename = argv[2];
-    char buffer[BUFF_SIZE] = {0};
+    const unsigned long long length = strtoull(argv[arg], NULL, 10);
+    const char* filename = argv[arg + 1];
 
-    FILE *fp = fopen(filename, "w");
-    for (unsigned long long l = 0; l < length; ++l)
+    if (length == 0)
     {
-        sprintf(buffer, "%lu", random_number());
-        fputs(buffer, fp);
-        memset(buffer, 0, BUFF_SIZE);
+        printf("Invalid length. Use at least 1!\n");
+        return EXIT_FAILURE;
+    }
 
-        if (l != length - 1)
-        {
-            fputc(',', fp);
-        }
+    if (!seeded && getrandom(&seed, sizeof(seed), 0) != sizeof(seed))
+    {
+        printf("Could not create a seed!\n");
+        return EXIT_FAILURE;
     }
 
-    fputc('\n', fp);
+    if ((unsigned long long) thread_count > length)
+    {
+        thread_count = length;
+    }
 
-    fclose(fp);
-    return EXIT_SUCCESS;
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        printf("Could not open %s!\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    int result = create_array(fd, length, seed, distribution,
+        element_size, thread_count);
+
+    if (close(fd) != 0)
+    {
+        result = EXIT_FAILURE;
+    }
+
+    if (result != EXIT_SUCCESS)
+    {
+        printf("Could not write %s!\n", filename);
+    }
+
+    return result;
 }
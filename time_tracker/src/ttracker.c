@@ -1,50 +1,1634 @@
+#define _GNU_SOURCE
+
 #include <time.h>
+#include <ctype.h>
+#include <sched.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TTRACKER_HAS_TSC 1
+#else
+#define TTRACKER_HAS_TSC 0
+#endif
+
+/* The library itself always implements the tracking */
+#undef TTRACKER_DISABLE
+#include "ttracker.h"
+
+/**
+ * Type and config of every hardware counter, indexed by TTRACKER_CYCLES etc.
+ */
+static const struct
+{
+    unsigned int type;          ///< perf_event type
+    unsigned long long config;  ///< perf_event config
+} ttracker_counter_configs[TTRACKER_COUNTER_COUNT] =
+{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+};
+
+/**
+ * Represents a span, that was begun but not yet ended
+ */
+typedef struct _ttracker_open_span_t
+{
+    const char* name; ///< Name of the span
+    long long id;     ///< Appended to the name, if not negative
+    long long start;  ///< Start of span
+} ttracker_open_span_t;
+
+/* Span stack of the calling thread */
+static __thread ttracker_open_span_t ttracker_open_spans[TTRACKER_SPAN_DEPTH];
+static __thread unsigned int ttracker_open_span_count = 0;
+static __thread int ttracker_thread_id = 0;
+
+/**
+ * Topology of a CPU, used to order the CPUs for pinning
+ */
+typedef struct _ttracker_cpu_t
+{
+    int cpu;        ///< Logical CPU number
+    int node;       ///< NUMA node, or package without NUMA information
+    int package;    ///< Physical package (socket)
+    int core;       ///< Core id within the package
+    int sibling;    ///< Index among the hardware threads of its core
+    int rank;       ///< Index of its core within its node
+} ttracker_cpu_t;
+
+/* CPUs in pinning order, computed once for all threads */
+static int* ttracker_affinity_cpus = NULL;
+static int ttracker_affinity_cpu_count = 0;
+static pthread_once_t ttracker_affinity_once = PTHREAD_ONCE_INIT;
+
+/* Affinity mask of the process before any thread was pinned */
+static cpu_set_t ttracker_process_affinity;
+
+/* Thread index, that the calling thread is pinned as, or -1 */
+static __thread long long ttracker_pinned_index = -1;
+
+/**
+ * Returns the events of a thread slot
+ *
+ * @param tracker The tracker to use
+ * @param thread_index The slot index
+ * @return Pointer to the first event of the slot
+ */
+static inline ttracker_thread_event_t* ttracker_thread_events(
+    const ttracker_t* tracker, unsigned int thread_index)
+{
+    return (ttracker_thread_event_t*) ((char*) tracker->thread_slots
+        + thread_index * tracker->thread_slot_size);
+}
+
+/**
+ * Returns the wait histograms of a thread slot, which follow its events
+ *
+ * @param tracker The tracker to use
+ * @param thread_index The slot index
+ * @return Pointer to the first wait histogram of the slot
+ */
+static inline ttracker_wait_t* ttracker_thread_waits(
+    const ttracker_t* tracker, unsigned int thread_index)
+{
+    return (ttracker_wait_t*) (ttracker_thread_events(tracker, thread_index)
+        + tracker->event_count);
+}
+
+/**
+ * Reads CLOCK_MONOTONIC_RAW
+ *
+ * @param nsec Target for the time in nanoseconds
+ * @return TTRACKER_SUCCESS, if successful
+ */
+static inline int ttracker_clock_nsec(long long* nsec)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC_RAW, &ts) != 0)
+    {
+        *nsec = 0;
+        return TTRACKER_FAILURE;
+    }
+
+    *nsec = (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+    return TTRACKER_SUCCESS;
+}
+
+/**
+ * Reads the timer at the start of an interval. The fence keeps earlier
+ * instructions from being executed after the TSC is read
+ *
+ * @param tracker The tracker to use
+ * @param ticks Target for the current time in ticks
+ * @return TTRACKER_SUCCESS, if successful
+ */
+static inline int ttracker_ticks_start(const ttracker_t* tracker,
+    long long* ticks)
+{
+#if TTRACKER_HAS_TSC
+    if (tracker->tsc_enabled)
+    {
+        _mm_lfence();
+        *ticks = (long long) __rdtsc();
+        return TTRACKER_SUCCESS;
+    }
+#endif
+
+    return ttracker_clock_nsec(ticks);
+}
+
+/**
+ * Reads the timer at the stop of an interval. rdtscp waits for all earlier
+ * instructions, the fence keeps later instructions from starting before
+ *
+ * @param tracker The tracker to use
+ * @param ticks Target for the current time in ticks
+ * @return TTRACKER_SUCCESS, if successful
+ */
+static inline int ttracker_ticks_stop(const ttracker_t* tracker,
+    long long* ticks)
+{
+#if TTRACKER_HAS_TSC
+    if (tracker->tsc_enabled)
+    {
+        unsigned int aux;
+        *ticks = (long long) __rdtscp(&aux);
+        _mm_lfence();
+        return TTRACKER_SUCCESS;
+    }
+#endif
+
+    return ttracker_clock_nsec(ticks);
+}
+
+/**
+ * Converts a number of ticks into nanoseconds
+ *
+ * @param tracker The tracker to use
+ * @param ticks Ticks to convert
+ * @return Nanoseconds of the ticks
+ */
+static inline long long ttracker_ticks_to_nsec(const ttracker_t* tracker,
+    long long ticks)
+{
+    if (!tracker->tsc_enabled)
+    {
+        return ticks;
+    }
+
+    return (long long) (ticks * tracker->nsec_per_tick);
+}
+
+/**
+ * Uses the TSC as timer, if it is invariant and rdtscp is available. The
+ * TSC frequency is measured against CLOCK_MONOTONIC_RAW. Keeps
+ * clock_gettime as timer otherwise
+ *
+ * @param tracker The tracker to use
+ */
+static void ttracker_init_tsc(ttracker_t* tracker)
+{
+#if TTRACKER_HAS_TSC
+    unsigned int eax, ebx, ecx, edx;
+
+    /* Invariant TSC */
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)
+        || (edx & (1U << 8)) == 0)
+    {
+        return;
+    }
+
+    /* rdtscp */
+    if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx)
+        || (edx & (1U << 27)) == 0)
+    {
+        return;
+    }
+
+    long long nsec_start;
+    long long nsec_stop;
+    long long tick_start;
+    long long tick_stop;
+
+    if (ttracker_clock_nsec(&nsec_start) != TTRACKER_SUCCESS)
+    {
+        return;
+    }
+
+    tick_start = (long long) __rdtsc();
+
+    do
+    {
+        if (ttracker_clock_nsec(&nsec_stop) != TTRACKER_SUCCESS)
+        {
+            return;
+        }
+
+        tick_stop = (long long) __rdtsc();
+    } while (nsec_stop - nsec_start < TTRACKER_TSC_CALIBRATION);
+
+    if (tick_stop <= tick_start)
+    {
+        return;
+    }
+
+    tracker->nsec_per_tick =
+        (double) (nsec_stop - nsec_start) / (tick_stop - tick_start);
+    tracker->tick_base = tick_stop;
+    tracker->nsec_base = nsec_stop;
+    tracker->tsc_enabled = 1;
+#endif
+}
+
+/**
+ * Reads all hardware counters. Values are scaled, if the kernel had
+ * to multiplex the counters
+ *
+ * @param tracker The tracker with enabled counters
+ * @param values Target array with TTRACKER_COUNTER_COUNT elements
+ * @return TTRACKER_SUCCESS, if successful
+ */
+static int ttracker_read_counters(const ttracker_t* tracker,
+    long long* values)
+{
+    int status = TTRACKER_SUCCESS;
+
+    for (int i = 0; i < TTRACKER_COUNTER_COUNT; ++i)
+    {
+        /* Value, time enabled and time running */
+        unsigned long long data[3] = {0};
+
+        if (read(tracker->counter_fds[i], data, sizeof(data))
+            != sizeof(data))
+        {
+            status = TTRACKER_FAILURE;
+            values[i] = 0;
+            continue;
+        }
+
+        if (data[2] != 0 && data[2] < data[1])
+        {
+            values[i] = (long long) ((double) data[0] * data[1] / data[2]);
+        }
+        else
+        {
+            values[i] = (long long) data[0];
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Closes all open hardware counters and disables them
+ *
+ * @param tracker The tracker to use
+ */
+static void ttracker_close_counters(ttracker_t* tracker)
+{
+    for (int i = 0; i < TTRACKER_COUNTER_COUNT; ++i)
+    {
+        if (tracker->counter_fds[i] != -1)
+        {
+            close(tracker->counter_fds[i]);
+            tracker->counter_fds[i] = -1;
+        }
+    }
+
+    tracker->counters_enabled = 0;
+}
+
+/**
+ * Reads the resource usage of the process. Peak RSS is in KiB, all other
+ * values are totals since the process started
+ *
+ * @param tracker The tracker with enabled resource usage
+ * @param values Target array with TTRACKER_RUSAGE_COUNT elements
+ * @return TTRACKER_SUCCESS, if successful
+ */
+static int ttracker_read_rusage(const ttracker_t* tracker, long long* values)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        memset(values, 0, TTRACKER_RUSAGE_COUNT * sizeof(long long));
+        return TTRACKER_FAILURE;
+    }
+
+    values[TTRACKER_MAX_RSS] = usage.ru_maxrss;
+    values[TTRACKER_MINOR_FAULTS] = usage.ru_minflt;
+    values[TTRACKER_MAJOR_FAULTS] = usage.ru_majflt;
+    values[TTRACKER_VOL_SWITCHES] = usage.ru_nvcsw;
+    values[TTRACKER_INVOL_SWITCHES] = usage.ru_nivcsw;
+    values[TTRACKER_MIGRATIONS] = -1;
+
+    if (tracker->migration_fd != -1)
+    {
+        unsigned long long migrations = 0;
+
+        if (read(tracker->migration_fd, &migrations, sizeof(migrations))
+            != sizeof(migrations))
+        {
+            return TTRACKER_FAILURE;
+        }
+
+        values[TTRACKER_MIGRATIONS] = (long long) migrations;
+    }
+
+    return TTRACKER_SUCCESS;
+}
+
+/**
+ * Reads a single number of a CPU from sysfs
+ *
+ * @param cpu The logical CPU number
+ * @param name File name in the topology directory of the CPU
+ * @return The number, -1 if it could not be read
+ */
+static int ttracker_read_topology(int cpu, const char* name)
+{
+    char path[PATH_MAX];
+    int value = -1;
+
+    snprintf(path, sizeof(path),
+        "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    if (fscanf(file, "%d", &value) != 1)
+    {
+        value = -1;
+    }
+
+    fclose(file);
+
+    return value;
+}
+
+/**
+ * Finds the NUMA node of a CPU, which sysfs links as nodeN in the CPU
+ * directory
+ *
+ * @param cpu The logical CPU number
+ * @return The node, -1 if it is not known
+ */
+static int ttracker_read_node(int cpu)
+{
+    char path[PATH_MAX];
+    int node = -1;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR* dir = opendir(path);
+
+    if (dir == NULL)
+    {
+        return -1;
+    }
+
+    struct dirent* entry;
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strncmp(entry->d_name, "node", 4) == 0
+            && isdigit((unsigned char) entry->d_name[4]))
+        {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+
+    closedir(dir);
+
+    return node;
+}
+
+/**
+ * Orders CPUs for compact pinning: all cores of a node, node by node,
+ * then the further hardware threads in the same order
+ */
+static int ttracker_compare_compact(const void* a, const void* b)
+{
+    const ttracker_cpu_t* x = (const ttracker_cpu_t*) a;
+    const ttracker_cpu_t* y = (const ttracker_cpu_t*) b;
+
+    if (x->sibling != y->sibling)
+    {
+        return x->sibling - y->sibling;
+    }
+
+    if (x->node != y->node)
+    {
+        return x->node - y->node;
+    }
+
+    if (x->core != y->core)
+    {
+        return x->core - y->core;
+    }
+
+    return x->cpu - y->cpu;
+}
+
+/**
+ * Orders CPUs for scatter pinning: the first core of every node, then the
+ * second core of every node and so on
+ */
+static int ttracker_compare_scatter(const void* a, const void* b)
+{
+    const ttracker_cpu_t* x = (const ttracker_cpu_t*) a;
+    const ttracker_cpu_t* y = (const ttracker_cpu_t*) b;
+
+    if (x->sibling != y->sibling)
+    {
+        return x->sibling - y->sibling;
+    }
+
+    if (x->rank != y->rank)
+    {
+        return x->rank - y->rank;
+    }
+
+    if (x->node != y->node)
+    {
+        return x->node - y->node;
+    }
+
+    return x->cpu - y->cpu;
+}
+
+/**
+ * Parses a CPU list like 0,2,4-7 into the pinning order
+ *
+ * @param list The CPU list
+ * @param cpus Target array with CPU_SETSIZE elements
+ * @return Number of CPUs, 0 if the list is invalid
+ */
+static int ttracker_parse_cpu_list(const char* list, int* cpus)
+{
+    int count = 0;
+
+    while (*list != '\0')
+    {
+        char* end;
+        long first = strtol(list, &end, 10);
+        long last = first;
+
+        if (end == list || first < 0 || first >= CPU_SETSIZE)
+        {
+            return 0;
+        }
+
+        if (*end == '-')
+        {
+            list = end + 1;
+            last = strtol(list, &end, 10);
+
+            if (end == list || last < first || last >= CPU_SETSIZE)
+            {
+                return 0;
+            }
+        }
+
+        for (long cpu = first; cpu <= last && count < CPU_SETSIZE; ++cpu)
+        {
+            cpus[count++] = (int) cpu;
+        }
+
+        if (*end == ',')
+        {
+            ++end;
+        }
+        else if (*end != '\0')
+        {
+            return 0;
+        }
+
+        list = end;
+    }
+
+    return count;
+}
+
+/**
+ * Computes the pinning order from DBENCH_AFFINITY and the topology of the
+ * CPUs in the affinity mask of the process. Leaves the order empty, if
+ * no pinning is requested or the policy is invalid
+ */
+static void ttracker_init_affinity(void)
+{
+    const char* policy = getenv(TTRACKER_ENV_AFFINITY);
+
+    if (policy == NULL || *policy == '\0')
+    {
+        return;
+    }
+
+    int* cpus = malloc(CPU_SETSIZE * sizeof(int));
+    ttracker_cpu_t* topology = malloc(CPU_SETSIZE * sizeof(ttracker_cpu_t));
+    cpu_set_t allowed;
+    int count = 0;
+
+    if (cpus == NULL || topology == NULL
+        || sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        free(cpus);
+        free(topology);
+        return;
+    }
+
+    ttracker_process_affinity = allowed;
+
+    if (isdigit((unsigned char) *policy))
+    {
+        count = ttracker_parse_cpu_list(policy, cpus);
+    }
+    else if (strcmp(policy, "compact") == 0 || strcmp(policy, "scatter") == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &allowed))
+            {
+                continue;
+            }
+
+            ttracker_cpu_t* info = &topology[count++];
+            info->cpu = cpu;
+            info->node = ttracker_read_node(cpu);
+            info->package = ttracker_read_topology(cpu, "physical_package_id");
+            info->core = ttracker_read_topology(cpu, "core_id");
+            info->sibling = 0;
+
+            /* Without NUMA information, sockets are the nodes */
+            if (info->node == -1)
+            {
+                info->node = info->package;
+            }
+
+            /* Count the hardware threads of the same core seen before */
+            for (int i = 0; i < count - 1; ++i)
+            {
+                if (topology[i].package == info->package
+                    && topology[i].core == info->core)
+                {
+                    ++info->sibling;
+                }
+            }
+        }
+
+        qsort(topology, count, sizeof(ttracker_cpu_t),
+            ttracker_compare_compact);
+
+        /* In compact order, the cores of a node are consecutive */
+        for (int i = 0; i < count; ++i)
+        {
+            int same_node = i > 0 && topology[i - 1].node == topology[i].node
+                && topology[i - 1].sibling == topology[i].sibling;
+
+            topology[i].rank = same_node ? topology[i - 1].rank + 1 : 0;
+        }
+
+        if (strcmp(policy, "scatter") == 0)
+        {
+            qsort(topology, count, sizeof(ttracker_cpu_t),
+                ttracker_compare_scatter);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            cpus[i] = topology[i].cpu;
+        }
+    }
+
+    free(topology);
+
+    if (count == 0)
+    {
+        fprintf(stderr, "Invalid %s=%s, threads are not pinned!\n",
+            TTRACKER_ENV_AFFINITY, policy);
+        free(cpus);
+        return;
+    }
+
+    ttracker_affinity_cpus = cpus;
+    ttracker_affinity_cpu_count = count;
+}
+
+/**
+ * Records a finished span into the ring buffer. Slots are claimed with an
+ * atomic increment, so any number of threads can record concurrently
+ *
+ * @param tracker The tracker with initialized spans
+ * @param name Name of the span
+ * @param id Id of the span
+ * @param start Start of span in ticks
+ * @param stop Stop of span in ticks
+ * @param depth Nesting depth of the span
+ */
+static void ttracker_record_span(ttracker_t* tracker, const char* name,
+    long long id, long long start, long long stop, unsigned int depth)
+{
+    if (ttracker_thread_id == 0)
+    {
+        ttracker_thread_id = (int) syscall(SYS_gettid);
+    }
+
+    unsigned long long index =
+        __atomic_fetch_add(&tracker->span_count, 1, __ATOMIC_RELAXED);
+    ttracker_span_t* span = &tracker->spans[index % tracker->span_capacity];
+
+    span->name = name;
+    span->id = id;
+    span->start = start;
+    span->stop = stop;
+    span->thread_id = ttracker_thread_id;
+    span->depth = depth;
+}
+
+/**
+ * Writes a string as JSON string literal
+ *
+ * @param file The file to write to
+ * @param str The string to write
+ */
+static void ttracker_write_json_string(FILE* file, const char* str)
+{
+    fputc('"', file);
+
+    for (; *str != '\0'; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            fputc('\\', file);
+        }
+
+        if ((unsigned char) *str >= 0x20)
+        {
+            fputc(*str, file);
+        }
+    }
+
+    fputc('"', file);
+}
+
+/**
+ * Writes nanoseconds as microseconds with three decimal places
+ *
+ * @param file The file to write to
+ * @param nsec Nanoseconds to write
+ */
+static inline void ttracker_write_usec(FILE* file, long long nsec)
+{
+    fprintf(file, "%lld.%03lld", nsec / 1000LL, nsec % 1000LL);
+}
+
+/**
+ * Parses the value of a repetition option
+ *
+ * @param str The string to parse
+ * @param value Target for the value
+ * @return TTRACKER_SUCCESS, if str is a non-negative integer
+ */
+static int ttracker_parse_count(const char* str, unsigned int* value)
+{
+    char* end;
+
+    if (str == NULL || *str < '0' || *str > '9')
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    unsigned long parsed = strtoul(str, &end, 10);
+
+    if (*end != '\0' || parsed > UINT_MAX)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    *value = (unsigned int) parsed;
+
+    return TTRACKER_SUCCESS;
+}
+
+/**
+ * Compares two samples for qsort
+ *
+ * @param a First sample
+ * @param b Second sample
+ * @return Negative, zero or positive, if a is less, equal or greater
+ */
+static int ttracker_compare_samples(const void* a, const void* b)
+{
+    long long sample_a = *(const long long*) a;
+    long long sample_b = *(const long long*) b;
+
+    return (sample_a > sample_b) - (sample_a < sample_b);
+}
+
+/**
+ * Calculates the square root with Newton's method, so that the programs
+ * do not have to link libm
+ *
+ * @param value Non-negative value
+ * @return Square root of value
+ */
+static double ttracker_sqrt(double value)
+{
+    if (value <= 0.0)
+    {
+        return 0.0;
+    }
+
+    double root = value > 1.0 ? value : 1.0;
+    double previous;
+
+    do
+    {
+        previous = root;
+        root = 0.5 * (root + value / root);
+    } while (root < previous);
+
+    return previous;
+}
+
+/**
+ * Prints the wait histograms of all threads and events with waits to
+ * stderr. The share is relative to the time of the event
+ *
+ * @param tracker The tracker to print
+ */
+static void ttracker_print_waits(const ttracker_t* tracker)
+{
+    fprintf(stderr, "event,thread,waits,wait,share");
+
+    for (int b = 0; b < TTRACKER_WAIT_BUCKETS - 1; ++b)
+    {
+        fprintf(stderr, ",<2^%dns", b + TTRACKER_WAIT_SHIFT);
+    }
+
+    fprintf(stderr, ",>=2^%dns\n",
+        TTRACKER_WAIT_BUCKETS - 2 + TTRACKER_WAIT_SHIFT);
+
+    for (unsigned int tid = 0; tid < tracker->event_count; ++tid)
+    {
+        const ttracker_event_t* event = &tracker->events[tid];
+        long long event_ticks = event->stop - event->start;
+
+        for (unsigned int i = 0; i < tracker->thread_count; ++i)
+        {
+            const ttracker_wait_t* wait =
+                &ttracker_thread_waits(tracker, i)[tid];
+
+            if (wait->count == 0)
+            {
+                continue;
+            }
+
+            long long nsec = ttracker_ticks_to_nsec(tracker, wait->ticks);
+
+            fprintf(stderr, "%u,%u,%llu,%lld.%09lld,%.4f", tid, i,
+                wait->count, nsec / 1000000000LL, nsec % 1000000000LL,
+                event_ticks > 0 ? (double) wait->ticks / event_ticks : 0.0);
+
+            for (int b = 0; b < TTRACKER_WAIT_BUCKETS; ++b)
+            {
+                fprintf(stderr, ",%llu", wait->buckets[b]);
+            }
+
+            fprintf(stderr, "\n");
+        }
+    }
+}
+
+/**
+ * Prints nanoseconds in SECONDS.NANOSECONDS format
+ *
+ * @param nsec Nanoseconds to print
+ */
+static inline void ttracker_print_nsec(long long nsec)
+{
+    printf("%lld.%09lld", nsec / 1000000000LL, nsec % 1000000000LL);
+}
+
+void ttracker_init(ttracker_t* tracker, ttracker_event_t* events,
+    unsigned int event_count)
+{
+    tracker->events = events;
+    tracker->event_count = event_count;
+    tracker->status = TTRACKER_SUCCESS;
+    tracker->thread_slots = NULL;
+    tracker->thread_slot_size = 0;
+    tracker->thread_count = 0;
+    tracker->counters_enabled = 0;
+    tracker->migration_fd = -1;
+    tracker->rusage_enabled = 0;
+    tracker->waits_enabled = 0;
+    tracker->spans = NULL;
+    tracker->span_capacity = 0;
+    tracker->span_count = 0;
+    tracker->trace_file = NULL;
+    tracker->tsc_enabled = 0;
+    tracker->nsec_per_tick = 1.0;
+    tracker->tick_base = 0;
+    tracker->nsec_base = 0;
+
+    /* Pin before calibrating, so that the TSC is read on one CPU */
+    ttracker_pin_thread(0);
+
+    const char* clock = getenv(TTRACKER_ENV_CLOCK);
+
+    if (clock == NULL || strcmp(clock, "monotonic") != 0)
+    {
+        ttracker_init_tsc(tracker);
+    }
+
+    tracker->samples = NULL;
+    tracker->sample_count = 0;
+    tracker->sample_capacity = 0;
+
+    for (int i = 0; i < TTRACKER_COUNTER_COUNT; ++i)
+    {
+        tracker->counter_fds[i] = -1;
+    }
+
+    const char* counters = getenv(TTRACKER_ENV_COUNTERS);
+
+    if (counters != NULL && strcmp(counters, "1") == 0)
+    {
+        ttracker_init_counters(tracker);
+    }
+
+    const char* rusage = getenv(TTRACKER_ENV_RUSAGE);
+
+    if (rusage != NULL && strcmp(rusage, "1") == 0)
+    {
+        ttracker_init_rusage(tracker);
+    }
+
+    const char* waits = getenv(TTRACKER_ENV_WAITS);
+
+    if (waits != NULL && strcmp(waits, "1") == 0)
+    {
+        ttracker_init_waits(tracker);
+    }
+
+    const char* trace_file = getenv(TTRACKER_ENV_TRACE);
+
+    if (trace_file != NULL && *trace_file != '\0'
+        && ttracker_init_spans(tracker, TTRACKER_SPAN_CAPACITY)
+            == TTRACKER_SUCCESS)
+    {
+        tracker->trace_file = trace_file;
+    }
+}
+
+int ttracker_init_counters(ttracker_t* tracker)
+{
+    struct perf_event_attr attr;
+
+    ttracker_close_counters(tracker);
+
+    for (int i = 0; i < TTRACKER_COUNTER_COUNT; ++i)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = ttracker_counter_configs[i].type;
+        attr.config = ttracker_counter_configs[i].config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+            | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        /* Calling thread and all threads created later, any CPU */
+        tracker->counter_fds[i] =
+            (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+        if (tracker->counter_fds[i] == -1)
+        {
+            /* Fall back to time-only tracking */
+            ttracker_close_counters(tracker);
+            return TTRACKER_FAILURE;
+        }
+    }
+
+    tracker->counters_enabled = 1;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_init_rusage(ttracker_t* tracker)
+{
+    struct perf_event_attr attr;
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    if (tracker->migration_fd == -1)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_CPU_MIGRATIONS;
+        attr.inherit = 1;
+
+        /* Migrations are optional, they are printed as -1 on failure */
+        tracker->migration_fd =
+            (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    tracker->rusage_enabled = 1;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_init_waits(ttracker_t* tracker)
+{
+    tracker->waits_enabled = 1;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_init_threads(ttracker_t* tracker, unsigned int thread_count)
+{
+    /* Round slot size up, so that no two threads share a cache line */
+    size_t slot_size = tracker->event_count
+        * (sizeof(ttracker_thread_event_t) + sizeof(ttracker_wait_t));
+    slot_size = (slot_size + TTRACKER_CACHE_LINE - 1)
+        / TTRACKER_CACHE_LINE * TTRACKER_CACHE_LINE;
+
+    if (slot_size == 0 || thread_count == 0)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    void* slots = aligned_alloc(TTRACKER_CACHE_LINE, slot_size * thread_count);
+
+    if (slots == NULL)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    memset(slots, 0, slot_size * thread_count);
+
+    free(tracker->thread_slots);
+    tracker->thread_slots = slots;
+    tracker->thread_slot_size = slot_size;
+    tracker->thread_count = thread_count;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_init_spans(ttracker_t* tracker, unsigned long long capacity)
+{
+    if (capacity == 0)
+    {
+        return TTRACKER_FAILURE;
+    }
 
-#include "ttracker.h"
+    ttracker_span_t* spans = calloc(capacity, sizeof(ttracker_span_t));
 
-void ttracker_init(ttracker_t* tracker, ttracker_event_t* events,
-    unsigned int event_count)
+    if (spans == NULL)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    free(tracker->spans);
+    tracker->spans = spans;
+    tracker->span_capacity = capacity;
+    tracker->span_count = 0;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_init_samples(ttracker_t* tracker, unsigned int capacity)
 {
-    tracker->events = events;
-    tracker->event_count = event_count;
-    tracker->status = TTRACKER_SUCCESS;
+    if (capacity == 0)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    long long* samples = malloc(capacity * sizeof(long long));
+
+    if (samples == NULL)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    free(tracker->samples);
+    tracker->samples = samples;
+    tracker->sample_count = 0;
+    tracker->sample_capacity = capacity;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_parse_repeat(int* argc, char* argv[], unsigned int* repeat,
+    unsigned int* warmup)
+{
+    int count = 1;
+
+    *repeat = 1;
+    *warmup = 0;
+
+    for (int i = 1; i < *argc; ++i)
+    {
+        if (strcmp(argv[i], "--repeat") == 0)
+        {
+            if (i + 1 == *argc
+                || ttracker_parse_count(argv[i + 1], repeat)
+                    != TTRACKER_SUCCESS
+                || *repeat == 0)
+            {
+                return TTRACKER_FAILURE;
+            }
+
+            ++i;
+        }
+        else if (strcmp(argv[i], "--warmup") == 0)
+        {
+            if (i + 1 == *argc
+                || ttracker_parse_count(argv[i + 1], warmup)
+                    != TTRACKER_SUCCESS)
+            {
+                return TTRACKER_FAILURE;
+            }
+
+            ++i;
+        }
+        else
+        {
+            argv[count++] = argv[i];
+        }
+    }
+
+    argv[count] = NULL;
+    *argc = count;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_pin_thread(unsigned int thread_index)
+{
+    pthread_once(&ttracker_affinity_once, ttracker_init_affinity);
+
+    if (ttracker_affinity_cpu_count == 0
+        || ttracker_pinned_index == thread_index)
+    {
+        return TTRACKER_SUCCESS;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(ttracker_affinity_cpus[thread_index % ttracker_affinity_cpu_count],
+        &set);
+
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    ttracker_pinned_index = thread_index;
+
+    return TTRACKER_SUCCESS;
+}
+
+int ttracker_unpin_thread(void)
+{
+    pthread_once(&ttracker_affinity_once, ttracker_init_affinity);
+
+    if (ttracker_affinity_cpu_count == 0)
+    {
+        return TTRACKER_SUCCESS;
+    }
+
+    if (sched_setaffinity(0, sizeof(ttracker_process_affinity),
+        &ttracker_process_affinity) != 0)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    ttracker_pinned_index = -1;
+
+    return TTRACKER_SUCCESS;
+}
+
+void ttracker_cleanup(ttracker_t* tracker)
+{
+    if (tracker->trace_file != NULL
+        && ttracker_write_trace(tracker, tracker->trace_file)
+            != TTRACKER_SUCCESS)
+    {
+        fprintf(stderr, "Could not write trace file %s!\n",
+            tracker->trace_file);
+    }
+
+    ttracker_close_counters(tracker);
+
+    if (tracker->migration_fd != -1)
+    {
+        close(tracker->migration_fd);
+        tracker->migration_fd = -1;
+    }
+
+    free(tracker->thread_slots);
+    free(tracker->spans);
+    free(tracker->samples);
+
+    tracker->rusage_enabled = 0;
+    tracker->waits_enabled = 0;
+    tracker->thread_slots = NULL;
+    tracker->thread_slot_size = 0;
+    tracker->thread_count = 0;
+    tracker->spans = NULL;
+    tracker->span_capacity = 0;
+    tracker->span_count = 0;
+    tracker->trace_file = NULL;
+    tracker->samples = NULL;
+    tracker->sample_count = 0;
+    tracker->sample_capacity = 0;
 }
 
 void ttracker_start(ttracker_t* tracker, unsigned int tid)
 {
-    tracker->status |=
-        clock_gettime(CLOCK_MONOTONIC_RAW, &tracker->events[tid].ts_start);
+    ttracker_event_t* event = &tracker->events[tid];
+
+    if (tracker->counters_enabled)
+    {
+        tracker->status |= ttracker_read_counters(tracker, event->counters);
+    }
+
+    if (tracker->rusage_enabled)
+    {
+        tracker->status |= ttracker_read_rusage(tracker, event->rusage);
+    }
+
+    tracker->status |= ttracker_ticks_start(tracker, &event->start);
 }
 
 void ttracker_stop(ttracker_t* tracker, unsigned int tid)
 {
-    tracker->status |=
-        clock_gettime(CLOCK_MONOTONIC_RAW, &tracker->events[tid].ts_stop);
+    ttracker_event_t* event = &tracker->events[tid];
+
+    tracker->status |= ttracker_ticks_stop(tracker, &event->stop);
+
+    if (tracker->counters_enabled)
+    {
+        long long values[TTRACKER_COUNTER_COUNT];
+        tracker->status |= ttracker_read_counters(tracker, values);
+
+        /* Store the delta between start and stop */
+        for (int i = 0; i < TTRACKER_COUNTER_COUNT; ++i)
+        {
+            event->counters[i] = values[i] - event->counters[i];
+        }
+    }
+
+    if (tracker->rusage_enabled)
+    {
+        long long values[TTRACKER_RUSAGE_COUNT];
+        tracker->status |= ttracker_read_rusage(tracker, values);
+
+        /* Store the delta between start and stop, but the peak at stop */
+        for (int i = 0; i < TTRACKER_RUSAGE_COUNT; ++i)
+        {
+            if (i != TTRACKER_MAX_RSS && values[i] != -1)
+            {
+                values[i] -= event->rusage[i];
+            }
+
+            event->rusage[i] = values[i];
+        }
+    }
+
+    if (tracker->spans != NULL)
+    {
+        ttracker_record_span(tracker, "event", tid, event->start,
+            event->stop, ttracker_open_span_count);
+    }
+}
+
+void ttracker_thread_start(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid)
+{
+    if (tracker == NULL || thread_index >= tracker->thread_count)
+    {
+        return;
+    }
+
+    ttracker_thread_event_t* event =
+        &ttracker_thread_events(tracker, thread_index)[tid];
+
+    /* Only the outermost call starts an interval */
+    if (event->depth++ == 0)
+    {
+        event->status |= ttracker_ticks_start(tracker, &event->start);
+    }
+}
+
+void ttracker_thread_stop(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid)
+{
+    if (tracker == NULL || thread_index >= tracker->thread_count)
+    {
+        return;
+    }
+
+    ttracker_thread_event_t* event =
+        &ttracker_thread_events(tracker, thread_index)[tid];
+
+    if (event->depth == 0 || --event->depth != 0)
+    {
+        return;
+    }
+
+    long long stop;
+    event->status |= ttracker_ticks_stop(tracker, &stop);
+    event->ticks += stop - event->start;
+    ++event->count;
+}
+
+void ttracker_wait_begin(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid)
+{
+    if (tracker == NULL || !tracker->waits_enabled
+        || thread_index >= tracker->thread_count)
+    {
+        return;
+    }
+
+    ttracker_wait_t* wait = &ttracker_thread_waits(tracker, thread_index)[tid];
+    ttracker_thread_events(tracker, thread_index)[tid].status |=
+        ttracker_ticks_start(tracker, &wait->start);
+}
+
+void ttracker_wait_end(ttracker_t* tracker, unsigned int thread_index,
+    unsigned int tid)
+{
+    if (tracker == NULL || !tracker->waits_enabled
+        || thread_index >= tracker->thread_count)
+    {
+        return;
+    }
+
+    ttracker_wait_t* wait = &ttracker_thread_waits(tracker, thread_index)[tid];
+
+    long long stop;
+    ttracker_thread_events(tracker, thread_index)[tid].status |=
+        ttracker_ticks_stop(tracker, &stop);
+
+    long long ticks = stop - wait->start;
+    unsigned long long nsec =
+        (unsigned long long) ttracker_ticks_to_nsec(tracker, ticks);
+
+    /* Bucket by the position of the highest set bit */
+    int bucket = 0;
+
+    if (nsec >= 1ULL << TTRACKER_WAIT_SHIFT)
+    {
+        bucket = 64 - __builtin_clzll(nsec) - TTRACKER_WAIT_SHIFT;
+
+        if (bucket >= TTRACKER_WAIT_BUCKETS)
+        {
+            bucket = TTRACKER_WAIT_BUCKETS - 1;
+        }
+    }
+
+    wait->ticks += ticks;
+    ++wait->count;
+    ++wait->buckets[bucket];
+}
+
+void ttracker_span_begin(ttracker_t* tracker, const char* name, long long id)
+{
+    if (tracker == NULL || tracker->spans == NULL)
+    {
+        return;
+    }
+
+    /* Spans nested deeper than the stack are counted, but not recorded */
+    unsigned int depth = ttracker_open_span_count++;
+
+    if (depth < TTRACKER_SPAN_DEPTH)
+    {
+        ttracker_open_span_t* span = &ttracker_open_spans[depth];
+        span->name = name;
+        span->id = id;
+        ttracker_ticks_start(tracker, &span->start);
+    }
+}
+
+void ttracker_span_end(ttracker_t* tracker)
+{
+    if (tracker == NULL || tracker->spans == NULL
+        || ttracker_open_span_count == 0)
+    {
+        return;
+    }
+
+    unsigned int depth = --ttracker_open_span_count;
+
+    if (depth < TTRACKER_SPAN_DEPTH)
+    {
+        const ttracker_open_span_t* span = &ttracker_open_spans[depth];
+        long long stop;
+
+        ttracker_ticks_stop(tracker, &stop);
+        ttracker_record_span(tracker, span->name, span->id, span->start,
+            stop, depth);
+    }
+}
+
+int ttracker_write_trace(const ttracker_t* tracker, const char* filename)
+{
+    if (tracker->spans == NULL)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    FILE* file = fopen(filename, "w");
+
+    if (file == NULL)
+    {
+        return TTRACKER_FAILURE;
+    }
+
+    /* Only the newest spans are left, if the ring buffer wrapped around */
+    unsigned long long count = tracker->span_count;
+    unsigned long long first = 0;
+
+    if (count > tracker->span_capacity)
+    {
+        first = count - tracker->span_capacity;
+    }
+
+    int pid = (int) getpid();
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for (unsigned long long i = first; i < count; ++i)
+    {
+        const ttracker_span_t* span =
+            &tracker->spans[i % tracker->span_capacity];
+
+        fprintf(file, "%s\n{\"name\":", i == first ? "" : ",");
+
+        if (span->id >= 0)
+        {
+            /* Long enough for any name with a 64 bit id */
+            char name[256];
+            snprintf(name, sizeof(name), "%s %lld", span->name, span->id);
+            ttracker_write_json_string(file, name);
+        }
+        else
+        {
+            ttracker_write_json_string(file, span->name);
+        }
+
+        fprintf(file, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":",
+            pid, span->thread_id);
+        ttracker_write_usec(file, tracker->nsec_base + ttracker_ticks_to_nsec(
+            tracker, span->start - tracker->tick_base));
+        fprintf(file, ",\"dur\":");
+        ttracker_write_usec(file,
+            ttracker_ticks_to_nsec(tracker, span->stop - span->start));
+        fprintf(file, ",\"args\":{\"depth\":%u}}", span->depth);
+    }
+
+    fprintf(file, "\n]}\n");
+
+    int status = ferror(file) ? TTRACKER_FAILURE : TTRACKER_SUCCESS;
+
+    if (fclose(file) != 0)
+    {
+        status = TTRACKER_FAILURE;
+    }
+
+    return status;
+}
+
+void ttracker_add_sample(ttracker_t* tracker, unsigned int tid)
+{
+    if (tracker->sample_count >= tracker->sample_capacity)
+    {
+        return;
+    }
+
+    const ttracker_event_t* event = &tracker->events[tid];
+    tracker->samples[tracker->sample_count++] = event->stop - event->start;
+}
+
+void ttracker_merge_threads(ttracker_t* tracker)
+{
+    for (unsigned int i = 0; i < tracker->thread_count; ++i)
+    {
+        const ttracker_thread_event_t* events =
+            ttracker_thread_events(tracker, i);
+
+        for (unsigned int tid = 0; tid < tracker->event_count; ++tid)
+        {
+            tracker->status |= events[tid].status;
+
+            /* Unbalanced start/stop calls */
+            if (events[tid].depth != 0)
+            {
+                tracker->status |= TTRACKER_FAILURE;
+            }
+        }
+    }
+}
+
+void ttracker_reset_threads(ttracker_t* tracker)
+{
+    ttracker_merge_threads(tracker);
+
+    if (tracker->thread_slots != NULL)
+    {
+        memset(tracker->thread_slots, 0,
+            tracker->thread_slot_size * tracker->thread_count);
+    }
 }
 
 void ttracker_print_sec(const ttracker_t* tracker)
 {
+    /* Every block has a fixed number of columns, absent data is empty */
     for (unsigned int i = 0; i < tracker->event_count; ++i)
     {
         const ttracker_event_t* event = &tracker->events[i];
-        long sec = (long) (event->ts_stop.tv_sec - event->ts_start.tv_sec);
-        long nsec = (long) (event->ts_stop.tv_nsec - event->ts_start.tv_nsec);
 
-        /* Adjust time on overflow  */
-        if (nsec < 0)
+        if (i != 0)
+        {
+            printf(",");
+        }
+
+        ttracker_print_nsec(
+            ttracker_ticks_to_nsec(tracker, event->stop - event->start));
+    }
+
+    /* Print min, max and mean time of events tracked by threads */
+    for (unsigned int tid = 0; tid < tracker->event_count; ++tid)
+    {
+        long long min = -1;
+        long long max = 0;
+        long long sum = 0;
+        int tracked = 0;
+
+        for (unsigned int i = 0; i < tracker->thread_count; ++i)
+        {
+            const ttracker_thread_event_t* event =
+                &ttracker_thread_events(tracker, i)[tid];
+
+            /* Threads without intervals count as idle */
+            if (min == -1 || event->ticks < min)
+            {
+                min = event->ticks;
+            }
+
+            if (event->ticks > max)
+            {
+                max = event->ticks;
+            }
+
+            sum += event->ticks;
+            tracked |= event->count != 0;
+        }
+
+        if (!tracked)
         {
-            --sec;
-            nsec += 1E9;
+            printf(",,,");
+            continue;
         }
 
-        printf("%ld.%09ld", sec, nsec);
+        printf(",");
+        ttracker_print_nsec(ttracker_ticks_to_nsec(tracker, min));
+        printf(",");
+        ttracker_print_nsec(ttracker_ticks_to_nsec(tracker, max));
+        printf(",");
+        ttracker_print_nsec(
+            ttracker_ticks_to_nsec(tracker, sum / tracker->thread_count));
+    }
+
+    /* Print min, median, p90, p99 and standard deviation of the samples */
+    int sample_printed = 0;
+
+    if (tracker->sample_count > 1)
+    {
+        unsigned int count = tracker->sample_count;
+        long long* sorted = malloc(count * sizeof(long long));
 
-        if (i != tracker->event_count - 1)
+        if (sorted != NULL)
         {
+            memcpy(sorted, tracker->samples, count * sizeof(long long));
+            qsort(sorted, count, sizeof(long long), ttracker_compare_samples);
+
+            long long median = count % 2 == 1 ? sorted[count / 2]
+                : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+
+            /* Nearest-rank percentiles */
+            long long p90 = sorted[(count * 90 + 99) / 100 - 1];
+            long long p99 = sorted[(count * 99 + 99) / 100 - 1];
+
+            double mean = 0.0;
+            double variance = 0.0;
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                mean += (double) sorted[i] / count;
+            }
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                variance += (sorted[i] - mean) * (sorted[i] - mean)
+                    / (count - 1);
+            }
+
+            printf(",");
+            ttracker_print_nsec(ttracker_ticks_to_nsec(tracker, sorted[0]));
+            printf(",");
+            ttracker_print_nsec(ttracker_ticks_to_nsec(tracker, median));
+            printf(",");
+            ttracker_print_nsec(ttracker_ticks_to_nsec(tracker, p90));
             printf(",");
+            ttracker_print_nsec(ttracker_ticks_to_nsec(tracker, p99));
+            printf(",");
+            ttracker_print_nsec(ttracker_ticks_to_nsec(tracker,
+                (long long) ttracker_sqrt(variance)));
+
+            free(sorted);
+            sample_printed = 1;
+        }
+    }
+
+    if (!sample_printed)
+    {
+        printf(",,,,,");
+    }
+
+    /* Print the counters and then the resource usage of every event */
+    for (unsigned int i = 0; i < tracker->event_count; ++i)
+    {
+        for (int c = 0; c < TTRACKER_COUNTER_COUNT; ++c)
+        {
+            if (tracker->counters_enabled)
+            {
+                printf(",%lld", tracker->events[i].counters[c]);
+            }
+            else
+            {
+                printf(",");
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < tracker->event_count; ++i)
+    {
+        for (int r = 0; r < TTRACKER_RUSAGE_COUNT; ++r)
+        {
+            if (tracker->rusage_enabled)
+            {
+                printf(",%lld", tracker->events[i].rusage[r]);
+            }
+            else
+            {
+                printf(",");
+            }
         }
     }
 
     printf("\n");
+
+    if (tracker->waits_enabled)
+    {
+        ttracker_print_waits(tracker);
+    }
 }